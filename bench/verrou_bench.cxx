@@ -0,0 +1,715 @@
+/*
+ * Microbenchmark of the verrou backend: ns and cycles per operation of every
+ * scalar entry point of the backend interface, dynamic and static, and of
+ * every vector entry point of each instruction set the CPU runs, for every
+ * rounding mode and every det hash. Results are written as JSON.
+ *
+ * Each kernel is timed twice:
+ *  - latency: a dependent chain, the result of a call is an input of the next
+ *  - throughput: independent calls over a block of inputs
+ * Values are per scalar operation, a call of a N-lane entry point counting
+ * for N. Cycles, instructions, branch-misses and L1D read misses come from
+ * perf_event when the kernel allows it (perf_event_paranoid), they are null
+ * otherwise; the time stamp counter is always read.
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "interflop_verrou.h"
+
+#include "interflop_vector_verrou_scalar.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_sse.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_avx.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_avx512.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+
+#ifdef RNG_THREAD_SAFE
+static const bool bench_tls = true;
+#else
+static const bool bench_tls = false;
+#endif
+
+// * Options
+
+static long bench_ops = 1 << 18; // operations per measure
+static int bench_repeat = 3;     // the fastest measure is kept
+static const char *bench_filter = NULL;
+static const char *bench_output = NULL;
+static enum vr_NanInfCheck bench_naninf = VR_NANINF_CHECK_FULL;
+
+// * Stdlib handlers, set by the interflop loader otherwise
+
+static void bench_panic(const char *msg) {
+  fprintf(stderr, "verrou_bench: %s\n", msg);
+  exit(1);
+}
+
+static pid_t bench_gettid(void) { return syscall(SYS_gettid); }
+
+static void bench_naninf_handler(void) {}
+
+static long bench_strtol(const char *nptr, char **endptr, int *error) {
+  *error = 0;
+  return strtol(nptr, endptr, 10);
+}
+
+static void bench_set_handlers(void) {
+  interflop_set_handler("exit", (void *)exit);
+  interflop_set_handler("fprintf", (void *)fprintf);
+  interflop_set_handler("getenv", (void *)getenv);
+  interflop_set_handler("gettid", (void *)bench_gettid);
+  interflop_set_handler("gettimeofday", (void *)gettimeofday);
+  interflop_set_handler("infHandler", (void *)bench_naninf_handler);
+  interflop_set_handler("malloc", (void *)malloc);
+  interflop_set_handler("nanHandler", (void *)bench_naninf_handler);
+  interflop_set_handler("panic", (void *)bench_panic);
+  interflop_set_handler("strcasecmp", (void *)strcasecmp);
+  interflop_set_handler("strtol", (void *)bench_strtol);
+}
+
+// * Hardware counters
+
+enum { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_BRANCH_MISSES, PERF_L1D_MISSES,
+       PERF_NB };
+
+static const char *perf_names[PERF_NB] = {"cycles", "instructions",
+                                          "branch_misses", "l1d_misses"};
+
+static int perf_fd[PERF_NB] = {-1, -1, -1, -1};
+
+static int perf_open(uint32_t type, uint64_t config, int group) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = (group == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/* opens the counters as one group, a missing one is left closed */
+static void perf_init(void) {
+  perf_fd[PERF_CYCLES] =
+      perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (perf_fd[PERF_CYCLES] < 0)
+    return;
+  const int leader = perf_fd[PERF_CYCLES];
+  perf_fd[PERF_INSTRUCTIONS] =
+      perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, leader);
+  perf_fd[PERF_BRANCH_MISSES] =
+      perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, leader);
+  perf_fd[PERF_L1D_MISSES] = perf_open(
+      PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      leader);
+}
+
+static bool perf_available(void) { return perf_fd[PERF_CYCLES] >= 0; }
+
+/* values in the order the counters were added to the group */
+static void perf_read(double count[PERF_NB]) {
+  uint64_t buf[1 + PERF_NB] = {0};
+  for (int i = 0; i < PERF_NB; i++)
+    count[i] = NAN;
+  if (!perf_available() || read(perf_fd[PERF_CYCLES], buf, sizeof(buf)) <= 0)
+    return;
+  int j = 1;
+  for (int i = 0; i < PERF_NB; i++) {
+    if (perf_fd[i] >= 0)
+      count[i] = (double)buf[j++];
+  }
+}
+
+// * Measures
+
+struct Measure {
+  double ns;
+  double tsc;
+  double perf[PERF_NB];
+};
+
+static double now_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return 1e9 * t.tv_sec + t.tv_nsec;
+}
+
+/* kernel(n) runs n scalar operations */
+static Measure measure(const std::function<void(long)> &kernel) {
+  Measure best;
+  best.ns = INFINITY;
+  kernel(bench_ops / 16); // warm-up
+  for (int r = 0; r < bench_repeat; r++) {
+    Measure m;
+    double start[PERF_NB], stop[PERF_NB];
+    if (perf_available()) {
+      ioctl(perf_fd[PERF_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(perf_fd[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    perf_read(start);
+    const double t0 = now_ns();
+    const uint64_t c0 = __rdtsc();
+    kernel(bench_ops);
+    const uint64_t c1 = __rdtsc();
+    const double t1 = now_ns();
+    perf_read(stop);
+    if (perf_available())
+      ioctl(perf_fd[PERF_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    m.ns = (t1 - t0) / bench_ops;
+    m.tsc = (double)(c1 - c0) / bench_ops;
+    for (int i = 0; i < PERF_NB; i++)
+      m.perf[i] = (stop[i] - start[i]) / bench_ops;
+    if (m.ns < best.ns)
+      best = m;
+  }
+  return best;
+}
+
+// * Kernels
+
+static const int BLOCK = 1024;
+
+template <class T> struct Inputs {
+  T a[BLOCK] __attribute__((aligned(64)));
+  T b[BLOCK] __attribute__((aligned(64)));
+  T c[BLOCK] __attribute__((aligned(64)));
+  T res[BLOCK] __attribute__((aligned(64)));
+  double d[BLOCK] __attribute__((aligned(64)));
+
+  Inputs() {
+    srand48(42);
+    for (int i = 0; i < BLOCK; i++) {
+      a[i] = 1 + drand48();
+      b[i] = 1 + drand48();
+      c[i] = 1 + drand48();
+      d[i] = 1 + drand48();
+    }
+  }
+};
+
+static Inputs<float> inputs_float;
+static Inputs<double> inputs_double;
+
+template <class T> static Inputs<T> &inputs();
+template <> Inputs<float> &inputs<float>() { return inputs_float; }
+template <> Inputs<double> &inputs<double>() { return inputs_double; }
+
+/* keeps the compiler from dropping the results */
+static volatile double bench_sink;
+
+/* second operand of a chain, which keeps the values in [1, 2) */
+template <class T> static T chain_operand(const char *op) {
+  if (strcmp(op, "add") == 0 || strcmp(op, "sub") == 0)
+    return T(1e-7);
+  return T(1.0000001);
+}
+
+struct Kernel {
+  std::string entry; // symbol of the entry point
+  std::string op;
+  std::string type;
+  int lanes;
+  std::function<void(long)> latency;
+  std::function<void(long)> throughput;
+};
+
+template <class T>
+static Kernel binary_kernel(const std::string &entry, const char *op,
+                            const char *type, int lanes,
+                            void (*fn)(T *, T *, T *, void *), void *ctx) {
+  Kernel k = {entry, op, type, lanes, nullptr, nullptr};
+  const bool down = (strcmp(op, "sub") == 0 || strcmp(op, "div") == 0);
+  k.latency = [=](long n) {
+    T x[16] __attribute__((aligned(64)));
+    T y[16] __attribute__((aligned(64)));
+    for (int j = 0; j < lanes; j++) {
+      x[j] = down ? T(2) : T(1);
+      y[j] = chain_operand<T>(op);
+    }
+    for (long i = 0; i < n; i += lanes)
+      fn(x, y, x, ctx);
+    bench_sink = x[0];
+  };
+  k.throughput = [=](long n) {
+    Inputs<T> &in = inputs<T>();
+    for (long i = 0; i < n; i += BLOCK)
+      for (int j = 0; j < BLOCK; j += lanes)
+        fn(in.a + j, in.b + j, in.res + j, ctx);
+    bench_sink = in.res[0];
+  };
+  return k;
+}
+
+template <class T>
+static Kernel fma_kernel(const std::string &entry, const char *type, int lanes,
+                         void (*fn)(T *, T *, T *, T *, void *), void *ctx) {
+  Kernel k = {entry, "fma", type, lanes, nullptr, nullptr};
+  k.latency = [=](long n) {
+    T x[16] __attribute__((aligned(64)));
+    T y[16] __attribute__((aligned(64)));
+    T z[16] __attribute__((aligned(64)));
+    for (int j = 0; j < lanes; j++) {
+      x[j] = T(1);
+      y[j] = T(0.5);
+      z[j] = T(0.5);
+    }
+    for (long i = 0; i < n; i += lanes)
+      fn(x, y, z, x, ctx);
+    bench_sink = x[0];
+  };
+  k.throughput = [=](long n) {
+    Inputs<T> &in = inputs<T>();
+    for (long i = 0; i < n; i += BLOCK)
+      for (int j = 0; j < BLOCK; j += lanes)
+        fn(in.a + j, in.b + j, in.c + j, in.res + j, ctx);
+    bench_sink = in.res[0];
+  };
+  return k;
+}
+
+static Kernel cast_kernel(const std::string &entry, int lanes,
+                          void (*fn)(double *, float *, void *), void *ctx) {
+  Kernel k = {entry, "cast", "double_to_float", lanes, nullptr, nullptr};
+  k.latency = [=](long n) {
+    double x[16] __attribute__((aligned(64)));
+    float y[16] __attribute__((aligned(64)));
+    for (int j = 0; j < lanes; j++)
+      x[j] = 1.1;
+    for (long i = 0; i < n; i += lanes) {
+      fn(x, y, ctx);
+      for (int j = 0; j < lanes; j++)
+        x[j] = y[j];
+    }
+    bench_sink = x[0];
+  };
+  k.throughput = [=](long n) {
+    Inputs<float> &in = inputs<float>();
+    for (long i = 0; i < n; i += BLOCK)
+      for (int j = 0; j < BLOCK; j += lanes)
+        fn(in.d + j, in.res + j, ctx);
+    bench_sink = in.res[0];
+  };
+  return k;
+}
+
+/* the scalar interface passes its operands by value */
+template <class T, void (**FN)(T, T, T *, void *)>
+static void scalar_binary(T *a, T *b, T *res, void *ctx) {
+  (*FN)(*a, *b, res, ctx);
+}
+template <class T, void (**FN)(T, T, T, T *, void *)>
+static void scalar_fma(T *a, T *b, T *c, T *res, void *ctx) {
+  (*FN)(*a, *b, *c, res, ctx);
+}
+template <void (**FN)(double, float *, void *)>
+static void scalar_cast(double *a, float *res, void *ctx) {
+  (*FN)(*a, res, ctx);
+}
+
+/* backend interface under measure, read through the wrappers above */
+static void (*cur_add_float)(float, float, float *, void *);
+static void (*cur_sub_float)(float, float, float *, void *);
+static void (*cur_mul_float)(float, float, float *, void *);
+static void (*cur_div_float)(float, float, float *, void *);
+static void (*cur_add_double)(double, double, double *, void *);
+static void (*cur_sub_double)(double, double, double *, void *);
+static void (*cur_mul_double)(double, double, double *, void *);
+static void (*cur_div_double)(double, double, double *, void *);
+static void (*cur_cast_double_to_float)(double, float *, void *);
+static void (*cur_fma_float)(float, float, float, float *, void *);
+static void (*cur_fma_double)(double, double, double, double *, void *);
+
+/*
+ * verrou_set_seed with a new seed before each block of BLOCK additions: the
+ * difference with interflop_add_double, times BLOCK, is the cost of a reseed,
+ * with the tables of the det hash rebuilt by the first addition.
+ */
+static Kernel reseed_kernel(void *ctx) {
+  Kernel k = {"verrou_set_seed", "add", "double", 1, nullptr, nullptr};
+  k.throughput = [=](long n) {
+    Inputs<double> &in = inputs<double>();
+    static unsigned int seed = 0;
+    for (long i = 0; i < n; i += BLOCK) {
+      verrou_set_seed(++seed);
+      for (int j = 0; j < BLOCK; j++)
+        cur_add_double(in.a[j], in.b[j], in.res + j, ctx);
+    }
+    bench_sink = in.res[0];
+  };
+  k.latency = k.throughput;
+  return k;
+}
+
+static void
+scalar_kernels(std::vector<Kernel> &ks,
+               const struct interflop_backend_interface_t &backend,
+               void *ctx) {
+  cur_add_float = backend.interflop_add_float;
+  cur_sub_float = backend.interflop_sub_float;
+  cur_mul_float = backend.interflop_mul_float;
+  cur_div_float = backend.interflop_div_float;
+  cur_add_double = backend.interflop_add_double;
+  cur_sub_double = backend.interflop_sub_double;
+  cur_mul_double = backend.interflop_mul_double;
+  cur_div_double = backend.interflop_div_double;
+  cur_cast_double_to_float = backend.interflop_cast_double_to_float;
+  cur_fma_float = backend.interflop_fma_float;
+  cur_fma_double = backend.interflop_fma_double;
+
+#define BENCH_SCALAR_BINARY(OP, T)                                             \
+  ks.push_back(binary_kernel<T>("interflop_" #OP "_" #T, #OP, #T, 1,           \
+                                scalar_binary<T, &cur_##OP##_##T>, ctx))
+  BENCH_SCALAR_BINARY(add, float);
+  BENCH_SCALAR_BINARY(sub, float);
+  BENCH_SCALAR_BINARY(mul, float);
+  BENCH_SCALAR_BINARY(div, float);
+  BENCH_SCALAR_BINARY(add, double);
+  BENCH_SCALAR_BINARY(sub, double);
+  BENCH_SCALAR_BINARY(mul, double);
+  BENCH_SCALAR_BINARY(div, double);
+#undef BENCH_SCALAR_BINARY
+  ks.push_back(cast_kernel("interflop_cast_double_to_float", 1,
+                           scalar_cast<&cur_cast_double_to_float>, ctx));
+  ks.push_back(fma_kernel<float>("interflop_fma_float", "float", 1,
+                                 scalar_fma<float, &cur_fma_float>, ctx));
+  ks.push_back(fma_kernel<double>("interflop_fma_double", "double", 1,
+                                  scalar_fma<double, &cur_fma_double>, ctx));
+  ks.push_back(reseed_kernel(ctx));
+}
+
+#define BENCH_VECTOR_ISA(ISA)                                                  \
+  static void vector_kernels_##ISA(std::vector<Kernel> &ks, void *ctx) {       \
+    BENCH_VECTOR_SIZES(float, 1, 4, 8, 16, ISA);                               \
+    BENCH_VECTOR_SIZES(double, 1, 2, 4, 8, ISA);                               \
+    BENCH_VECTOR_CAST(1, ISA);                                                 \
+    BENCH_VECTOR_CAST(2, ISA);                                                 \
+    BENCH_VECTOR_CAST(4, ISA);                                                 \
+    BENCH_VECTOR_CAST(8, ISA);                                                 \
+  }
+
+#define BENCH_VECTOR_SIZES(T, N1, N2, N3, N4, ISA)                             \
+  BENCH_VECTOR_SIZE(T, N1, ISA);                                               \
+  BENCH_VECTOR_SIZE(T, N2, ISA);                                               \
+  BENCH_VECTOR_SIZE(T, N3, ISA);                                               \
+  BENCH_VECTOR_SIZE(T, N4, ISA)
+
+#define BENCH_VECTOR_SIZE(T, N, ISA)                                           \
+  BENCH_VECTOR_BINARY(add, T, N, ISA);                                         \
+  BENCH_VECTOR_BINARY(sub, T, N, ISA);                                         \
+  BENCH_VECTOR_BINARY(mul, T, N, ISA);                                         \
+  BENCH_VECTOR_BINARY(div, T, N, ISA);                                         \
+  ks.push_back(fma_kernel<T>(                                                  \
+      "interflop_vector_verrou_fma_" #T "_" #N "_" #ISA, #T, N,                \
+      interflop_vector_verrou_fma_##T##_##N##_##ISA, ctx))
+
+#define BENCH_VECTOR_BINARY(OP, T, N, ISA)                                     \
+  ks.push_back(binary_kernel<T>(                                               \
+      "interflop_vector_verrou_" #OP "_" #T "_" #N "_" #ISA, #OP, #T, N,       \
+      interflop_vector_verrou_##OP##_##T##_##N##_##ISA, ctx))
+
+#define BENCH_VECTOR_CAST(N, ISA)                                              \
+  ks.push_back(cast_kernel(                                                    \
+      "interflop_vector_verrou_cast_double_to_float_" #N "_" #ISA, N,          \
+      interflop_vector_verrou_cast_double_to_float_##N##_##ISA, ctx))
+
+BENCH_VECTOR_ISA(scalar)
+BENCH_VECTOR_ISA(sse)
+BENCH_VECTOR_ISA(avx)
+BENCH_VECTOR_ISA(avx512)
+
+/* float slots of a vector table of the backend interface */
+static void table_kernels(std::vector<Kernel> &ks,
+                          const struct interflop_vector_type_t &table,
+                          void *ctx) {
+#define BENCH_TABLE_BINARY(OP, N)                                              \
+  ks.push_back(binary_kernel<float>("vbackend." #OP ".op_vector_float_" #N,    \
+                                    #OP, "float", N,                           \
+                                    table.OP.op_vector_float_##N, ctx))
+#define BENCH_TABLE_SIZES(OP)                                                  \
+  BENCH_TABLE_BINARY(OP, 1);                                                   \
+  BENCH_TABLE_BINARY(OP, 4);                                                   \
+  BENCH_TABLE_BINARY(OP, 8);                                                   \
+  BENCH_TABLE_BINARY(OP, 16)
+  BENCH_TABLE_SIZES(add);
+  BENCH_TABLE_SIZES(sub);
+  BENCH_TABLE_SIZES(mul);
+  BENCH_TABLE_SIZES(div);
+#undef BENCH_TABLE_SIZES
+#undef BENCH_TABLE_BINARY
+}
+
+#undef BENCH_VECTOR_ISA
+#undef BENCH_VECTOR_SIZES
+#undef BENCH_VECTOR_SIZE
+#undef BENCH_VECTOR_BINARY
+#undef BENCH_VECTOR_CAST
+
+// * Configurations
+
+static bool is_det_mode(enum vr_RoundingMode mode) {
+  switch (mode) {
+  case VR_RANDOM_DET:
+  case VR_RANDOM_COMDET:
+  case VR_AVERAGE_DET:
+  case VR_AVERAGE_COMDET:
+  case VR_PRANDOM_DET:
+  case VR_PRANDOM_COMDET:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/* modes of VOpWithSelectedRoundingMode, the others panic */
+static bool is_vector_mode(enum vr_RoundingMode mode) {
+  switch (mode) {
+  case VR_ZERO:
+  case VR_FARTHEST:
+  case VR_FLOAT:
+  case VR_NATIVE:
+  case VR_FTZ:
+    return false;
+  default:
+    return true;
+  }
+}
+
+static const enum vr_RoundingMode bench_modes[] = {
+    VR_NEAREST,        VR_UPWARD,         VR_DOWNWARD,    VR_ZERO,
+    VR_RANDOM,         VR_RANDOM_DET,     VR_RANDOM_COMDET, VR_AVERAGE,
+    VR_AVERAGE_DET,    VR_AVERAGE_COMDET, VR_PRANDOM,     VR_PRANDOM_DET,
+    VR_PRANDOM_COMDET, VR_FARTHEST,       VR_FLOAT,       VR_NATIVE};
+
+static const enum vr_DetHash bench_hashes[] = {
+    VR_DET_HASH_DOUBLE_TABULATION, VR_DET_HASH_TABULATION,
+    VR_DET_HASH_MULTIPLY_SHIFT,    VR_DET_HASH_DIETZFELBINGER,
+    VR_DET_HASH_MERSENNE_TWISTER,  VR_DET_HASH_MIX64};
+
+static const enum vr_VectorIsa bench_isas[] = {
+    VR_VECTOR_ISA_SCALAR, VR_VECTOR_ISA_SSE, VR_VECTOR_ISA_AVX,
+    VR_VECTOR_ISA_AVX512};
+
+static bool isa_supported(enum vr_VectorIsa isa) {
+  __builtin_cpu_init();
+  switch (isa) {
+  case VR_VECTOR_ISA_AVX512:
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma");
+  case VR_VECTOR_ISA_AVX:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case VR_VECTOR_ISA_SSE:
+    return __builtin_cpu_supports("sse4.2");
+  default:
+    return true;
+  }
+}
+
+static void vector_kernels(std::vector<Kernel> &ks, enum vr_VectorIsa isa,
+                           void *ctx) {
+  switch (isa) {
+  case VR_VECTOR_ISA_AVX512:
+    vector_kernels_avx512(ks, ctx);
+    break;
+  case VR_VECTOR_ISA_AVX:
+    vector_kernels_avx(ks, ctx);
+    break;
+  case VR_VECTOR_ISA_SSE:
+    vector_kernels_sse(ks, ctx);
+    break;
+  default:
+    vector_kernels_scalar(ks, ctx);
+    break;
+  }
+}
+
+// * JSON output
+
+static FILE *out;
+static bool first_result = true;
+
+static void json_number(const char *key, double v) {
+  if (isfinite(v))
+    fprintf(out, ", \"%s\": %.4g", key, v);
+  else
+    fprintf(out, ", \"%s\": null", key);
+}
+
+static void json_result(const Kernel &k, const char *kind,
+                        const char *backend, const char *isa,
+                        enum vr_RoundingMode mode, const char *hash,
+                        const Measure &m) {
+  fprintf(out, "%s\n    {\"entry\": \"%s\", \"op\": \"%s\", \"type\": \"%s\"",
+          first_result ? "" : ",", k.entry.c_str(), k.op.c_str(),
+          k.type.c_str());
+  first_result = false;
+  fprintf(out, ", \"lanes\": %d, \"kind\": \"%s\", \"backend\": \"%s\"",
+          k.lanes, kind, backend);
+  fprintf(out, ", \"isa\": \"%s\", \"rounding_mode\": \"%s\"", isa,
+          verrou_rounding_mode_name(mode));
+  if (hash)
+    fprintf(out, ", \"det_hash\": \"%s\"", hash);
+  else
+    fprintf(out, ", \"det_hash\": null");
+  json_number("ns_per_op", m.ns);
+  json_number("tsc_per_op", m.tsc);
+  for (int i = 0; i < PERF_NB; i++) {
+    const std::string key = std::string(perf_names[i]) + "_per_op";
+    json_number(key.c_str(), m.perf[i]);
+  }
+  fprintf(out, "}");
+}
+
+static void run_kernels(const std::vector<Kernel> &ks, const char *backend,
+                        const char *isa, enum vr_RoundingMode mode,
+                        const char *hash) {
+  for (const Kernel &k : ks) {
+    if (bench_filter && strstr(k.entry.c_str(), bench_filter) == NULL)
+      continue;
+    json_result(k, "latency", backend, isa, mode, hash, measure(k.latency));
+    json_result(k, "throughput", backend, isa, mode, hash,
+                measure(k.throughput));
+  }
+}
+
+static void run_configuration(void *context, enum vr_RoundingMode mode,
+                              enum vr_DetHash hash) {
+  verrou_conf_t conf;
+  memset(&conf, 0, sizeof(conf));
+  conf.default_rounding_mode = mode;
+  conf.rounding_mode = mode;
+  conf.seed = 42;
+  conf.choose_seed = ITrue;
+  conf.vector_isa = VR_VECTOR_ISA_AUTO;
+  conf.det_hash = hash;
+  conf.naninf_check = bench_naninf;
+  const char *hash_name = is_det_mode(mode) ? verrou_det_hash_name(hash) : NULL;
+
+  for (int is_static = 0; is_static < 2; is_static++) {
+    conf.static_backend = is_static ? ITrue : IFalse;
+    interflop_verrou_configure(&conf, context);
+    const struct interflop_backend_interface_t backend =
+        interflop_verrou_init(context);
+    std::vector<Kernel> ks;
+    scalar_kernels(ks, backend, context);
+    run_kernels(ks, is_static ? "static" : "dynamic", "none", mode,
+                hash_name);
+
+    /* the static vector table of the instruction set selected by init */
+    if (is_static && is_vector_mode(mode)) {
+      const enum vr_VectorIsa isa = ((verrou_context_t *)context)->vector_isa;
+      std::vector<Kernel> vks;
+      table_kernels(vks, backend.vbackend.scalar, context);
+      run_kernels(vks, "static", verrou_vector_isa_name(isa), mode, hash_name);
+    }
+  }
+
+  /* the vector entry points read the rounding mode from the context */
+  if (!is_vector_mode(mode))
+    return;
+  for (enum vr_VectorIsa isa : bench_isas) {
+    if (!isa_supported(isa))
+      continue;
+    std::vector<Kernel> ks;
+    vector_kernels(ks, isa, context);
+    run_kernels(ks, "vector", verrou_vector_isa_name(isa), mode, hash_name);
+  }
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [--ops=N] [--repeat=N] [--filter=SUBSTRING] "
+          "[--output=FILE] [--naninf-check=CHECK]\n"
+          "  --ops       operations per measure (default %ld)\n"
+          "  --repeat    measures per kernel, the fastest is kept (default "
+          "%d)\n"
+          "  --filter    only the entry points whose name contains SUBSTRING\n"
+          "  --output    JSON file, stdout by default\n"
+          "  --naninf-check  full, handler-only or off (default full)\n",
+          prog, bench_ops, bench_repeat);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--ops=", 6) == 0) {
+      bench_ops = strtol(argv[i] + 6, NULL, 10);
+    } else if (strncmp(argv[i], "--repeat=", 9) == 0) {
+      bench_repeat = strtol(argv[i] + 9, NULL, 10);
+    } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+      bench_filter = argv[i] + 9;
+    } else if (strncmp(argv[i], "--output=", 9) == 0) {
+      bench_output = argv[i] + 9;
+    } else if (strcmp(argv[i], "--naninf-check=full") == 0) {
+      bench_naninf = VR_NANINF_CHECK_FULL;
+    } else if (strcmp(argv[i], "--naninf-check=handler-only") == 0) {
+      bench_naninf = VR_NANINF_CHECK_HANDLER_ONLY;
+    } else if (strcmp(argv[i], "--naninf-check=off") == 0) {
+      bench_naninf = VR_NANINF_CHECK_OFF;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  /* whole blocks in the throughput kernels */
+  bench_ops = (bench_ops + BLOCK - 1) / BLOCK * BLOCK;
+  if (bench_ops <= 0 || bench_repeat <= 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  out = bench_output ? fopen(bench_output, "w") : stdout;
+  if (out == NULL) {
+    perror(bench_output);
+    return 1;
+  }
+
+  setenv("VFC_BACKENDS_SILENT_LOAD", "True", 1);
+  bench_set_handlers();
+  void *context;
+  interflop_verrou_pre_init(bench_panic, (File *)stderr, &context);
+  perf_init();
+
+  fprintf(out, "{\n  \"backend\": \"%s\",\n  \"version\": \"%s\",\n",
+          interflop_verrou_get_backend_name(),
+          interflop_verrou_get_backend_version());
+  fprintf(out, "  \"tls\": %s,\n  \"ops_per_measure\": %ld,\n",
+          bench_tls ? "true" : "false", bench_ops);
+  fprintf(out, "  \"naninf_check\": \"%s\",\n",
+          verrou_naninf_check_name(bench_naninf));
+  fprintf(out, "  \"perf_counters\": %s,\n  \"results\": [",
+          perf_available() ? "true" : "false");
+
+  for (enum vr_RoundingMode mode : bench_modes) {
+    if (!is_det_mode(mode)) {
+      run_configuration(context, mode, VR_DET_HASH_DOUBLE_TABULATION);
+      continue;
+    }
+    for (enum vr_DetHash hash : bench_hashes)
+      run_configuration(context, mode, hash);
+  }
+
+  fprintf(out, "\n  ]\n}\n");
+  if (out != stdout)
+    fclose(out);
+  return 0;
+}
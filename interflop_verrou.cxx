@@ -31,7 +31,10 @@
 */
 
 #include <argp.h>
+#include <cmath>
+#include <limits>
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "interflop/prng/vr_rand.h"
 
@@ -40,10 +43,14 @@
 #include "interflop/iostream/logger.h"
 #include "interflop_verrou.h"
 #include "static_backends.hxx"
+#include "vr_functions.hxx"
 #include "vr_nextUlp.hxx"
 #include "vr_op.hxx"
 #include "vr_rand_implem.h"
+#include "vr_reduce.hxx"
 #include "vr_roundingOp.hxx"
+#include "vr_samples.hxx"
+#include "x86_64/vr_vrand.hxx"
 
 #if defined(VECT512)
 #include "x86_64/interflop_vector_verrou_avx512.h"
@@ -65,28 +72,260 @@
 static const char backend_name[] = "interflop-verrou";
 static const char backend_version[] = "1.x-dev";
 
-typedef enum { KEY_ROUNDING_MODE, KEY_SEED, KEY_STATIC_BACKEND } key_args;
+typedef enum {
+  KEY_ROUNDING_MODE,
+  KEY_SEED,
+  KEY_STATIC_BACKEND,
+  KEY_VECTOR_ISA,
+  KEY_DET_HASH,
+  KEY_PROFILE_EXACT,
+  KEY_PROFILE_ERROR,
+  KEY_PROFILING_REPORT,
+  KEY_EXCLUDE_FUNCTIONS,
+  KEY_INCLUDE_FUNCTIONS,
+  KEY_SAMPLES,
+  KEY_SAMPLES_JOBS,
+  KEY_SAMPLES_TOLERANCE,
+  KEY_REDUCTION_THREADS,
+  KEY_NANINF_CHECK
+} key_args;
 
 static const char key_rounding_mode_str[] = "rounding-mode";
 static const char key_seed_str[] = "seed";
 static const char key_static_backend_str[] = "static-backend";
+static const char key_vector_isa_str[] = "vector-isa";
+static const char key_det_hash_str[] = "det-hash";
+static const char key_profile_exact_str[] = "profile-exact";
+static const char key_profile_error_str[] = "profile-error";
+static const char key_profiling_report_str[] = "profiling-report";
+static const char key_exclude_functions_str[] = "exclude-functions";
+static const char key_include_functions_str[] = "include-functions";
+static const char key_samples_str[] = "samples";
+static const char key_samples_jobs_str[] = "samples-jobs";
+static const char key_samples_tolerance_str[] = "samples-tolerance";
+static const char key_reduction_threads_str[] = "reduction-threads";
+static const char key_naninf_check_str[] = "naninf-check";
 
 int CHECK_C = 0;
 vr_RoundingMode DEFAULTROUNDINGMODE;
 vr_RoundingMode ROUNDINGMODE;
 unsigned int vr_seed;
 TLS Vr_Rand vr_rand;
+TLS Vr_VRand vr_vrand;
+TLS Vr_HashTables vr_hashTables;
+uint64_t vr_hashTablesSeed;
+TLS Vr_ProfCounters *vr_profCounters;
+TLS Vr_ProfHistograms *vr_profHistograms;
+std::atomic<Vr_ProfCounters *> vr_profList{nullptr};
+std::atomic<Vr_ProfHistograms *> vr_profHistList{nullptr};
+VR_REGION_TLS const Vr_Region *vr_region;
 static File *stderr_stream;
 
+/* the regions the thread entered before vr_region, innermost last */
+#define VR_REGION_MAX_DEPTH 64
+static TLS struct {
+  const Vr_Region *outer[VR_REGION_MAX_DEPTH];
+  int depth;
+} vr_regionStack;
+
+/* the region of each rounding mode, built by interflop_verrou_init */
+static Vr_Region vr_regions[VR_FTZ];
+
+/* the functions of --exclude-functions or --include-functions, and the mode
+   of the region entered with the first of them on the call stack. Each
+   thread keeps its call depth, and the depth of that first one, 0 without */
+static Vr_FunctionSet vr_functions;
+static enum vr_RoundingMode vr_functionMode;
+static TLS int vr_functionDepth;
+static TLS int vr_functionRegionDepth;
+
+/* the samples of --samples or verrou_samples_begin, index -1 outside */
+static Vr_Samples vr_samples = {NULL, -1};
+
+/* the block kernels of verrou_sum and verrou_dot, of the vector
+   implementation selected at initialization */
+template <class T> struct Vr_ReduceKernels {
+  void (*sum)(const T *x, size_t n, T *acc, void *context);
+  void (*dot)(const T *x, const T *y, size_t n, T *acc, void *context);
+};
+template <class T> static Vr_ReduceKernels<T> vr_reduceKernels;
+
+/* the scalar functions of the dynamic backend with the policies of the
+   context, selected at initialization: the vector ones by
+   _verrou_get_vector_backend, the array ones once per call. F of
+   vr_naninfDispatch, PROF is deduced from its tag argument. */
+template <class NANINF> struct Vr_DynamicPolicies {
+  template <class PROF>
+  static void apply(struct interflop_backend_interface_t *backend, PROF) {
+    typedef DynamicRounding<PROF, NANINF> Prof;
+    backend->interflop_add_float = Prof::add_float;
+    backend->interflop_sub_float = Prof::sub_float;
+    backend->interflop_mul_float = Prof::mul_float;
+    backend->interflop_div_float = Prof::div_float;
+    backend->interflop_add_double = Prof::add_double;
+    backend->interflop_sub_double = Prof::sub_double;
+    backend->interflop_mul_double = Prof::mul_double;
+    backend->interflop_div_double = Prof::div_double;
+    backend->interflop_cast_double_to_float = Prof::cast_double_to_float;
+    backend->interflop_fma_float = Prof::fma_float;
+    backend->interflop_fma_double = Prof::fma_double;
+  }
+};
+
+/* lanes of the reductions without a vector implementation of the mode */
+#define VR_REDUCE_LANES 8
+
+template <class T, class PROF, class NANINF>
+static void _verrou_reduce_sum_lanes(const T *x, size_t n, T *acc,
+                                     void *context) {
+  typedef OpWithSelectedRoundingMode<AddOp<T>, PROF, NANINF> Op;
+  for (size_t i = 0; i < n; i += VR_REDUCE_LANES)
+    for (int j = 0; j < VR_REDUCE_LANES; j++)
+      Op::apply(typename Op::PackArgs(acc[j], x[i + j]), &acc[j], context);
+}
+
+template <class T, class PROF, class NANINF>
+static void _verrou_reduce_dot_lanes(const T *x, const T *y, size_t n, T *acc,
+                                     void *context) {
+  typedef OpWithSelectedRoundingMode<MAddOp<T>, PROF, NANINF> Op;
+  for (size_t i = 0; i < n; i += VR_REDUCE_LANES)
+    for (int j = 0; j < VR_REDUCE_LANES; j++)
+      Op::apply(typename Op::PackArgs(x[i + j], y[i + j], acc[j]), &acc[j],
+                context);
+}
+
+static bool _verrou_vector_mode(enum vr_RoundingMode mode) {
+  switch (mode) {
+  case VR_ZERO:
+  case VR_FARTHEST:
+  case VR_FLOAT:
+  case VR_NATIVE:
+  case VR_FTZ:
+    return false;
+  default:
+    return true;
+  }
+}
+
+/*
+ * Sum of x[0, n), or dot product of x and y when y is not NULL (see
+ * vr_reduce.hxx). A block accumulates its element i in the lane i mod 8,
+ * with one addition or one fma in the rounding mode of the caller, the tail
+ * padded with zeros, then sums the lanes pairwise.
+ *
+ * With scaleExp, y is x and the result the sum of the squares of
+ * x * 2^-scaleExp, for verrou_nrm2: each block scales a copy of its elements.
+ */
+template <class T, class PROF, class NANINF>
+static T _verrou_reduce(const T *x, const T *y, size_t n, void *context,
+                        int scaleExp) {
+  typedef OpWithSelectedRoundingMode<AddOp<T>, PROF, NANINF> Add;
+  const verrou_context_t *ctx = (const verrou_context_t *)context;
+  const enum vr_RoundingMode mode = vr_regionMode(ctx);
+  Vr_ReduceKernels<T> kernels = vr_reduceKernels<T>;
+  if (!_verrou_vector_mode(mode))
+    kernels = {_verrou_reduce_sum_lanes<T, PROF, NANINF>,
+               _verrou_reduce_dot_lanes<T, PROF, NANINF>};
+
+  const auto add = [context](T a, T b) {
+    T res;
+    Add::apply(typename Add::PackArgs(a, b), &res, context);
+    return res;
+  };
+  const auto block = [&](size_t b) {
+    const size_t first = b * VR_REDUCE_BLOCK;
+    const size_t len =
+        (n - first < VR_REDUCE_BLOCK) ? n - first : VR_REDUCE_BLOCK;
+    const size_t body = len - len % VR_REDUCE_LANES;
+    const T *xb = x + first;
+    const T *yb = (y == NULL) ? NULL : y + first;
+    T scaled[VR_REDUCE_BLOCK];
+    if (scaleExp != 0) {
+      for (size_t i = 0; i < len; i++)
+        scaled[i] = std::ldexp(xb[i], -scaleExp);
+      xb = yb = scaled;
+    }
+    T acc[VR_REDUCE_LANES] = {0};
+    if (yb == NULL)
+      kernels.sum(xb, body, acc, context);
+    else
+      kernels.dot(xb, yb, body, acc, context);
+    if (body < len) {
+      T xTail[VR_REDUCE_LANES] = {0}, yTail[VR_REDUCE_LANES] = {0};
+      for (size_t i = body; i < len; i++) {
+        xTail[i - body] = xb[i];
+        if (yb != NULL)
+          yTail[i - body] = yb[i];
+      }
+      if (yb == NULL)
+        kernels.sum(xTail, VR_REDUCE_LANES, acc, context);
+      else
+        kernels.dot(xTail, yTail, VR_REDUCE_LANES, acc, context);
+    }
+    for (int width = VR_REDUCE_LANES / 2; width > 0; width /= 2)
+      for (int j = 0; j < width; j++)
+        acc[j] = add(acc[j], acc[j + width]);
+    return acc[0];
+  };
+  return vr_reduce<T>((n + VR_REDUCE_BLOCK - 1) / VR_REDUCE_BLOCK, mode, block,
+                      add);
+}
+
+template <class T, class PROF>
+static T _verrou_reduce_naninf(const T *x, const T *y, size_t n, void *context,
+                               int scaleExp) {
+  const verrou_context_t *ctx = (const verrou_context_t *)context;
+  switch (ctx->naninf_check) {
+  case VR_NANINF_CHECK_HANDLER_ONLY:
+    return _verrou_reduce<T, PROF, vr_naninfHandlerOnly>(x, y, n, context,
+                                                         scaleExp);
+  case VR_NANINF_CHECK_OFF:
+    return _verrou_reduce<T, PROF, vr_naninfOff>(x, y, n, context, scaleExp);
+  default:
+    return _verrou_reduce<T, PROF, vr_naninfFull>(x, y, n, context, scaleExp);
+  }
+}
+
+template <class T>
+static T _verrou_reduce_profiled(const T *x, const T *y, size_t n,
+                                 void *context, int scaleExp = 0) {
+  const verrou_context_t *ctx = (const verrou_context_t *)context;
+  if (ctx->profile_error)
+    return _verrou_reduce_naninf<T, vr_profError>(x, y, n, context, scaleExp);
+  if (ctx->profile_exact)
+    return _verrou_reduce_naninf<T, vr_profExact>(x, y, n, context, scaleExp);
+  return _verrou_reduce_naninf<T, vr_noProf>(x, y, n, context, scaleExp);
+}
+
+/*
+ * sqrt of the sum of the squares of x, scaled as the nrm2 of the reference
+ * BLAS, so that it neither overflows nor underflows before the result does.
+ * The scale is the power of 2 of the largest |x[i]|: the scaled elements are
+ * exact, but for those whose square is negligible. x is not scaled when the
+ * sum cannot overflow nor the largest square underflow, and the choice only
+ * depends on x, which keeps the bits of the deterministic modes.
+ *
+ * The square root and the scaling back are rounded to nearest.
+ */
+template <class T> static T _verrou_nrm2(const T *x, size_t n, void *context) {
+  T amax = 0;
+  for (size_t i = 0; i < n; i++)
+    amax = std::max(amax, std::fabs(x[i])); // skips NaN, which the sum keeps
+  int bits = 0; // of n
+  for (size_t m = n; m != 0; m >>= 1)
+    bits++;
+  const int e = (amax == 0 || !std::isfinite(amax)) ? 0 : std::ilogb(amax);
+  if (2 * e + 2 + bits < std::numeric_limits<T>::max_exponent &&
+      2 * e >= std::numeric_limits<T>::min_exponent - 1)
+    return std::sqrt(_verrou_reduce_profiled<T>(x, x, n, context));
+  return std::ldexp(std::sqrt(_verrou_reduce_profiled<T>(x, x, n, context, e)),
+                    e);
+}
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
-#ifdef PROFILING_EXACT
-unsigned int vr_NumOp;
-unsigned int vr_NumExactOp;
-#endif
-
 /* public functions */
 
 const char *verrou_rounding_mode_name(enum vr_RoundingMode mode) {
@@ -130,6 +369,55 @@ const char *verrou_rounding_mode_name(enum vr_RoundingMode mode) {
   return "undefined";
 }
 
+const char *verrou_vector_isa_name(enum vr_VectorIsa isa) {
+  switch (isa) {
+  case VR_VECTOR_ISA_AUTO:
+    return "auto";
+  case VR_VECTOR_ISA_SCALAR:
+    return "scalar";
+  case VR_VECTOR_ISA_SSE:
+    return "sse";
+  case VR_VECTOR_ISA_AVX:
+    return "avx";
+  case VR_VECTOR_ISA_AVX512:
+    return "avx512";
+  }
+
+  return "undefined";
+}
+
+const char *verrou_det_hash_name(enum vr_DetHash hash) {
+  switch (hash) {
+  case VR_DET_HASH_DOUBLE_TABULATION:
+    return "double_tabulation";
+  case VR_DET_HASH_TABULATION:
+    return "tabulation";
+  case VR_DET_HASH_MULTIPLY_SHIFT:
+    return "multiply_shift";
+  case VR_DET_HASH_DIETZFELBINGER:
+    return "dietzfelbinger";
+  case VR_DET_HASH_MERSENNE_TWISTER:
+    return "mersenne_twister";
+  case VR_DET_HASH_MIX64:
+    return "mix64";
+  }
+
+  return "undefined";
+}
+
+const char *verrou_naninf_check_name(enum vr_NanInfCheck check) {
+  switch (check) {
+  case VR_NANINF_CHECK_FULL:
+    return "full";
+  case VR_NANINF_CHECK_HANDLER_ONLY:
+    return "handler-only";
+  case VR_NANINF_CHECK_OFF:
+    return "off";
+  }
+
+  return "undefined";
+}
+
 void verrou_begin_instr(void *context) {
   verrou_context_t *ctx = (verrou_context_t *)context;
   ctx->rounding_mode = ctx->default_rounding_mode;
@@ -140,27 +428,113 @@ void verrou_end_instr(void *context) {
   ctx->rounding_mode = VR_NEAREST;
 }
 
-void verrou_init_profiling_exact(void) {
-#ifdef PROFILING_EXACT
-  vr_NumOp = 0;
-  vr_NumExactOp = 0;
-#endif
+/* mode of the calling thread, up to the matching verrou_pop_rounding_mode */
+void verrou_push_rounding_mode(enum vr_RoundingMode mode) {
+  if (mode < VR_NEAREST || mode >= VR_FTZ)
+    interflop_panic("verrou_push_rounding_mode: invalid rounding mode");
+  if (vr_regionStack.depth == VR_REGION_MAX_DEPTH)
+    interflop_panic("verrou_push_rounding_mode: too many nested regions");
+  vr_regionStack.outer[vr_regionStack.depth++] = vr_region;
+  vr_region = &vr_regions[mode];
+}
+
+void verrou_pop_rounding_mode(void) {
+  if (vr_regionStack.depth == 0)
+    interflop_panic("verrou_pop_rounding_mode: no region to pop");
+  vr_region = vr_regionStack.outer[--vr_regionStack.depth];
+}
+
+/* with --exclude-functions or --include-functions only */
+void INTERFLOP_VERROU_API(enter_function)(
+    interflop_function_info_t *function_info, [[maybe_unused]] void *context,
+    [[maybe_unused]] int nb_args, [[maybe_unused]] va_list ap) {
+  const int depth = ++vr_functionDepth;
+  // in the region, the functions are not looked up
+  if (vr_functionRegionDepth == 0 &&
+      vr_functionSet_contains(&vr_functions, function_info->id)) {
+    vr_functionRegionDepth = depth;
+    verrou_push_rounding_mode(vr_functionMode);
+  }
+}
+
+void INTERFLOP_VERROU_API(exit_function)(
+    [[maybe_unused]] interflop_function_info_t *function_info,
+    [[maybe_unused]] void *context, [[maybe_unused]] int nb_args,
+    [[maybe_unused]] va_list ap) {
+  if (vr_functionRegionDepth != 0 &&
+      vr_functionDepth == vr_functionRegionDepth) {
+    vr_functionRegionDepth = 0;
+    verrou_pop_rounding_mode();
+  }
+  vr_functionDepth--;
 }
 
-void verrou_get_profiling_exact([[maybe_unused]] unsigned int *num,
-                                [[maybe_unused]] unsigned int *numExact) {
-#ifdef PROFILING_EXACT
-  *num = vr_NumOp;
-  *numExact = vr_NumExactOp;
+void verrou_samples_begin(void *context, int nb_samples) {
+  verrou_context_t *ctx = (verrou_context_t *)context;
+  if (vr_samples.index >= 0)
+    return;
+  if (nb_samples <= 0)
+    nb_samples = (int)ctx->samples;
+  if (nb_samples <= 0)
+    return;
+#ifndef RNG_THREAD_SAFE
+  interflop_fprintf(stderr_stream, "verrou samples: not available in the "
+                                   "backend without TLS, running once\n");
+#else
+  const int index =
+      vr_samples_fork(&vr_samples, stderr_stream, (unsigned int)nb_samples,
+                      ctx->samples_jobs, ctx->samples_tolerance, ctx->seed);
+  // only in the sample: the other threads were not forked
+  ctx->seed += index;
+  vr_hashTablesSeed = ctx->seed;
+  verrou_set_seed(ctx->seed);
 #endif
 }
 
+void verrou_samples_record(const char *name, double value) {
+  if (vr_samples.index < 0)
+    return;
+  if (!vr_samples_record(&vr_samples, name, value))
+    interflop_fprintf(stderr_stream,
+                      "verrou samples: %s dropped, more than %d values\n",
+                      name, VR_SAMPLES_MAX_VALUES);
+}
+
+void verrou_init_profiling_exact(void) { vr_profiling_reset(); }
+
+/* all zero without --profile-exact */
+void verrou_get_profiling(verrou_profiling_t *prof) { vr_profiling_sum(prof); }
+
+/* all zero without --profile-error */
+void verrou_get_error_histograms(verrou_error_histograms_t *hist) {
+  vr_profiling_sumHistograms(hist);
+}
+
+/* totals of verrou_get_profiling, truncated to 32 bits */
+void verrou_get_profiling_exact(unsigned int *num, unsigned int *numExact) {
+  verrou_profiling_t prof;
+  vr_profiling_sum(&prof);
+  uint64_t total = 0, totalExact = 0;
+  for (int op = 0; op < VR_PROF_NB_OP; op++) {
+    for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+      total += prof.numOp[op][type];
+      totalExact += prof.numExactOp[op][type];
+    }
+  }
+  *num = (unsigned int)total;
+  *numExact = (unsigned int)totalExact;
+}
+
 void verrou_set_seed(unsigned int seed) {
   vr_seed = vr_rand_next(&vr_rand);
   vr_rand_setSeed(&vr_rand, seed);
+  vr_vrand_setSeed(&vr_vrand, seed);
 }
 
-void verrou_set_random_seed() { vr_rand_setSeed(&vr_rand, vr_seed); }
+void verrou_set_random_seed() {
+  vr_rand_setSeed(&vr_rand, vr_seed);
+  vr_vrand_setSeed(&vr_vrand, vr_seed);
+}
 
 double verrou_prandom_pvalue(void) { return vr_rand.p; }
 
@@ -239,6 +613,109 @@ IFV_INLINE void INTERFLOP_VERROU_API(fma_float)(float a, float b, float c,
   Op::apply(Op::PackArgs(a, b, c), res, context);
 }
 
+void INTERFLOP_VERROU_API(add_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context) {
+  typedef OpWithSelectedRoundingMode<AddOp<double>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(add_float_array)(const float *a, const float *b,
+                                           float *res, size_t n,
+                                           void *context) {
+  typedef OpWithSelectedRoundingMode<AddOp<float>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(sub_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context) {
+  typedef OpWithSelectedRoundingMode<SubOp<double>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(sub_float_array)(const float *a, const float *b,
+                                           float *res, size_t n,
+                                           void *context) {
+  typedef OpWithSelectedRoundingMode<SubOp<float>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(mul_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context) {
+  typedef OpWithSelectedRoundingMode<MulOp<double>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(mul_float_array)(const float *a, const float *b,
+                                           float *res, size_t n,
+                                           void *context) {
+  typedef OpWithSelectedRoundingMode<MulOp<float>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(div_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context) {
+  typedef OpWithSelectedRoundingMode<DivOp<double>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(div_float_array)(const float *a, const float *b,
+                                           float *res, size_t n,
+                                           void *context) {
+  typedef OpWithSelectedRoundingMode<DivOp<float>> Op;
+  Op::applyArray(res, n, context, a, b);
+}
+
+void INTERFLOP_VERROU_API(cast_double_to_float_array)(const double *a,
+                                                      float *res, size_t n,
+                                                      void *context) {
+  typedef OpWithSelectedRoundingMode<CastOp<double, float>> Op;
+  Op::applyArray(res, n, context, a);
+}
+
+void INTERFLOP_VERROU_API(fma_double_array)(const double *a, const double *b,
+                                            const double *c, double *res,
+                                            size_t n, void *context) {
+  typedef OpWithSelectedRoundingMode<MAddOp<double>> Op;
+  Op::applyArray(res, n, context, a, b, c);
+}
+
+void INTERFLOP_VERROU_API(fma_float_array)(const float *a, const float *b,
+                                           const float *c, float *res,
+                                           size_t n, void *context) {
+  typedef OpWithSelectedRoundingMode<MAddOp<float>> Op;
+  Op::applyArray(res, n, context, a, b, c);
+}
+
+double verrou_sum_double(const double *x, size_t n, void *context) {
+  return _verrou_reduce_profiled<double>(x, NULL, n, context);
+}
+
+float verrou_sum_float(const float *x, size_t n, void *context) {
+  return _verrou_reduce_profiled<float>(x, NULL, n, context);
+}
+
+double verrou_dot_double(const double *x, const double *y, size_t n,
+                         void *context) {
+  return _verrou_reduce_profiled<double>(x, y, n, context);
+}
+
+float verrou_dot_float(const float *x, const float *y, size_t n,
+                       void *context) {
+  return _verrou_reduce_profiled<float>(x, y, n, context);
+}
+
+double verrou_nrm2_double(const double *x, size_t n, void *context) {
+  return _verrou_nrm2<double>(x, n, context);
+}
+
+float verrou_nrm2_float(const float *x, size_t n, void *context) {
+  return _verrou_nrm2<float>(x, n, context);
+}
+
 static void _interflop_usercall_inexact([[maybe_unused]] void *context,
                                         va_list ap) {
   typedef std::underlying_type<enum FTYPES>::type ftypes_t;
@@ -267,19 +744,240 @@ static void _interflop_usercall_inexact([[maybe_unused]] void *context,
   }
 }
 
+static const char *_verrou_prof_op_name[VR_PROF_NB_OP] = {
+    "add", "sub", "mul", "div", "madd", "cast"};
+static const char *_verrou_prof_type_name[VR_PROF_NB_TYPE] = {"float",
+                                                               "double"};
+
+static bool _verrou_has_suffix(const char *str, const char *suffix) {
+  const char *s = str, *t = suffix;
+  while (*s)
+    s++;
+  while (*t)
+    t++;
+  while (s != str && t != suffix && *(s - 1) == *(t - 1)) {
+    s--;
+    t--;
+  }
+  return t == suffix;
+}
+
+/*
+ * Writes the nonzero buckets of the histograms of --profile-error, each one
+ * labelled with the log2 of its lower bound: a JSON member, or CSV rows
+ */
+static void _verrou_histograms_report(File *stream, bool json) {
+  static verrou_error_histograms_t hist;
+  vr_profiling_sumHistograms(&hist);
+
+  if (json)
+    interflop_fprintf(stream, ",\n  \"histograms\": [");
+  else
+    interflop_fprintf(stream, "\nop,type,histogram,bucket,count\n");
+  bool first = true;
+  for (int op = 0; op < VR_PROF_NB_OP; op++) {
+    for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+      const uint64_t *error = hist.error[op][type];
+      const uint64_t *exponent = hist.exponent[op][type];
+      const char *opName = _verrou_prof_op_name[op];
+      const char *typeName = _verrou_prof_type_name[type];
+      if (json) {
+        interflop_fprintf(stream,
+                          "%s\n    {\"op\": \"%s\", \"type\": \"%s\", "
+                          "\"error\": {",
+                          first ? "" : ",", opName, typeName);
+        first = false;
+      }
+      const char *sep = "";
+      for (int b = 0; b < VR_PROF_NB_ERROR_BUCKET; b++) {
+        if (error[b] == 0)
+          continue;
+        if (b == 0 && json)
+          interflop_fprintf(stream, "\"exact\": %llu",
+                            (unsigned long long)error[b]);
+        else if (b == 0)
+          interflop_fprintf(stream, "%s,%s,error,exact,%llu\n", opName,
+                            typeName, (unsigned long long)error[b]);
+        else if (json)
+          interflop_fprintf(stream, "%s\"%d\": %llu", sep, -b,
+                            (unsigned long long)error[b]);
+        else
+          interflop_fprintf(stream, "%s,%s,error,%d,%llu\n", opName, typeName,
+                            -b, (unsigned long long)error[b]);
+        sep = ", ";
+      }
+      if (json)
+        interflop_fprintf(stream, "}, \"exponent\": {");
+      sep = "";
+      for (int b = 0; b < VR_PROF_NB_EXP_BUCKET; b++) {
+        if (exponent[b] == 0)
+          continue;
+        if (b == 0 && json)
+          interflop_fprintf(stream, "\"zero\": %llu",
+                            (unsigned long long)exponent[b]);
+        else if (b == 0)
+          interflop_fprintf(stream, "%s,%s,exponent,zero,%llu\n", opName,
+                            typeName, (unsigned long long)exponent[b]);
+        else if (json)
+          interflop_fprintf(stream, "%s\"%d\": %llu", sep,
+                            b + VR_PROF_EXP_BUCKET_MIN,
+                            (unsigned long long)exponent[b]);
+        else
+          interflop_fprintf(stream, "%s,%s,exponent,%d,%llu\n", opName,
+                            typeName, b + VR_PROF_EXP_BUCKET_MIN,
+                            (unsigned long long)exponent[b]);
+        sep = ", ";
+      }
+      if (json)
+        interflop_fprintf(stream, "}}");
+    }
+  }
+  if (json)
+    interflop_fprintf(stream, "\n  ]");
+}
+
+/*
+ * Writes the counters of --profile-exact to path, and the histograms of
+ * --profile-error when histograms is set, as JSON when it ends with .json and
+ * as CSV otherwise, or to stderr when path is NULL
+ */
+static void _verrou_profiling_report(const char *path, bool histograms) {
+  verrou_profiling_t prof;
+  vr_profiling_sum(&prof);
+
+  File *stream = stderr_stream;
+  int error = 0;
+  if (path != NULL) {
+    INTERFLOP_CHECK_IMPL(fopen);
+    INTERFLOP_CHECK_IMPL(fclose);
+    stream = interflop_fopen(path, "w", &error);
+    if (stream == NULL) {
+      interflop_fprintf(stderr_stream, "%s: cannot open %s\n",
+                        key_profiling_report_str, path);
+      return;
+    }
+  }
+  const bool json = (path != NULL) && _verrou_has_suffix(path, ".json");
+
+  unsigned long long total = 0, totalExact = 0;
+  if (json)
+    interflop_fprintf(stream, "{\n  \"operations\": [");
+  else
+    interflop_fprintf(stream, "op,type,num_op,num_exact_op\n");
+  for (int op = 0; op < VR_PROF_NB_OP; op++) {
+    for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+      const unsigned long long num = prof.numOp[op][type];
+      const unsigned long long numExact = prof.numExactOp[op][type];
+      total += num;
+      totalExact += numExact;
+      if (json)
+        interflop_fprintf(stream,
+                          "%s\n    {\"op\": \"%s\", \"type\": \"%s\", "
+                          "\"num_op\": %llu, \"num_exact_op\": %llu}",
+                          (op == 0 && type == 0) ? "" : ",",
+                          _verrou_prof_op_name[op],
+                          _verrou_prof_type_name[type], num, numExact);
+      else
+        interflop_fprintf(stream, "%s,%s,%llu,%llu\n",
+                          _verrou_prof_op_name[op],
+                          _verrou_prof_type_name[type], num, numExact);
+    }
+  }
+  if (json)
+    interflop_fprintf(stream,
+                      "\n  ],\n  \"num_op\": %llu,\n  \"num_exact_op\": "
+                      "%llu",
+                      total, totalExact);
+  else
+    interflop_fprintf(stream, "total,,%llu,%llu\n", total, totalExact);
+  if (histograms)
+    _verrou_histograms_report(stream, json);
+  if (json)
+    interflop_fprintf(stream, "\n}\n");
+
+  if (path != NULL)
+    interflop_fclose(stream, &error);
+}
+
 void INTERFLOP_VERROU_API(user_call)(void *context, interflop_call_id id,
                                      va_list ap) {
-  switch (id) {
+  switch ((int)id) {
   case INTERFLOP_INEXACT_ID:
     _interflop_usercall_inexact(context, ap);
     break;
+  case VERROU_PROFILING_RESET_ID:
+    verrou_init_profiling_exact();
+    break;
+  case VERROU_PROFILING_GET_ID:
+    verrou_get_profiling(va_arg(ap, verrou_profiling_t *));
+    break;
+  case VERROU_PROFILING_REPORT_ID:
+    _verrou_profiling_report(va_arg(ap, const char *),
+                             ((verrou_context_t *)context)->profile_error);
+    break;
+  case VERROU_ERROR_HISTOGRAMS_GET_ID:
+    verrou_get_error_histograms(va_arg(ap, verrou_error_histograms_t *));
+    break;
+  case VERROU_PUSH_ROUNDING_MODE_ID:
+    verrou_push_rounding_mode((enum vr_RoundingMode)va_arg(ap, int));
+    break;
+  case VERROU_POP_ROUNDING_MODE_ID:
+    verrou_pop_rounding_mode();
+    break;
+  case VERROU_SAMPLES_BEGIN_ID:
+    verrou_samples_begin(context, va_arg(ap, int));
+    break;
+  case VERROU_SAMPLES_RECORD_ID: {
+    const char *name = va_arg(ap, const char *);
+    verrou_samples_record(name, va_arg(ap, double));
+    break;
+  }
+  case VERROU_SUM_DOUBLE_ID:
+  case VERROU_NRM2_DOUBLE_ID: {
+    const double *x = va_arg(ap, const double *);
+    const size_t n = va_arg(ap, size_t);
+    *va_arg(ap, double *) = ((int)id == VERROU_SUM_DOUBLE_ID)
+                                ? verrou_sum_double(x, n, context)
+                                : verrou_nrm2_double(x, n, context);
+    break;
+  }
+  case VERROU_SUM_FLOAT_ID:
+  case VERROU_NRM2_FLOAT_ID: {
+    const float *x = va_arg(ap, const float *);
+    const size_t n = va_arg(ap, size_t);
+    *va_arg(ap, float *) = ((int)id == VERROU_SUM_FLOAT_ID)
+                               ? verrou_sum_float(x, n, context)
+                               : verrou_nrm2_float(x, n, context);
+    break;
+  }
+  case VERROU_DOT_DOUBLE_ID: {
+    const double *x = va_arg(ap, const double *);
+    const double *y = va_arg(ap, const double *);
+    const size_t n = va_arg(ap, size_t);
+    *va_arg(ap, double *) = verrou_dot_double(x, y, n, context);
+    break;
+  }
+  case VERROU_DOT_FLOAT_ID: {
+    const float *x = va_arg(ap, const float *);
+    const float *y = va_arg(ap, const float *);
+    const size_t n = va_arg(ap, size_t);
+    *va_arg(ap, float *) = verrou_dot_float(x, y, n, context);
+    break;
+  }
   default:
     interflop_fprintf(stderr_stream, "Unknown interflop_call id (=%d)", id);
     break;
   }
 }
 
-void INTERFLOP_VERROU_API(finalize)([[maybe_unused]] void *context) {}
+void INTERFLOP_VERROU_API(finalize)(void *context) {
+  verrou_context_t *ctx = (verrou_context_t *)context;
+#ifdef RNG_THREAD_SAFE
+  vr_reducePool_stop();
+#endif
+  if (ctx->profile_exact || ctx->profile_error)
+    _verrou_profiling_report(ctx->profiling_report, ctx->profile_error);
+}
 
 const char *INTERFLOP_VERROU_API(get_backend_name)() { return backend_name; }
 
@@ -296,6 +994,7 @@ void _verrou_check_stdlib(void) {
   INTERFLOP_CHECK_IMPL(malloc);
   INTERFLOP_CHECK_IMPL(nanHandler);
   INTERFLOP_CHECK_IMPL(strcasecmp);
+  INTERFLOP_CHECK_IMPL(strtod);
   INTERFLOP_CHECK_IMPL(strtol);
 }
 
@@ -307,6 +1006,18 @@ void _verrou_init_context(verrou_context_t *ctx) {
   ctx->default_rounding_mode = VERROU_ROUDING_MODE_DEFAULT;
   ctx->rounding_mode = VERROU_ROUDING_MODE_DEFAULT; // default value
   ctx->static_backend = VERROU_STATIC_BACKEND_DEFAULT;
+  ctx->vector_isa = VERROU_VECTOR_ISA_DEFAULT;
+  ctx->det_hash = vr_detHashId<VERROU_DET_HASH>::value;
+  ctx->profile_exact = VERROU_PROFILE_EXACT_DEFAULT;
+  ctx->profile_error = VERROU_PROFILE_ERROR_DEFAULT;
+  ctx->profiling_report = NULL;
+  ctx->exclude_functions = NULL;
+  ctx->include_functions = NULL;
+  ctx->samples = VERROU_SAMPLES_DEFAULT;
+  ctx->samples_jobs = VERROU_SAMPLES_JOBS_DEFAULT;
+  ctx->samples_tolerance = VERROU_SAMPLES_TOLERANCE_DEFAULT;
+  ctx->reduction_threads = VERROU_REDUCTION_THREADS_DEFAULT;
+  ctx->naninf_check = VERROU_NANINF_CHECK_DEFAULT;
   ctx->seed = VERROU_SEED_DEFAULT;
   ctx->choose_seed = false;
 }
@@ -335,8 +1046,77 @@ static struct argp_option options[] = {
      "load the operators directly instead of switching which makes "
      "computations faster",
      0},
+    {key_vector_isa_str, KEY_VECTOR_ISA, "ISA", 0,
+     "select the vector implementation among {auto, scalar, sse, avx, "
+     "avx512}; auto picks the widest one supported by the CPU",
+     0},
+    {key_det_hash_str, KEY_DET_HASH, "HASH", 0,
+     "select the hash of the det and comdet rounding modes among "
+     "{double_tabulation, tabulation, multiply_shift, dietzfelbinger, "
+     "mersenne_twister, mix64}",
+     0},
+    {key_profile_exact_str, KEY_PROFILE_EXACT, 0, 0,
+     "count the operations and the exact operations, by operation and type",
+     0},
+    {key_profile_error_str, KEY_PROFILE_ERROR, 0, 0,
+     "as --profile-exact, with the histograms of the relative errors and of "
+     "the result exponents",
+     0},
+    {key_profiling_report_str, KEY_PROFILING_REPORT, "FILE", 0,
+     "write the counters of --profile-exact or --profile-error to FILE at "
+     "exit, as JSON if it ends with .json and CSV otherwise (default: CSV on "
+     "stderr)",
+     0},
+    {key_exclude_functions_str, KEY_EXCLUDE_FUNCTIONS, "FILE", 0,
+     "round to nearest the functions listed in FILE, one per line, and their "
+     "callees",
+     0},
+    {key_include_functions_str, KEY_INCLUDE_FUNCTIONS, "FILE", 0,
+     "only perturb the functions listed in FILE, one per line, and their "
+     "callees; the others are rounded to nearest",
+     0},
+    {key_samples_str, KEY_SAMPLES, "N", 0,
+     "run the program N times in parallel forked processes, with the seeds "
+     "SEED to SEED+N-1, and report the values they record",
+     0},
+    {key_samples_jobs_str, KEY_SAMPLES_JOBS, "J", 0,
+     "run at most J samples at a time (default: the number of CPUs)", 0},
+    {key_samples_tolerance_str, KEY_SAMPLES_TOLERANCE, "DIGITS", 0,
+     "stop the samples once the estimated significant digits of every value "
+     "vary by at most DIGITS (default: 0.1, 0 runs them all)",
+     0},
+    {key_reduction_threads_str, KEY_REDUCTION_THREADS, "T", 0,
+     "share verrou_sum, verrou_dot and verrou_nrm2 among at most T threads "
+     "(default: the number of CPUs)",
+     0},
+    {key_naninf_check_str, KEY_NANINF_CHECK, "CHECK", 0,
+     "select the handling of the NaN and Inf results among {full, "
+     "handler-only, off}: full keeps them unperturbed and calls the NaN and "
+     "Inf handlers, handler-only only calls the handlers, off does neither",
+     0},
     end_option};
 
+/* the combinations of --exclude-functions and --include-functions which are
+   rejected, at the end of the options and at initialization: ftz is not a
+   mode of the regions the listed functions enter and leave (vr_regions) */
+static void _verrou_check_functions(const verrou_context_t *ctx) {
+  if (ctx->exclude_functions == NULL && ctx->include_functions == NULL)
+    return;
+  if (ctx->exclude_functions != NULL && ctx->include_functions != NULL) {
+    interflop_fprintf(stderr_stream, "%s and %s are exclusive\n",
+                      key_exclude_functions_str, key_include_functions_str);
+    interflop_exit(42);
+  }
+  if (ctx->rounding_mode == VR_FTZ) {
+    interflop_fprintf(stderr_stream, "%s=ftz cannot be used with %s\n",
+                      key_rounding_mode_str,
+                      ctx->include_functions != NULL
+                          ? key_include_functions_str
+                          : key_exclude_functions_str);
+    interflop_exit(42);
+  }
+}
+
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
   verrou_context_t *ctx = (verrou_context_t *)state->input;
   int error = 0;
@@ -405,6 +1185,146 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     /* static backend */
     ctx->static_backend = true;
     break;
+
+  case KEY_VECTOR_ISA:
+    /* vector implementation */
+    if (interflop_strcasecmp("auto", arg) == 0) {
+      ctx->vector_isa = VR_VECTOR_ISA_AUTO;
+    } else if (interflop_strcasecmp("scalar", arg) == 0) {
+      ctx->vector_isa = VR_VECTOR_ISA_SCALAR;
+    } else if (interflop_strcasecmp("sse", arg) == 0) {
+      ctx->vector_isa = VR_VECTOR_ISA_SSE;
+    } else if (interflop_strcasecmp("avx", arg) == 0) {
+      ctx->vector_isa = VR_VECTOR_ISA_AVX;
+    } else if (interflop_strcasecmp("avx512", arg) == 0) {
+      ctx->vector_isa = VR_VECTOR_ISA_AVX512;
+    } else {
+      interflop_fprintf(stderr_stream,
+                        "%s invalid value provided, must be one of: "
+                        "auto, scalar, sse, avx, avx512.\n",
+                        key_vector_isa_str);
+      interflop_exit(42);
+    }
+    break;
+
+  case KEY_DET_HASH:
+    /* hash of the det and comdet rounding modes */
+    if (interflop_strcasecmp("double_tabulation", arg) == 0) {
+      ctx->det_hash = VR_DET_HASH_DOUBLE_TABULATION;
+    } else if (interflop_strcasecmp("tabulation", arg) == 0) {
+      ctx->det_hash = VR_DET_HASH_TABULATION;
+    } else if (interflop_strcasecmp("multiply_shift", arg) == 0) {
+      ctx->det_hash = VR_DET_HASH_MULTIPLY_SHIFT;
+    } else if (interflop_strcasecmp("dietzfelbinger", arg) == 0) {
+      ctx->det_hash = VR_DET_HASH_DIETZFELBINGER;
+    } else if (interflop_strcasecmp("mersenne_twister", arg) == 0) {
+      ctx->det_hash = VR_DET_HASH_MERSENNE_TWISTER;
+    } else if (interflop_strcasecmp("mix64", arg) == 0) {
+      ctx->det_hash = VR_DET_HASH_MIX64;
+    } else {
+      interflop_fprintf(stderr_stream,
+                        "%s invalid value provided, must be one of: "
+                        "double_tabulation, tabulation, multiply_shift, "
+                        "dietzfelbinger, mersenne_twister, mix64.\n",
+                        key_det_hash_str);
+      interflop_exit(42);
+    }
+    break;
+
+  case KEY_PROFILE_EXACT:
+    /* profiled instantiations of the rounding modes */
+    ctx->profile_exact = true;
+    break;
+
+  case KEY_PROFILE_ERROR:
+    /* profiled instantiations, with the error histograms */
+    ctx->profile_error = true;
+    break;
+
+  case KEY_PROFILING_REPORT:
+    /* report file of the profiling counters */
+    ctx->profiling_report = arg;
+    break;
+
+  case KEY_EXCLUDE_FUNCTIONS:
+    /* functions rounded to nearest, read at initialization */
+    ctx->exclude_functions = arg;
+    break;
+
+  case KEY_INCLUDE_FUNCTIONS:
+    /* the only functions perturbed, read at initialization */
+    ctx->include_functions = arg;
+    break;
+
+  case KEY_SAMPLES:
+  case KEY_SAMPLES_JOBS:
+  case KEY_REDUCTION_THREADS: {
+    /* number of samples, of samples at a time, of reduction threads */
+    char *endptr;
+    const long n = interflop_strtol(arg, &endptr, &error);
+    if (error != 0 || n < 0) {
+      interflop_fprintf(stderr_stream,
+                        "%s invalid value provided, must be a non-negative "
+                        "integer\n",
+                        key == KEY_SAMPLES        ? key_samples_str
+                        : key == KEY_SAMPLES_JOBS ? key_samples_jobs_str
+                                                  : key_reduction_threads_str);
+      interflop_exit(42);
+    }
+#ifndef RNG_THREAD_SAFE
+    if (key == KEY_SAMPLES && n > 0) {
+      interflop_fprintf(stderr_stream,
+                        "%s is not available in the backend without TLS\n",
+                        key_samples_str);
+      interflop_exit(42);
+    }
+#endif
+    if (key == KEY_SAMPLES)
+      ctx->samples = (unsigned int)n;
+    else if (key == KEY_SAMPLES_JOBS)
+      ctx->samples_jobs = (unsigned int)n;
+    else
+      ctx->reduction_threads = (unsigned int)n;
+    break;
+  }
+
+  case KEY_SAMPLES_TOLERANCE: {
+    /* early stopping of the samples */
+    error = 0;
+    char *endptr;
+    ctx->samples_tolerance = interflop_strtod(arg, &endptr, &error);
+    if (error != 0 || endptr == arg || *endptr != '\0' ||
+        ctx->samples_tolerance < 0) {
+      interflop_fprintf(stderr_stream,
+                        "%s invalid value provided, must be a non-negative "
+                        "number\n",
+                        key_samples_tolerance_str);
+      interflop_exit(42);
+    }
+    break;
+  }
+
+  case KEY_NANINF_CHECK:
+    /* policy of the NaN and Inf results */
+    if (interflop_strcasecmp("full", arg) == 0) {
+      ctx->naninf_check = VR_NANINF_CHECK_FULL;
+    } else if (interflop_strcasecmp("handler-only", arg) == 0) {
+      ctx->naninf_check = VR_NANINF_CHECK_HANDLER_ONLY;
+    } else if (interflop_strcasecmp("off", arg) == 0) {
+      ctx->naninf_check = VR_NANINF_CHECK_OFF;
+    } else {
+      interflop_fprintf(stderr_stream,
+                        "%s invalid value provided, must be one of: "
+                        "full, handler-only, off.\n",
+                        key_naninf_check_str);
+      interflop_exit(42);
+    }
+    break;
+
+  case ARGP_KEY_END:
+    _verrou_check_functions(ctx);
+    break;
+
   default:
     return ARGP_ERR_UNKNOWN;
   }
@@ -435,6 +1355,18 @@ void INTERFLOP_VERROU_API(configure)(void *configure, void *context) {
   ctx->seed = conf->seed;
   ctx->choose_seed = conf->choose_seed;
   ctx->static_backend = conf->static_backend;
+  ctx->vector_isa = conf->vector_isa;
+  ctx->det_hash = conf->det_hash;
+  ctx->profile_exact = conf->profile_exact;
+  ctx->profile_error = conf->profile_error;
+  ctx->profiling_report = conf->profiling_report;
+  ctx->exclude_functions = conf->exclude_functions;
+  ctx->include_functions = conf->include_functions;
+  ctx->samples = conf->samples;
+  ctx->samples_jobs = conf->samples_jobs;
+  ctx->samples_tolerance = conf->samples_tolerance;
+  ctx->reduction_threads = conf->reduction_threads;
+  ctx->naninf_check = conf->naninf_check;
 }
 
 static void _interflop_set_seed(u_int64_t seed, void *context) {
@@ -447,6 +1379,7 @@ static void _interflop_set_seed(u_int64_t seed, void *context) {
     ctx->seed = t1.tv_sec ^ t1.tv_usec ^ interflop_gettid();
   }
 
+  vr_hashTablesSeed = ctx->seed;
   verrou_set_seed(ctx->seed);
 }
 
@@ -468,9 +1401,98 @@ static void print_information_header(void *context) {
   logger_info("%s = %llu\n", key_seed_str, ctx->seed);
   logger_info("%s = %s\n", key_static_backend_str,
               ctx->static_backend ? "true" : "false");
+  logger_info("%s = %s\n", key_vector_isa_str,
+              verrou_vector_isa_name(ctx->vector_isa));
+  logger_info("%s = %s\n", key_det_hash_str,
+              verrou_det_hash_name(ctx->det_hash));
+  logger_info("%s = %s\n", key_profile_exact_str,
+              ctx->profile_exact ? "true" : "false");
+  logger_info("%s = %s\n", key_profile_error_str,
+              ctx->profile_error ? "true" : "false");
+  logger_info("%s = %s\n", key_exclude_functions_str,
+              ctx->exclude_functions ? ctx->exclude_functions : "none");
+  logger_info("%s = %s\n", key_include_functions_str,
+              ctx->include_functions ? ctx->include_functions : "none");
+  logger_info("%s = %u\n", key_samples_str, ctx->samples);
+  if (ctx->samples > 0) {
+    logger_info("%s = %u\n", key_samples_jobs_str, ctx->samples_jobs);
+    logger_info("%s = %g\n", key_samples_tolerance_str,
+                ctx->samples_tolerance);
+  }
+  logger_info("%s = %u\n", key_reduction_threads_str, ctx->reduction_threads);
+  logger_info("%s = %s\n", key_naninf_check_str,
+              verrou_naninf_check_name(ctx->naninf_check));
+}
+
+/* widest vector implementation the CPU can run */
+static enum vr_VectorIsa _verrou_detect_vector_isa(void) {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma"))
+    return VR_VECTOR_ISA_AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return VR_VECTOR_ISA_AVX;
+  if (__builtin_cpu_supports("sse4.2"))
+    return VR_VECTOR_ISA_SSE;
+  return VR_VECTOR_ISA_SCALAR;
+}
+
+static enum vr_VectorIsa _verrou_select_vector_isa(enum vr_VectorIsa isa) {
+  const enum vr_VectorIsa supported = _verrou_detect_vector_isa();
+  if (isa == VR_VECTOR_ISA_AUTO)
+    return supported;
+  if (isa > supported) {
+    interflop_fprintf(stderr_stream,
+                      "%s %s is not supported by this CPU, must be at most "
+                      "%s\n",
+                      key_vector_isa_str, verrou_vector_isa_name(isa),
+                      verrou_vector_isa_name(supported));
+    interflop_exit(42);
+  }
+  return isa;
+}
+
+static struct interflop_vector_type_t
+_verrou_get_vector_backend(verrou_context_t *ctx) {
+  switch (ctx->vector_isa) {
+  case VR_VECTOR_ISA_AVX512:
+    return interflop_vector_verrou_init_avx512(ctx);
+  case VR_VECTOR_ISA_AVX:
+    return interflop_vector_verrou_init_avx(ctx);
+  case VR_VECTOR_ISA_SSE:
+    return interflop_vector_verrou_init_sse(ctx);
+  default:
+    return interflop_vector_verrou_init_scalar(ctx);
+  }
 }
 
-struct interflop_backend_interface_t _verrou_get_dynamic_backend(void) {
+#define VR_REDUCE_KERNELS(ISA)                                                 \
+  vr_reduceKernels<float> = {interflop_vector_verrou_reduce_sum_float_8_##ISA, \
+                             interflop_vector_verrou_reduce_dot_float_8_##ISA}; \
+  vr_reduceKernels<double> = {                                                 \
+      interflop_vector_verrou_reduce_sum_double_8_##ISA,                       \
+      interflop_vector_verrou_reduce_dot_double_8_##ISA};
+
+static void _verrou_init_reduce_kernels(verrou_context_t *ctx) {
+  switch (ctx->vector_isa) {
+  case VR_VECTOR_ISA_AVX512:
+    VR_REDUCE_KERNELS(avx512);
+    break;
+  case VR_VECTOR_ISA_AVX:
+    VR_REDUCE_KERNELS(avx);
+    break;
+  case VR_VECTOR_ISA_SSE:
+    VR_REDUCE_KERNELS(sse);
+    break;
+  default:
+    VR_REDUCE_KERNELS(scalar);
+    break;
+  }
+}
+
+#undef VR_REDUCE_KERNELS
+
+struct interflop_backend_interface_t
+_verrou_get_dynamic_backend(verrou_context_t *ctx) {
   struct interflop_backend_interface_t interflop_backend_verrou = {
     interflop_add_float : INTERFLOP_VERROU_API(add_float),
     interflop_sub_float : INTERFLOP_VERROU_API(sub_float),
@@ -489,25 +1511,101 @@ struct interflop_backend_interface_t _verrou_get_dynamic_backend(void) {
     interflop_exit_function : NULL,
     interflop_user_call : INTERFLOP_VERROU_API(user_call),
     interflop_finalize : INTERFLOP_VERROU_API(finalize),
-    vbackend : {
-      scalar : interflop_vector_verrou_init_scalar (nullptr),
-      vector128 : interflop_vector_verrou_init_sse (nullptr),
-      vector256 : interflop_vector_verrou_init_avx (nullptr),
-      vector512 : interflop_vector_verrou_init_avx512 (nullptr)
-    }
+    vbackend : {} // set by _verrou_set_vector_backend
   };
+  if (ctx->profile_error)
+    vr_naninfDispatch<Vr_DynamicPolicies>(
+        ctx->naninf_check, &interflop_backend_verrou, vr_profError());
+  else if (ctx->profile_exact)
+    vr_naninfDispatch<Vr_DynamicPolicies>(
+        ctx->naninf_check, &interflop_backend_verrou, vr_profExact());
+  else if (ctx->naninf_check != VR_NANINF_CHECK_FULL)
+    vr_naninfDispatch<Vr_DynamicPolicies>(
+        ctx->naninf_check, &interflop_backend_verrou, vr_noProf());
   return interflop_backend_verrou;
 }
 
+/* every slot gets the selected implementation: each one handles all the
+   vector sizes. With --static-backend, it is static too. */
+static void
+_verrou_set_vector_backend(struct interflop_backend_interface_t *backend,
+                           verrou_context_t *ctx) {
+  const struct interflop_vector_type_t vector_backend =
+      _verrou_get_vector_backend(ctx);
+  backend->vbackend = {
+    scalar : vector_backend,
+    vector128 : vector_backend,
+    vector256 : vector_backend,
+    vector512 : vector_backend
+  };
+}
+
+/* the region of each mode: the static entry points of the mode, with the
+   det hash and the profiling policy of ctx, are only called by the static
+   backend */
+static void _verrou_init_regions(verrou_context_t *ctx) {
+  for (int mode = VR_NEAREST; mode < VR_FTZ; mode++) {
+    Vr_Region *region = &vr_regions[mode];
+    region->mode = (enum vr_RoundingMode)mode;
+    if (!ctx->static_backend)
+      continue;
+    verrou_context_t region_ctx = *ctx;
+    region_ctx.rounding_mode = region->mode;
+    region->backend = get_static_backend(&region_ctx);
+    _verrou_set_vector_backend(&region->backend, &region_ctx);
+  }
+}
+
+/* reads the list of --exclude-functions or --include-functions, false
+   without one. With --include-functions, the context rounds to nearest and
+   the listed functions enter a region of its rounding mode. */
+static bool _verrou_init_functions(verrou_context_t *ctx) {
+  _verrou_check_functions(ctx);
+  const bool include = (ctx->include_functions != NULL);
+  const char *path = include ? ctx->include_functions : ctx->exclude_functions;
+  if (path == NULL)
+    return false;
+  if (!vr_functionSet_load(&vr_functions, path)) {
+    interflop_fprintf(stderr_stream, "%s cannot read %s\n",
+                      include ? key_include_functions_str
+                              : key_exclude_functions_str,
+                      path);
+    interflop_exit(42);
+  }
+  vr_functionMode = include ? ctx->rounding_mode : VR_NEAREST;
+  if (include)
+    ctx->rounding_mode = VR_NEAREST;
+  return true;
+}
+
 struct interflop_backend_interface_t INTERFLOP_VERROU_API(init)(void *context) {
   verrou_context_t *ctx = (verrou_context_t *)context;
   _interflop_set_seed(ctx->seed, context);
+  ctx->vector_isa = _verrou_select_vector_isa(ctx->vector_isa);
 
   print_information_header(ctx);
+  const bool filter_functions = _verrou_init_functions(ctx);
 
   struct interflop_backend_interface_t interflop_verrou_backend =
       (ctx->static_backend) ? get_static_backend(ctx)
-                            : _verrou_get_dynamic_backend();
+                            : _verrou_get_dynamic_backend(ctx);
+  _verrou_set_vector_backend(&interflop_verrou_backend, ctx);
+  _verrou_init_regions(ctx);
+  _verrou_init_reduce_kernels(ctx);
+  if (filter_functions) {
+    interflop_verrou_backend.interflop_enter_function =
+        INTERFLOP_VERROU_API(enter_function);
+    interflop_verrou_backend.interflop_exit_function =
+        INTERFLOP_VERROU_API(exit_function);
+  }
+  // the driver of --samples does not return
+  if (ctx->samples > 0)
+    verrou_samples_begin(ctx, ctx->samples);
+#ifdef RNG_THREAD_SAFE
+  // a sample reduces in its own thread, the samples running side by side
+  if (vr_samples.index < 0)
+    vr_reducePool_start(ctx->reduction_threads);
+#endif
 
   return interflop_verrou_backend;
 }
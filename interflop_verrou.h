@@ -33,6 +33,9 @@
 #ifndef __INTERFLOP_VERROU_H
 #define __INTERFLOP_VERROU_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -62,10 +65,116 @@ enum vr_RoundingMode {
   VR_FTZ
 };
 
+/* vector implementations, ordered by width */
+enum vr_VectorIsa {
+  VR_VECTOR_ISA_AUTO,
+  VR_VECTOR_ISA_SCALAR,
+  VR_VECTOR_ISA_SSE,
+  VR_VECTOR_ISA_AVX,
+  VR_VECTOR_ISA_AVX512
+};
+
+/* hashes of the det and comdet rounding modes */
+enum vr_DetHash {
+  VR_DET_HASH_DOUBLE_TABULATION,
+  VR_DET_HASH_TABULATION,
+  VR_DET_HASH_MULTIPLY_SHIFT,
+  VR_DET_HASH_DIETZFELBINGER,
+  VR_DET_HASH_MERSENNE_TWISTER,
+  VR_DET_HASH_MIX64
+};
+
+/* policies of --naninf-check for the NaN and Inf results */
+enum vr_NanInfCheck {
+  VR_NANINF_CHECK_FULL,
+  VR_NANINF_CHECK_HANDLER_ONLY,
+  VR_NANINF_CHECK_OFF
+};
+
+/* counters of --profile-exact */
+enum vr_ProfOp {
+  VR_PROF_ADD,
+  VR_PROF_SUB,
+  VR_PROF_MUL,
+  VR_PROF_DIV,
+  VR_PROF_MADD,
+  VR_PROF_CAST,
+  VR_PROF_NB_OP
+};
+
+enum vr_ProfType { VR_PROF_FLOAT, VR_PROF_DOUBLE, VR_PROF_NB_TYPE };
+
+/* sum over the threads, a vector operation counts for each lane */
+typedef struct {
+  uint64_t numOp[VR_PROF_NB_OP][VR_PROF_NB_TYPE];
+  uint64_t numExactOp[VR_PROF_NB_OP][VR_PROF_NB_TYPE];
+} verrou_profiling_t;
+
+/*
+ * histograms of --profile-error, summed over the threads. error: relative
+ * error |error| / ulp of the result rounded to nearest, bucket 0 for an exact
+ * operation and bucket k for 2^-k <= error < 2^-(k-1), the last one also
+ * holds the smaller errors. exponent: bucket 0 for a zero result and
+ * e - VR_PROF_EXP_BUCKET_MIN for a result in [2^e, 2^(e+1)).
+ */
+#define VR_PROF_NB_ERROR_BUCKET 64
+#define VR_PROF_EXP_BUCKET_MIN (-1075)
+#define VR_PROF_NB_EXP_BUCKET 2099
+typedef struct {
+  uint64_t error[VR_PROF_NB_OP][VR_PROF_NB_TYPE][VR_PROF_NB_ERROR_BUCKET];
+  uint64_t exponent[VR_PROF_NB_OP][VR_PROF_NB_TYPE][VR_PROF_NB_EXP_BUCKET];
+} verrou_error_histograms_t;
+
+/* verrou ids of interflop_user_call, next to the ones of interflop_call_id */
+enum vr_UserCallId {
+  /* no argument */
+  VERROU_PROFILING_RESET_ID = 0x7672,
+  /* verrou_profiling_t *: filled with the current counts */
+  VERROU_PROFILING_GET_ID,
+  /* const char *: report file, .csv or .json; NULL for stderr */
+  VERROU_PROFILING_REPORT_ID,
+  /* verrou_error_histograms_t *: filled with the current histograms */
+  VERROU_ERROR_HISTOGRAMS_GET_ID,
+  /* enum vr_RoundingMode: verrou_push_rounding_mode */
+  VERROU_PUSH_ROUNDING_MODE_ID,
+  /* no argument: verrou_pop_rounding_mode */
+  VERROU_POP_ROUNDING_MODE_ID,
+  /* int: verrou_samples_begin */
+  VERROU_SAMPLES_BEGIN_ID,
+  /* const char *, double: verrou_samples_record */
+  VERROU_SAMPLES_RECORD_ID,
+  /* const double *x, size_t n, double *res: verrou_sum_double */
+  VERROU_SUM_DOUBLE_ID,
+  /* const float *x, size_t n, float *res: verrou_sum_float */
+  VERROU_SUM_FLOAT_ID,
+  /* const double *x, const double *y, size_t n, double *res:
+     verrou_dot_double */
+  VERROU_DOT_DOUBLE_ID,
+  /* const float *x, const float *y, size_t n, float *res: verrou_dot_float */
+  VERROU_DOT_FLOAT_ID,
+  /* const double *x, size_t n, double *res: verrou_nrm2_double */
+  VERROU_NRM2_DOUBLE_ID,
+  /* const float *x, size_t n, float *res: verrou_nrm2_float */
+  VERROU_NRM2_FLOAT_ID
+};
+
 #define VERROU_SEED_DEFAULT 0ULL
 // #define VERROU_ROUDING_MODE_DEFAULT VR_NEAREST
 #define VERROU_ROUDING_MODE_DEFAULT VR_DOWNWARD
 #define VERROU_STATIC_BACKEND_DEFAULT IFalse
+#define VERROU_VECTOR_ISA_DEFAULT VR_VECTOR_ISA_AUTO
+/* a PROFILING_EXACT build profiles by default */
+#ifdef PROFILING_EXACT
+#define VERROU_PROFILE_EXACT_DEFAULT ITrue
+#else
+#define VERROU_PROFILE_EXACT_DEFAULT IFalse
+#endif
+#define VERROU_PROFILE_ERROR_DEFAULT IFalse
+#define VERROU_SAMPLES_DEFAULT 0
+#define VERROU_SAMPLES_JOBS_DEFAULT 0 /* the online CPUs */
+#define VERROU_SAMPLES_TOLERANCE_DEFAULT 0.1
+#define VERROU_REDUCTION_THREADS_DEFAULT 0 /* the online CPUs */
+#define VERROU_NANINF_CHECK_DEFAULT VR_NANINF_CHECK_FULL
 
 typedef struct {
   enum vr_RoundingMode default_rounding_mode;
@@ -73,16 +182,52 @@ typedef struct {
   unsigned int seed;
   IBool choose_seed;
   IBool static_backend;
+  enum vr_VectorIsa vector_isa;
+  enum vr_DetHash det_hash;
+  IBool profile_exact;
+  IBool profile_error;
+  const char *profiling_report;
+  const char *exclude_functions;
+  const char *include_functions;
+  unsigned int samples;
+  unsigned int samples_jobs;
+  double samples_tolerance;
+  unsigned int reduction_threads;
+  enum vr_NanInfCheck naninf_check;
 } verrou_context_t;
 
 typedef verrou_context_t verrou_conf_t;
 
 /* verrou specific functions */
 const char *verrou_rounding_mode_name(enum vr_RoundingMode mode);
+const char *verrou_vector_isa_name(enum vr_VectorIsa isa);
+const char *verrou_det_hash_name(enum vr_DetHash hash);
+const char *verrou_naninf_check_name(enum vr_NanInfCheck check);
 double verrou_prandom_pvalue(void);
 void verrou_begin_instr(void *context);
 void verrou_end_instr(void *context);
+/* rounding mode of the calling thread only, nested up to 64 deep */
+void verrou_push_rounding_mode(enum vr_RoundingMode mode);
+void verrou_pop_rounding_mode(void);
+/* runs the rest of the program in nb_samples (0: --samples) forked
+   processes with consecutive seeds, reports and exits; nothing in a sample
+   or without samples */
+void verrou_samples_begin(void *context, int nb_samples);
+/* value of the sample, reported with the others of the same name */
+void verrou_samples_record(const char *name, double value);
+/* reductions in the rounding mode of the caller, with the same bits for any
+   number of threads in the deterministic modes */
+double verrou_sum_double(const double *x, size_t n, void *context);
+float verrou_sum_float(const float *x, size_t n, void *context);
+double verrou_dot_double(const double *x, const double *y, size_t n,
+                         void *context);
+float verrou_dot_float(const float *x, const float *y, size_t n,
+                       void *context);
+double verrou_nrm2_double(const double *x, size_t n, void *context);
+float verrou_nrm2_float(const float *x, size_t n, void *context);
 void verrou_get_profiling_exact(unsigned int *num, unsigned int *numExact);
+void verrou_get_profiling(verrou_profiling_t *prof);
+void verrou_get_error_histograms(verrou_error_histograms_t *hist);
 void verrou_init_profiling_exact(void);
 void verrou_set_random_seed(void);
 void verrou_set_seed(unsigned int seed);
@@ -113,6 +258,42 @@ void INTERFLOP_VERROU_API(fma_float)(float a, float b, float c, float *res,
                                      void *context);
 void INTERFLOP_VERROU_API(fma_double)(double a, double b, double c, double *res,
                                       void *context);
+/* array versions: res[i] = op(a[i], b[i]) for i in [0, n) */
+void INTERFLOP_VERROU_API(add_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context);
+void INTERFLOP_VERROU_API(add_float_array)(const float *a, const float *b,
+                                           float *res, size_t n, void *context);
+void INTERFLOP_VERROU_API(sub_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context);
+void INTERFLOP_VERROU_API(sub_float_array)(const float *a, const float *b,
+                                           float *res, size_t n, void *context);
+void INTERFLOP_VERROU_API(mul_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context);
+void INTERFLOP_VERROU_API(mul_float_array)(const float *a, const float *b,
+                                           float *res, size_t n, void *context);
+void INTERFLOP_VERROU_API(div_double_array)(const double *a, const double *b,
+                                            double *res, size_t n,
+                                            void *context);
+void INTERFLOP_VERROU_API(div_float_array)(const float *a, const float *b,
+                                           float *res, size_t n, void *context);
+void INTERFLOP_VERROU_API(cast_double_to_float_array)(const double *a,
+                                                      float *b, size_t n,
+                                                      void *context);
+void INTERFLOP_VERROU_API(fma_float_array)(const float *a, const float *b,
+                                           const float *c, float *res,
+                                           size_t n, void *context);
+void INTERFLOP_VERROU_API(fma_double_array)(const double *a, const double *b,
+                                            const double *c, double *res,
+                                            size_t n, void *context);
+void INTERFLOP_VERROU_API(enter_function)(
+    interflop_function_info_t *function_info, void *context, int nb_args,
+    va_list ap);
+void INTERFLOP_VERROU_API(exit_function)(
+    interflop_function_info_t *function_info, void *context, int nb_args,
+    va_list ap);
 void INTERFLOP_VERROU_API(user_call)(void *context, interflop_call_id id,
                                      va_list ap);
 void INTERFLOP_VERROU_API(finalize)(void *context);
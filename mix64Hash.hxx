@@ -0,0 +1,79 @@
+#pragma once
+
+#include "interflop/prng/vr_rand.h"
+#include "vr_op.hxx"
+
+/*
+ * Keyed 64-bit mixer, in the spirit of the xxh3/wyhash finalizers, but only
+ * built on 64-bit low products, xors and shifts so that it vectorizes:
+ *  - the key mixes the seed of the thread with hashOp
+ *  - each argument, zero-extended to 64 bits, is absorbed with
+ *    h = xorshift32((h ^ arg) * P1), a bijection for a fixed h
+ *  - the murmur3 fmix64 finalizer gives the avalanche
+ * About 2 + NB multiplications, with no table and no per-call state, where
+ * vr_mersenne_twister_hash seeds a tinymt64 on every operation.
+ */
+class vr_mix64_hash {
+public:
+  static constexpr uint64_t P0 = 0x9e3779b97f4a7c15ULL;
+  static constexpr uint64_t P1 = 0xc2b2ae3d27d4eb4fULL;
+  static constexpr uint64_t P2 = 0x165667b19e3779f9ULL;
+  static constexpr uint64_t F1 = 0xff51afd7ed558ccdULL;
+  static constexpr uint64_t F2 = 0xc4ceb9fe1a85ec53ULL;
+
+  template <class REALTYPE, int NB>
+  static inline bool hashBool(const Vr_Rand *r,
+                              const vr_packArg<REALTYPE, NB> &pack,
+                              uint32_t hashOp) {
+    return vr_mix64_hash::hash(r, pack, hashOp) >> 63;
+  }
+
+  template <class REALTYPE, int NB>
+  static inline double hashRatio(const Vr_Rand *r,
+                                 const vr_packArg<REALTYPE, NB> &pack,
+                                 uint32_t hashOp) {
+    const uint32_t v = vr_mix64_hash::hash(r, pack, hashOp) >> 32;
+    constexpr double invMax = (1. / 4294967296.); // 2**32 = 4294967296
+    return ((double)v * invMax);
+  }
+
+  template <class REALTYPE, int NB>
+  static inline uint64_t hash(const Vr_Rand *r,
+                              const vr_packArg<REALTYPE, NB> &pack,
+                              uint32_t hashOp) {
+    uint64_t h = key(vr_rand_getSeed(r), hashOp);
+    h = absorb(h, bits(pack.arg1));
+    if constexpr (NB > 1) {
+      h = absorb(h, bits(pack.arg2));
+    }
+    if constexpr (NB > 2) {
+      h = absorb(h, bits(pack.arg3));
+    }
+    return fmix(h);
+  }
+
+  static inline uint64_t key(uint64_t seed, uint32_t hashOp) {
+    return (seed ^ (hashOp * P2)) * P0;
+  }
+
+  static inline uint64_t absorb(uint64_t h, uint64_t arg) {
+    h = (h ^ arg) * P1;
+    return h ^ (h >> 32);
+  }
+
+  static inline uint64_t fmix(uint64_t h) {
+    h ^= h >> 33;
+    h *= F1;
+    h ^= h >> 33;
+    h *= F2;
+    return h ^ (h >> 33);
+  }
+
+private:
+  static inline uint64_t bits(double a) {
+    return realToUint64_reinterpret_cast<double>(a);
+  }
+  static inline uint64_t bits(float a) {
+    return realToUint32_reinterpret_cast(a);
+  }
+};
@@ -1,43 +1,50 @@
 #pragma once
 
 #include "interflop/prng/vr_rand.h"
+#include "vr_hashTables.hxx"
 #include "vr_op.hxx"
 
-
-static uint64_t seedTab[8];
-
 class vr_multiply_shift_hash {
 public:
   template <class REALTYPE, int NB>
-  static inline bool hashBool(const Vr_Rand *r,
+  static inline bool hashBool(__attribute__((unused)) const Vr_Rand *r,
                               const vr_packArg<REALTYPE, NB> &pack,
                               uint32_t hashOp) {
-    const uint64_t m = vr_multiply_shift_hash::multiply(pack, hashOp);
+    const uint64_t *seedTab =
+        vr_hashTables_get<VR_HASH_TABLES_MULTIPLY_SHIFT>().seedTab;
+    const uint64_t m =
+        vr_multiply_shift_hash::multiply(seedTab, pack, hashOp);
     return (m + seedTab[7]) >> 63;
   }
 
   template <class REALTYPE, int NB>
-  static inline double hashRatio(const Vr_Rand *r,
+  static inline double hashRatio(__attribute__((unused)) const Vr_Rand *r,
                                  const vr_packArg<REALTYPE, NB> &pack,
                                  uint32_t hashOp) {
-    const uint64_t m = vr_multiply_shift_hash::multiply(pack, hashOp);
+    const uint64_t *seedTab =
+        vr_hashTables_get<VR_HASH_TABLES_MULTIPLY_SHIFT>().seedTab;
+    const uint64_t m =
+        vr_multiply_shift_hash::multiply(seedTab, pack, hashOp);
     const uint32_t v = (m + seedTab[7]) >> 32;
     constexpr double invMax = (1. / 4294967296.); // 2**32 = 4294967296
     return ((double)v * invMax);
   }
 
-  static inline uint64_t multiply(const vr_packArg<float, 1> &pack,
+  static inline uint64_t multiply(const uint64_t *seedTab,
+                                  const vr_packArg<float, 1> &pack,
                                   uint32_t hashOp) {
     const uint32_t a1 = realToUint32_reinterpret_cast(pack.arg1);
     return (a1 + seedTab[0]) * (hashOp + seedTab[6]);
   }
-  static inline uint64_t multiply(const vr_packArg<float, 2> &pack,
+  static inline uint64_t multiply(const uint64_t *seedTab,
+                                  const vr_packArg<float, 2> &pack,
                                   uint32_t hashOp) {
     const uint32_t a1 = realToUint32_reinterpret_cast(pack.arg1);
     const uint32_t a2 = realToUint32_reinterpret_cast(pack.arg2);
     return (a1 + seedTab[0]) * (a2 + seedTab[1]) + (hashOp * seedTab[6]);
   }
-  static inline uint64_t multiply(const vr_packArg<float, 3> &pack,
+  static inline uint64_t multiply(const uint64_t *seedTab,
+                                  const vr_packArg<float, 3> &pack,
                                   uint32_t hashOp) {
     const uint32_t a1 = realToUint32_reinterpret_cast(pack.arg1);
     const uint32_t a2 = realToUint32_reinterpret_cast(pack.arg2);
@@ -46,7 +53,8 @@ public:
            (a3 + seedTab[2]) * (hashOp + seedTab[6]);
   }
 
-  static inline uint64_t multiply(const vr_packArg<double, 1> &pack,
+  static inline uint64_t multiply(const uint64_t *seedTab,
+                                  const vr_packArg<double, 1> &pack,
                                   uint32_t hashOp) {
     const uint64_t a1 = realToUint64_reinterpret_cast<double>(pack.arg1);
     const uint32_t a1_1 = a1;
@@ -54,7 +62,8 @@ public:
     return (a1_1 + seedTab[0]) * (a1_2 + seedTab[1]) + (hashOp * seedTab[6]);
   }
 
-  static inline uint64_t multiply(const vr_packArg<double, 2> &pack,
+  static inline uint64_t multiply(const uint64_t *seedTab,
+                                  const vr_packArg<double, 2> &pack,
                                   uint32_t hashOp) {
     const uint64_t a1 = realToUint64_reinterpret_cast<double>(pack.arg1);
     const uint32_t a1_1 = a1;
@@ -68,7 +77,8 @@ public:
            (a2_1 + seedTab[2]) * (a2_2 + seedTab[3]) + (hashOp * seedTab[6]);
   }
 
-  static inline uint64_t multiply(const vr_packArg<double, 3> &pack,
+  static inline uint64_t multiply(const uint64_t *seedTab,
+                                  const vr_packArg<double, 3> &pack,
                                   uint32_t hashOp) {
     uint64_t a1 = realToUint64_reinterpret_cast<double>(pack.arg1);
     uint32_t a1_1 = a1;
@@ -87,9 +97,10 @@ public:
            (a3_1 + seedTab[4]) * (a3_2 + seedTab[5]) + (hashOp * seedTab[6]);
   }
 
-  static inline void genTable(tinymt64_t &gen) {
+  // draws from 2^32 of key, disjoint from the ones of vr_tabulation_hash
+  static inline void genTable(uint64_t key, Vr_HashTables &t) {
     for (int i = 0; i < 8; i++) {
-      seedTab[i] = tinymt64_generate_uint64(&gen);
+      t.seedTab[i] = vr_hashTables_draw(key, (1ULL << 32) + i);
     }
   };
 };
@@ -5,8 +5,10 @@
 
 template <typename> class Void {};
 
-template <template <typename O, typename R> typename RoundingMode,
-          template <typename T> typename RAND = Void>
+template <template <typename O, typename R, typename P, typename N>
+          typename RoundingMode,
+          template <typename T> typename RAND = Void, class PROF = vr_noProf,
+          class NANINF = vr_naninfFull>
 class StaticRounding {
   using AD = AddOp<double>;
   using AF = AddOp<float>;
@@ -21,70 +23,71 @@ class StaticRounding {
   using FF = MAddOp<float>;
 
 public:
-  static void add_double(double a, double b, double *res,
-                         [[maybe_unused]] void *context) {
-    // typedef typename RoundingMode<AD, RAND<AD>> Op;
-    using Op = RoundingMode<AD, RAND<AD>>;
+  static void add_double(double a, double b, double *res, void *context) {
+    VR_REGION_STATIC(add_double, a, b, res, context);
+    // typedef typename RoundingMode<AD, RAND<AD>, PROF> Op;
+    using Op = RoundingMode<AD, RAND<AD>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void add_float(float a, float b, float *res,
-                        [[maybe_unused]] void *context) {
-    using Op = RoundingMode<AF, RAND<AF>>;
+  static void add_float(float a, float b, float *res, void *context) {
+    VR_REGION_STATIC(add_float, a, b, res, context);
+    using Op = RoundingMode<AF, RAND<AF>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void sub_double(double a, double b, double *res,
-                         [[maybe_unused]] void *context) {
-    using Op = RoundingMode<SD, RAND<SD>>;
+  static void sub_double(double a, double b, double *res, void *context) {
+    VR_REGION_STATIC(sub_double, a, b, res, context);
+    using Op = RoundingMode<SD, RAND<SD>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void sub_float(float a, float b, float *res,
-                        [[maybe_unused]] void *context) {
-    using Op = RoundingMode<SF, RAND<SF>>;
+  static void sub_float(float a, float b, float *res, void *context) {
+    VR_REGION_STATIC(sub_float, a, b, res, context);
+    using Op = RoundingMode<SF, RAND<SF>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void mul_double(double a, double b, double *res,
-                         [[maybe_unused]] void *context) {
-    using Op = RoundingMode<MD, RAND<MD>>;
+  static void mul_double(double a, double b, double *res, void *context) {
+    VR_REGION_STATIC(mul_double, a, b, res, context);
+    using Op = RoundingMode<MD, RAND<MD>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void mul_float(float a, float b, float *res,
-                        [[maybe_unused]] void *context) {
-    using Op = RoundingMode<MF, RAND<MF>>;
+  static void mul_float(float a, float b, float *res, void *context) {
+    VR_REGION_STATIC(mul_float, a, b, res, context);
+    using Op = RoundingMode<MF, RAND<MF>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void div_double(double a, double b, double *res,
-                         [[maybe_unused]] void *context) {
-    using Op = RoundingMode<DD, RAND<DD>>;
+  static void div_double(double a, double b, double *res, void *context) {
+    VR_REGION_STATIC(div_double, a, b, res, context);
+    using Op = RoundingMode<DD, RAND<DD>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void div_float(float a, float b, float *res,
-                        [[maybe_unused]] void *context) {
-    using Op = RoundingMode<DF, RAND<DF>>;
+  static void div_float(float a, float b, float *res, void *context) {
+    VR_REGION_STATIC(div_float, a, b, res, context);
+    using Op = RoundingMode<DF, RAND<DF>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b));
   }
 
-  static void cast_double_to_float(double a, float *res,
-                                   [[maybe_unused]] void *context) {
-    using Op = RoundingMode<CDF, RAND<CDF>>;
+  static void cast_double_to_float(double a, float *res, void *context) {
+    VR_REGION_STATIC(cast_double_to_float, a, res, context);
+    using Op = RoundingMode<CDF, RAND<CDF>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a));
   }
 
   static void fma_double(double a, double b, double c, double *res,
-                         [[maybe_unused]] void *context) {
-    using Op = RoundingMode<FD, RAND<FD>>;
+                         void *context) {
+    VR_REGION_STATIC(fma_double, a, b, c, res, context);
+    using Op = RoundingMode<FD, RAND<FD>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b, c));
   }
 
-  static void fma_float(float a, float b, float c, float *res,
-                        [[maybe_unused]] void *context) {
-    using Op = RoundingMode<FF, RAND<FF>>;
+  static void fma_float(float a, float b, float c, float *res, void *context) {
+    VR_REGION_STATIC(fma_float, a, b, c, res, context);
+    using Op = RoundingMode<FF, RAND<FF>, PROF, NANINF>;
     *res = Op::apply(typename Op::PackArgs(a, b, c));
   }
 
@@ -106,7 +109,8 @@ public:
       interflop_enter_function : NULL,
       interflop_exit_function : NULL,
       interflop_user_call : INTERFLOP_VERROU_API(user_call),
-      interflop_finalize : INTERFLOP_VERROU_API(finalize)
+      interflop_finalize : INTERFLOP_VERROU_API(finalize),
+      vbackend : {} // set by _verrou_set_vector_backend
     };
   }
 };
@@ -128,48 +132,191 @@ interflop_backend_interface_t dynamic_backend = {
   interflop_enter_function : NULL,
   interflop_exit_function : NULL,
   interflop_user_call : INTERFLOP_VERROU_API(user_call),
-  interflop_finalize : INTERFLOP_VERROU_API(finalize)
+  interflop_finalize : INTERFLOP_VERROU_API(finalize),
+  vbackend : {} // set by _verrou_set_vector_backend
 };
 
-static struct interflop_backend_interface_t
-get_static_backend(verrou_context_t *ctx) {
-  switch (ctx->rounding_mode) {
-  case VR_NEAREST:
-    return StaticRounding<RoundingNearest>::get_backend();
-  case VR_UPWARD:
-    return StaticRounding<RoundingUpward>::get_backend();
-  case VR_DOWNWARD:
-    return StaticRounding<RoundingDownward>::get_backend();
-  case VR_ZERO:
-    return StaticRounding<RoundingZero>::get_backend();
-  case VR_RANDOM:
-    return StaticRounding<RoundingRandom, vr_rand_prng>::get_backend();
-  case VR_RANDOM_DET:
-    return StaticRounding<RoundingRandom, vr_rand_det>::get_backend();
-  case VR_RANDOM_COMDET:
-    return StaticRounding<RoundingRandom, vr_rand_comdet>::get_backend();
-  case VR_AVERAGE:
-    return StaticRounding<RoundingAverage, vr_rand_prng>::get_backend();
-  case VR_AVERAGE_DET:
-    return StaticRounding<RoundingAverage, vr_rand_det>::get_backend();
-  case VR_AVERAGE_COMDET:
-    return StaticRounding<RoundingAverage, vr_rand_comdet>::get_backend();
-  case VR_PRANDOM:
-    return StaticRounding<RoundingPRandom, vr_rand_prng>::get_backend();
-  case VR_PRANDOM_DET:
-    return StaticRounding<RoundingPRandom, vr_rand_det>::get_backend();
-  case VR_PRANDOM_COMDET:
-    return StaticRounding<RoundingPRandom, vr_rand_comdet>::get_backend();
-  case VR_FARTHEST:
-    return StaticRounding<RoundingFarthest>::get_backend();
-  case VR_FLOAT:
-    return StaticRounding<RoundingFloat>::get_backend();
-  case VR_NATIVE:
-    return StaticRounding<RoundingNearest>::get_backend();
-  case VR_FTZ:
-    interflop_panic("FTZ not implemented in backend_verrou");
-    return {};
-  default:
+/* the entry points of dynamic_backend, with the policies PROF and NANINF */
+template <class PROF, class NANINF> class DynamicRounding {
+  template <class OP> using Op = OpWithSelectedRoundingMode<OP, PROF, NANINF>;
+
+public:
+  static void add_double(double a, double b, double *res, void *context) {
+    Op<AddOp<double>>::apply(AddOp<double>::PackArgs(a, b), res, context);
+  }
+
+  static void add_float(float a, float b, float *res, void *context) {
+    Op<AddOp<float>>::apply(AddOp<float>::PackArgs(a, b), res, context);
+  }
+
+  static void sub_double(double a, double b, double *res, void *context) {
+    Op<SubOp<double>>::apply(SubOp<double>::PackArgs(a, b), res, context);
+  }
+
+  static void sub_float(float a, float b, float *res, void *context) {
+    Op<SubOp<float>>::apply(SubOp<float>::PackArgs(a, b), res, context);
+  }
+
+  static void mul_double(double a, double b, double *res, void *context) {
+    Op<MulOp<double>>::apply(MulOp<double>::PackArgs(a, b), res, context);
+  }
+
+  static void mul_float(float a, float b, float *res, void *context) {
+    Op<MulOp<float>>::apply(MulOp<float>::PackArgs(a, b), res, context);
+  }
+
+  static void div_double(double a, double b, double *res, void *context) {
+    Op<DivOp<double>>::apply(DivOp<double>::PackArgs(a, b), res, context);
+  }
+
+  static void div_float(float a, float b, float *res, void *context) {
+    Op<DivOp<float>>::apply(DivOp<float>::PackArgs(a, b), res, context);
+  }
+
+  static void cast_double_to_float(double a, float *res, void *context) {
+    typedef CastOp<double, float> CDF;
+    Op<CDF>::apply(CDF::PackArgs(a), res, context);
+  }
+
+  static void fma_double(double a, double b, double c, double *res,
+                         void *context) {
+    Op<MAddOp<double>>::apply(MAddOp<double>::PackArgs(a, b, c), res,
+                              context);
+  }
+
+  static void fma_float(float a, float b, float c, float *res, void *context) {
+    Op<MAddOp<float>>::apply(MAddOp<float>::PackArgs(a, b, c), res, context);
+  }
+
+  static struct interflop_backend_interface_t get_backend(void) {
+    return {
+      interflop_add_float : add_float,
+      interflop_sub_float : sub_float,
+      interflop_mul_float : mul_float,
+      interflop_div_float : div_float,
+      interflop_cmp_float : NULL,
+      interflop_add_double : add_double,
+      interflop_sub_double : sub_double,
+      interflop_mul_double : mul_double,
+      interflop_div_double : div_double,
+      interflop_cmp_double : NULL,
+      interflop_cast_double_to_float : cast_double_to_float,
+      interflop_fma_float : fma_float,
+      interflop_fma_double : fma_double,
+      interflop_enter_function : NULL,
+      interflop_exit_function : NULL,
+      interflop_user_call : INTERFLOP_VERROU_API(user_call),
+      interflop_finalize : INTERFLOP_VERROU_API(finalize),
+      vbackend : {} // set by _verrou_set_vector_backend
+    };
+  }
+};
+
+/* the entry points of the default policies are the exported ones */
+template <class PROF, class NANINF>
+static struct interflop_backend_interface_t get_dynamic_scalar_backend(void) {
+  if constexpr (std::is_same<PROF, vr_noProf>::value &&
+                std::is_same<NANINF, vr_naninfFull>::value) {
     return dynamic_backend;
+  } else {
+    return DynamicRounding<PROF, NANINF>::get_backend();
   }
-}
\ No newline at end of file
+}
+
+/* det and comdet modes with the hash HASH, F of vr_detHashDispatch */
+template <class HASH> struct StaticDetRounding {
+  typedef vr_rand_hash<HASH> H;
+
+  // PROF and NANINF are deduced from their tag arguments
+  template <class PROF, class NANINF>
+  static struct interflop_backend_interface_t apply(verrou_context_t *ctx,
+                                                    PROF, NANINF) {
+    switch (ctx->rounding_mode) {
+    case VR_RANDOM_DET:
+      return StaticRounding<RoundingRandom, H::template det,
+                            PROF, NANINF>::get_backend();
+    case VR_RANDOM_COMDET:
+      return StaticRounding<RoundingRandom, H::template comdet,
+                            PROF, NANINF>::get_backend();
+    case VR_AVERAGE_DET:
+      return StaticRounding<RoundingAverage, H::template det,
+                            PROF, NANINF>::get_backend();
+    case VR_AVERAGE_COMDET:
+      return StaticRounding<RoundingAverage, H::template comdet,
+                            PROF, NANINF>::get_backend();
+    case VR_PRANDOM_DET:
+      return StaticRounding<RoundingPRandom,
+                            vr_rand_pOf<H::template det>::template type,
+                            PROF, NANINF>::get_backend();
+    case VR_PRANDOM_COMDET:
+      return StaticRounding<RoundingPRandom,
+                            vr_rand_pOf<H::template comdet>::template type,
+                            PROF, NANINF>::get_backend();
+    default:
+      return get_dynamic_scalar_backend<PROF, NANINF>();
+    }
+  }
+};
+
+/* the backend of the rounding mode of ctx, F of vr_naninfDispatch */
+template <class NANINF> struct StaticBackend {
+  template <template <typename O, typename R, typename P, typename N>
+            typename RoundingMode,
+            template <typename T> typename RAND, class PROF>
+  using Static = StaticRounding<RoundingMode, RAND, PROF, NANINF>;
+
+  // PROF is deduced from its tag argument
+  template <class PROF>
+  static struct interflop_backend_interface_t apply(verrou_context_t *ctx,
+                                                    PROF) {
+    switch (ctx->rounding_mode) {
+    case VR_NEAREST:
+      return Static<RoundingNearest, Void, PROF>::get_backend();
+    case VR_UPWARD:
+      return Static<RoundingUpward, Void, PROF>::get_backend();
+    case VR_DOWNWARD:
+      return Static<RoundingDownward, Void, PROF>::get_backend();
+    case VR_ZERO:
+      return Static<RoundingZero, Void, PROF>::get_backend();
+    case VR_RANDOM:
+      return Static<RoundingRandom, vr_rand_prng, PROF>::get_backend();
+    case VR_AVERAGE:
+      return Static<RoundingAverage, vr_rand_prng, PROF>::get_backend();
+    case VR_PRANDOM:
+      return Static<RoundingPRandom, vr_rand_pOf<vr_rand_prng>::type,
+                    PROF>::get_backend();
+    case VR_RANDOM_DET:
+    case VR_RANDOM_COMDET:
+    case VR_AVERAGE_DET:
+    case VR_AVERAGE_COMDET:
+    case VR_PRANDOM_DET:
+    case VR_PRANDOM_COMDET:
+      return vr_detHashDispatch<StaticDetRounding>(ctx->det_hash, ctx, PROF(),
+                                                   NANINF());
+    case VR_FARTHEST:
+      return Static<RoundingFarthest, Void, PROF>::get_backend();
+    case VR_FLOAT:
+      return Static<RoundingFloat, Void, PROF>::get_backend();
+    case VR_NATIVE:
+      return Static<RoundingNearest, Void, PROF>::get_backend();
+    case VR_FTZ:
+      interflop_panic("FTZ not implemented in backend_verrou");
+      return {};
+    default:
+      return get_dynamic_scalar_backend<PROF, NANINF>();
+    }
+  }
+};
+
+/* the policies are selected once, at initialization */
+static struct interflop_backend_interface_t
+get_static_backend(verrou_context_t *ctx) {
+  if (ctx->profile_error)
+    return vr_naninfDispatch<StaticBackend>(ctx->naninf_check, ctx,
+                                            vr_profError());
+  if (ctx->profile_exact)
+    return vr_naninfDispatch<StaticBackend>(ctx->naninf_check, ctx,
+                                            vr_profExact());
+  return vr_naninfDispatch<StaticBackend>(ctx->naninf_check, ctx,
+                                          vr_noProf());
+}
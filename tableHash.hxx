@@ -1,7 +1,6 @@
 #pragma once
 
-static uint32_t hashTable[4][8][256];
-static uint32_t hashTableOp[2][256];
+#include "vr_hashTables.hxx"
 
 // static uint64_t hashTwistedTable[3][8][256];
 // static uint64_t hashTwistedTableOp[2][256];
@@ -27,117 +26,128 @@ public:
 
   static inline uint32_t hash(const vr_packArg<double, 1> &pack,
                               uint32_t hashOp) {
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
     uint32_t res = 0;
-    vr_tabulation_hash::hash_op(res, (uint16_t)hashOp);
+    vr_tabulation_hash::hash_op(t, res, (uint16_t)hashOp);
     uint64_t a1 = realToUint64_reinterpret_cast<double>(pack.arg1);
-    vr_tabulation_hash::hash_aux(res, 0, a1);
+    vr_tabulation_hash::hash_aux(t, res, 0, a1);
     return res;
   }
 
   static inline uint32_t hash(const vr_packArg<float, 1> &pack,
                               uint32_t hashOp) {
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
     uint32_t res = 0;
-    vr_tabulation_hash::hash_op(res, (uint16_t)hashOp);
+    vr_tabulation_hash::hash_op(t, res, (uint16_t)hashOp);
     uint32_t a1 = realToUint32_reinterpret_cast(pack.arg1);
-    vr_tabulation_hash::hash_aux(res, 0, a1);
+    vr_tabulation_hash::hash_aux(t, res, 0, a1);
     return res;
   }
 
   static inline uint32_t hash(const vr_packArg<double, 2> &pack,
                               uint32_t hashOp) {
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
     uint32_t res = 0;
-    vr_tabulation_hash::hash_op(res, (uint16_t)hashOp);
+    vr_tabulation_hash::hash_op(t, res, (uint16_t)hashOp);
     uint64_t a1 = realToUint64_reinterpret_cast<double>(pack.arg1);
     uint64_t a2 = realToUint64_reinterpret_cast<double>(pack.arg2);
-    vr_tabulation_hash::hash_aux(res, 0, a1);
-    vr_tabulation_hash::hash_aux(res, 1, a2);
+    vr_tabulation_hash::hash_aux(t, res, 0, a1);
+    vr_tabulation_hash::hash_aux(t, res, 1, a2);
     return res;
   }
 
   static inline uint32_t hash(const vr_packArg<float, 2> &pack,
                               uint32_t hashOp) {
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
     uint32_t res = 0;
-    vr_tabulation_hash::hash_op(res, (uint16_t)hashOp);
+    vr_tabulation_hash::hash_op(t, res, (uint16_t)hashOp);
     uint32_t a1 = realToUint32_reinterpret_cast(pack.arg1);
     uint32_t a2 = realToUint32_reinterpret_cast(pack.arg2);
-    vr_tabulation_hash::hash_aux(res, 0, a1);
-    vr_tabulation_hash::hash_aux(res, 1, a2);
+    vr_tabulation_hash::hash_aux(t, res, 0, a1);
+    vr_tabulation_hash::hash_aux(t, res, 1, a2);
     return res;
   }
 
   static inline uint32_t hash(const vr_packArg<double, 3> &pack,
                               uint32_t hashOp) {
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
     uint32_t res = 0;
-    vr_tabulation_hash::hash_op(res, (uint16_t)hashOp);
+    vr_tabulation_hash::hash_op(t, res, (uint16_t)hashOp);
     uint64_t a1 = realToUint64_reinterpret_cast<double>(pack.arg1);
     uint64_t a2 = realToUint64_reinterpret_cast<double>(pack.arg2);
     uint64_t a3 = realToUint64_reinterpret_cast<double>(pack.arg3);
-    vr_tabulation_hash::hash_aux(res, 0, a1);
-    vr_tabulation_hash::hash_aux(res, 1, a2);
-    vr_tabulation_hash::hash_aux(res, 2, a3);
+    vr_tabulation_hash::hash_aux(t, res, 0, a1);
+    vr_tabulation_hash::hash_aux(t, res, 1, a2);
+    vr_tabulation_hash::hash_aux(t, res, 2, a3);
     return res;
   }
 
   static inline uint32_t hash(const vr_packArg<float, 3> &pack,
                               uint32_t hashOp) {
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
     uint32_t res = 0;
-    vr_tabulation_hash::hash_op(res, (uint16_t)hashOp);
+    vr_tabulation_hash::hash_op(t, res, (uint16_t)hashOp);
     uint32_t a1 = realToUint32_reinterpret_cast(pack.arg1);
     uint32_t a2 = realToUint32_reinterpret_cast(pack.arg2);
     uint32_t a3 = realToUint32_reinterpret_cast(pack.arg3);
-    vr_tabulation_hash::hash_aux(res, 0, a1);
-    vr_tabulation_hash::hash_aux(res, 1, a2);
-    vr_tabulation_hash::hash_aux(res, 2, a3);
+    vr_tabulation_hash::hash_aux(t, res, 0, a1);
+    vr_tabulation_hash::hash_aux(t, res, 1, a2);
+    vr_tabulation_hash::hash_aux(t, res, 2, a3);
     return res;
   }
 
-  static inline void hash_op(uint32_t &h, uint16_t optEnum) {
+  static inline void hash_op(const Vr_HashTables &t, uint32_t &h,
+                             uint16_t optEnum) {
     uint32_t x(optEnum);
     uint32_t i;
     uint8_t c;
     for (i = 0; i < 2; i++) {
       c = x;
-      h ^= hashTableOp[i][c];
+      h ^= t.hashTableOp[i][c];
       x = x >> 8;
     }
   }
-  static inline void hash_aux(uint32_t &h, uint32_t index, uint64_t value) {
+  static inline void hash_aux(const Vr_HashTables &t, uint32_t &h,
+                              uint32_t index, uint64_t value) {
     uint64_t x(value);
     uint32_t i;
     uint8_t c;
     for (i = 0; i < 8; i++) {
       c = x;
-      h ^= hashTable[index][i][c];
+      h ^= t.hashTable[index][i][c];
       x = x >> 8;
     }
   }
 
-  static inline void hash_aux(uint32_t &h, uint32_t index, uint32_t value) {
+  static inline void hash_aux(const Vr_HashTables &t, uint32_t &h,
+                              uint32_t index, uint32_t value) {
     uint32_t x(value);
     uint32_t i;
     uint8_t c;
     for (i = 0; i < 4; i++) {
       c = x;
-      h ^= hashTable[index][i][c];
+      h ^= t.hashTable[index][i][c];
       x = x >> 8;
     }
   }
 
-  static inline void genTable(tinymt64_t &gen) {
-    for (int i = 0; i < 4; i++) {
-      for (int j = 0; j < 8; j++) {
-        for (int k = 0; k < 256 / 2; k++) {
-          uint64_t current = tinymt64_generate_uint64(&gen);
-          hashTable[i][j][2 * k] = current;
-          hashTable[i][j][2 * k + 1] = current >> 32;
+  // draws 0 to 4351 of key
+  static inline void genTable(uint64_t key, Vr_HashTables &t) {
+    uint64_t i = 0;
+    for (int j = 0; j < 4; j++) {
+      for (int k = 0; k < 8; k++) {
+        for (int l = 0; l < 256 / 2; l++) {
+          const uint64_t current = vr_hashTables_draw(key, i++);
+          t.hashTable[j][k][2 * l] = current;
+          t.hashTable[j][k][2 * l + 1] = current >> 32;
         }
       }
     }
-    for (int j = 0; j < 2; j++) {
-      for (int k = 0; k < 256 / 2; k++) {
-        uint64_t current = tinymt64_generate_uint64(&gen);
-        hashTableOp[j][2 * k] = current;
-        hashTableOp[j][2 * k + 1] = current >> 32;
+    for (int k = 0; k < 2; k++) {
+      for (int l = 0; l < 256 / 2; l++) {
+        const uint64_t current = vr_hashTables_draw(key, i++);
+        t.hashTableOp[k][2 * l] = current;
+        t.hashTableOp[k][2 * l + 1] = current >> 32;
       }
     }
   };
@@ -302,7 +312,8 @@ public:
                               uint32_t hashOp) {
     const uint32_t tmp = vr_tabulation_hash::hash(pack, hashOp);
     uint32_t res = 0;
-    vr_tabulation_hash::hash_aux(res, 3, tmp);
+    vr_tabulation_hash::hash_aux(
+        vr_hashTables_get<VR_HASH_TABLES_TABULATION>(), res, 3, tmp);
     return res & 1;
   }
 
@@ -312,7 +323,8 @@ public:
                                  uint32_t hashOp) {
     const uint32_t tmp = vr_tabulation_hash::hash(pack, hashOp);
     uint32_t res = 0;
-    vr_tabulation_hash::hash_aux(res, 3, tmp);
+    vr_tabulation_hash::hash_aux(
+        vr_hashTables_get<VR_HASH_TABLES_TABULATION>(), res, 3, tmp);
     constexpr double invMax = (1. / 4294967296.); // 2**32 = 4294967296
     return ((double)res * invMax);
   }
@@ -0,0 +1,114 @@
+/*
+ * Helpers of the regression tests of the verrou backend, which link it
+ * directly: the stdlib handlers otherwise set by the interflop loader, a
+ * context configured for one rounding mode, the vector instruction sets the
+ * CPU runs and random operands spread over the whole exponent range.
+ */
+
+#ifndef __VERROU_TEST_H
+#define __VERROU_TEST_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "interflop_verrou.h"
+
+// * Stdlib handlers
+
+static void test_panic(const char *msg) {
+  fprintf(stderr, "verrou_test: %s\n", msg);
+  exit(1);
+}
+
+static pid_t test_gettid(void) { return syscall(SYS_gettid); }
+
+static void test_naninf_handler(void) {}
+
+static long test_strtol(const char *nptr, char **endptr, int *error) {
+  *error = 0;
+  return strtol(nptr, endptr, 10);
+}
+
+// * Context
+
+static void *test_context;
+
+static void test_init(void) {
+  setenv("VFC_BACKENDS_SILENT_LOAD", "True", 1);
+  interflop_set_handler("exit", (void *)exit);
+  interflop_set_handler("fprintf", (void *)fprintf);
+  interflop_set_handler("getenv", (void *)getenv);
+  interflop_set_handler("gettid", (void *)test_gettid);
+  interflop_set_handler("gettimeofday", (void *)gettimeofday);
+  interflop_set_handler("infHandler", (void *)test_naninf_handler);
+  interflop_set_handler("malloc", (void *)malloc);
+  interflop_set_handler("nanHandler", (void *)test_naninf_handler);
+  interflop_set_handler("panic", (void *)test_panic);
+  interflop_set_handler("strcasecmp", (void *)strcasecmp);
+  interflop_set_handler("strtol", (void *)test_strtol);
+  interflop_verrou_pre_init(test_panic, (File *)stderr, &test_context);
+}
+
+/* the other options keep their zero default */
+static verrou_conf_t test_conf(enum vr_RoundingMode mode) {
+  verrou_conf_t conf;
+  memset(&conf, 0, sizeof(conf));
+  conf.default_rounding_mode = mode;
+  conf.rounding_mode = mode;
+  conf.seed = 42;
+  conf.choose_seed = ITrue;
+  return conf;
+}
+
+static void test_configure(verrou_conf_t conf) {
+  interflop_verrou_configure(&conf, test_context);
+  interflop_verrou_init(test_context);
+}
+
+static void test_configure(enum vr_RoundingMode mode) {
+  test_configure(test_conf(mode));
+}
+
+// * Instruction sets, with the flags their objects are built with
+
+enum { TEST_SCALAR, TEST_SSE, TEST_AVX, TEST_AVX512, TEST_NB_ISA };
+
+static const char *test_isa_name[TEST_NB_ISA] = {"scalar", "sse", "avx",
+                                                 "avx512"};
+
+static bool test_isa_supported(int isa) {
+  __builtin_cpu_init();
+  switch (isa) {
+  case TEST_SSE:
+    return __builtin_cpu_supports("sse4.2");
+  case TEST_AVX:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case TEST_AVX512:
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma");
+  default:
+    return true;
+  }
+}
+
+// * Operands and results
+
+/* a random sign, a random mantissa and an exponent in [emin, emax]: below
+   the normal range of T the value is subnormal or zero */
+template <class T> static T test_random(int emin, int emax) {
+  const double m = (1 + drand48()) * (lrand48() % 2 ? 1 : -1);
+  return (T)ldexp(m, emin + (int)(lrand48() % (emax - emin + 1)));
+}
+
+/* the same bits, or both NaN */
+template <class T> static bool test_same(T x, T y) {
+  return (isnan(x) && isnan(y)) || memcmp(&x, &y, sizeof(T)) == 0;
+}
+
+#endif /* __VERROU_TEST_H */
@@ -0,0 +1,191 @@
+/*
+ * Regression test of fma: in the directed rounding modes every lane of the
+ * fma entry points, for every vector size of every instruction set the CPU
+ * runs, and the scalar entry point must have the bits of fmaf and fma
+ * computed in the same rounding mode of the FPU.
+ *
+ * The float operands cover the whole exponent range, with products near
+ * the subnormal range whose error is not a float. The double products stay
+ * in the normal range, where the error of a double fma is a double.
+ */
+
+#include <fenv.h>
+
+#include "verrou_test.h"
+
+#include "interflop_vector_verrou_scalar.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_sse.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_avx.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_avx512.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+
+static const struct {
+  enum vr_RoundingMode mode;
+  int fenv;
+} test_modes[] = {{VR_NEAREST, FE_TONEAREST},
+                  {VR_UPWARD, FE_UPWARD},
+                  {VR_DOWNWARD, FE_DOWNWARD}};
+
+static const int test_nb_operands = 1 << 14; // a multiple of 16
+static const int test_max_errors = 8;        // printed per kernel
+
+// * Entry points
+
+typedef void (*test_vector_float_t)(float *, float *, float *, float *,
+                                    void *);
+typedef void (*test_vector_double_t)(double *, double *, double *, double *,
+                                     void *);
+
+static const int test_float_lanes[4] = {1, 4, 8, 16};
+static const int test_double_lanes[4] = {1, 2, 4, 8};
+
+#define TEST_ISA(ISA)                                                          \
+  {                                                                            \
+    {interflop_vector_verrou_fma_float_1_##ISA,                                \
+     interflop_vector_verrou_fma_float_4_##ISA,                                \
+     interflop_vector_verrou_fma_float_8_##ISA,                                \
+     interflop_vector_verrou_fma_float_16_##ISA},                              \
+        {interflop_vector_verrou_fma_double_1_##ISA,                           \
+         interflop_vector_verrou_fma_double_2_##ISA,                           \
+         interflop_vector_verrou_fma_double_4_##ISA,                           \
+         interflop_vector_verrou_fma_double_8_##ISA},                          \
+  }
+
+struct test_isa_t {
+  test_vector_float_t vfloat[4];
+  test_vector_double_t vdouble[4];
+};
+
+static const test_isa_t test_isa[TEST_NB_ISA] = {
+    TEST_ISA(scalar), TEST_ISA(sse), TEST_ISA(avx), TEST_ISA(avx512)};
+
+/* the scalar entry point, as a vector of one lane */
+static void test_scalar_float(float *a, float *b, float *c, float *res,
+                              void *context) {
+  interflop_verrou_fma_float(*a, *b, *c, res, context);
+}
+
+static void test_scalar_double(double *a, double *b, double *c, double *res,
+                               void *context) {
+  interflop_verrou_fma_double(*a, *b, *c, res, context);
+}
+
+// * Operands and reference
+
+template <class T> struct test_operands_t {
+  T a[test_nb_operands];
+  T b[test_nb_operands];
+  T c[test_nb_operands];
+  T ref[test_nb_operands];
+};
+
+/* a and b in [emin, emax], c of the magnitude of a * b for half of the
+   triples, so that the fma cancels; the fixed triples come first */
+template <class T>
+static void test_fill(test_operands_t<T> &op, int emin, int emax,
+                      const T *fixed, int nb_fixed) {
+  int i = 0;
+  for (; i < nb_fixed; i++) {
+    op.a[i] = fixed[3 * i];
+    op.b[i] = fixed[3 * i + 1];
+    op.c[i] = fixed[3 * i + 2];
+  }
+  for (; i < test_nb_operands; i++) {
+    op.a[i] = test_random<T>(emin, emax);
+    op.b[i] = test_random<T>(emin, emax);
+    const int e = ilogb(op.a[i]) + ilogb(op.b[i]);
+    op.c[i] = i % 2 ? test_random<T>(2 * emin, 2 * emax - 1)
+                    : test_random<T>(e - 2, e + 2);
+  }
+}
+
+static const float test_fixed_float[] = {
+    0x1.067ea8p-128f, 0x1.3c496p-129f, -0x1.47e05p-11f // subnormal error
+};
+
+static float test_fma(float a, float b, float c) { return fmaf(a, b, c); }
+static double test_fma(double a, double b, double c) { return fma(a, b, c); }
+
+template <class T>
+static void test_reference(test_operands_t<T> &op, int fenv) {
+  fesetround(fenv);
+  for (int i = 0; i < test_nb_operands; i++)
+    op.ref[i] = test_fma(op.a[i], op.b[i], op.c[i]);
+  fesetround(FE_TONEAREST);
+}
+
+// * Check
+
+/* the same bits, but for the sign of zero: upward, verrou rounds the
+   results between -denorm_min and 0 to +0, where the FPU gives -0 */
+template <class T> static bool test_same_fma(T x, T ref) {
+  return test_same(x, ref) || (x == 0 && ref == 0);
+}
+
+template <class T, class V>
+static long test_kernel(const char *isa, const char *type, int lanes,
+                        V vector, const test_operands_t<T> &in) {
+  long errors = 0;
+  for (int i = 0; i < test_nb_operands; i += lanes) {
+    T a[16], b[16], c[16], res[16];
+    memcpy(a, in.a + i, lanes * sizeof(T));
+    memcpy(b, in.b + i, lanes * sizeof(T));
+    memcpy(c, in.c + i, lanes * sizeof(T));
+    vector(a, b, c, res, test_context);
+    for (int j = 0; j < lanes; j++) {
+      if (test_same_fma(res[j], in.ref[i + j]))
+        continue;
+      if (errors < test_max_errors)
+        fprintf(stderr, "  %s fma_%s_%d: %a %a %a -> %a, fma %a\n", isa, type,
+                lanes, (double)in.a[i + j], (double)in.b[i + j],
+                (double)in.c[i + j], (double)res[j], (double)in.ref[i + j]);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main(void) {
+  test_init();
+  srand48(42);
+
+  static test_operands_t<float> opf;
+  static test_operands_t<double> opd;
+  test_fill(opf, -75, 64, test_fixed_float,
+            sizeof(test_fixed_float) / (3 * sizeof(float)));
+  test_fill(opd, -250, 250, (const double *)NULL, 0);
+
+  long errors = 0;
+  for (const auto &m : test_modes) {
+    test_configure(m.mode);
+    test_reference(opf, m.fenv);
+    test_reference(opd, m.fenv);
+    long modeErrors =
+        test_kernel("backend", "float", 1, test_scalar_float, opf) +
+        test_kernel("backend", "double", 1, test_scalar_double, opd);
+    for (int isa = 0; isa < TEST_NB_ISA; isa++) {
+      if (!test_isa_supported(isa))
+        continue;
+      for (int k = 0; k < 4; k++) {
+        modeErrors += test_kernel(test_isa_name[isa], "float",
+                                  test_float_lanes[k],
+                                  test_isa[isa].vfloat[k], opf);
+        modeErrors += test_kernel(test_isa_name[isa], "double",
+                                  test_double_lanes[k],
+                                  test_isa[isa].vdouble[k], opd);
+      }
+    }
+    printf("%-16s %s\n", verrou_rounding_mode_name(m.mode),
+           modeErrors ? "FAILED" : "ok");
+    errors += modeErrors;
+  }
+  for (int isa = 0; isa < TEST_NB_ISA; isa++)
+    if (!test_isa_supported(isa))
+      printf("%s not supported by the CPU: skipped\n", test_isa_name[isa]);
+
+  interflop_verrou_finalize(test_context);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Regression test of verrou_sum, verrou_dot and verrou_nrm2: in the rounding
+ * modes whose result does not depend on the order of the calls, the bits
+ * must not depend on the vector implementation nor on the number of
+ * reduction threads. verrou_nrm2 must neither overflow nor underflow when
+ * its result does not.
+ */
+
+#include "verrou_test.h"
+
+static const enum vr_RoundingMode test_modes[] = {
+    VR_NEAREST,       VR_UPWARD,      VR_DOWNWARD,
+    VR_ZERO,          VR_FARTHEST,    VR_RANDOM_DET,
+    VR_RANDOM_COMDET, VR_AVERAGE_DET, VR_PRANDOM_DET};
+
+static const unsigned int test_threads[] = {1, 3, 8};
+
+/* blocks of the reduction with a tail, enough for the threads to share */
+static const size_t test_n = 11 * 4096 + 13;
+
+// * Results of every reduction
+
+struct test_results_t {
+  double d[3];
+  float f[3];
+};
+
+static test_results_t test_reduce(const double *xd, const double *yd,
+                                  const float *xf, const float *yf,
+                                  size_t n) {
+  test_results_t r;
+  r.d[0] = verrou_sum_double(xd, n, test_context);
+  r.d[1] = verrou_dot_double(xd, yd, n, test_context);
+  r.d[2] = verrou_nrm2_double(xd, n, test_context);
+  r.f[0] = verrou_sum_float(xf, n, test_context);
+  r.f[1] = verrou_dot_float(xf, yf, n, test_context);
+  r.f[2] = verrou_nrm2_float(xf, n, test_context);
+  return r;
+}
+
+static const char *test_reduce_name[3] = {"sum", "dot", "nrm2"};
+
+static long test_compare(const char *mode, const char *isa,
+                         unsigned int threads, const test_results_t &res,
+                         const test_results_t &ref) {
+  long errors = 0;
+  for (int k = 0; k < 3; k++) {
+    if (!test_same(res.d[k], ref.d[k])) {
+      fprintf(stderr, "  %s %s %u threads: %s_double %a instead of %a\n", mode,
+              isa, threads, test_reduce_name[k], res.d[k], ref.d[k]);
+      errors++;
+    }
+    if (!test_same(res.f[k], ref.f[k])) {
+      fprintf(stderr, "  %s %s %u threads: %s_float %a instead of %a\n", mode,
+              isa, threads, test_reduce_name[k], (double)res.f[k],
+              (double)ref.f[k]);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+// * nrm2 of values whose squares overflow or underflow
+
+template <class T>
+static long test_nrm2(T (*nrm2)(const T *, size_t, void *), int e) {
+  const T x[5] = {0, (T)ldexp(3, e), 0, (T)ldexp(-4, e), 0};
+  const T res = nrm2(x, 5, test_context);
+  const T expected = (T)ldexp(5, e);
+  if (test_same(res, expected))
+    return 0;
+  fprintf(stderr, "  nrm2 of 3 * 2^%d and -4 * 2^%d: %a instead of %a\n", e, e,
+          (double)res, (double)expected);
+  return 1;
+}
+
+int main(void) {
+  test_init();
+  srand48(42);
+
+  static double xd[test_n], yd[test_n];
+  static float xf[test_n], yf[test_n];
+  for (size_t i = 0; i < test_n; i++) {
+    xd[i] = test_random<double>(-20, 20);
+    yd[i] = test_random<double>(-20, 20);
+    xf[i] = test_random<float>(-20, 20);
+    yf[i] = test_random<float>(-20, 20);
+  }
+
+  long errors = 0;
+  for (enum vr_RoundingMode mode : test_modes) {
+    const char *name = verrou_rounding_mode_name(mode);
+    verrou_conf_t conf = test_conf(mode);
+    test_results_t ref;
+    long modeErrors = 0;
+    bool first = true;
+    for (int isa = 0; isa < TEST_NB_ISA; isa++) {
+      if (!test_isa_supported(isa))
+        continue;
+      for (unsigned int threads : test_threads) {
+        conf.vector_isa = (enum vr_VectorIsa)(VR_VECTOR_ISA_SCALAR + isa);
+        conf.reduction_threads = threads;
+        test_configure(conf);
+        const test_results_t res = test_reduce(xd, yd, xf, yf, test_n);
+        if (first)
+          ref = res;
+        else
+          modeErrors +=
+              test_compare(name, test_isa_name[isa], threads, res, ref);
+        first = false;
+      }
+    }
+    printf("%-16s %s\n", name, modeErrors ? "FAILED" : "ok");
+    errors += modeErrors;
+  }
+
+  static const int test_exp_double[] = {-1070, -600, 0, 600, 1018};
+  static const int test_exp_float[] = {-145, -100, 0, 100, 122};
+  test_configure(VR_NEAREST);
+  long nrm2Errors = 0;
+  for (int e : test_exp_double)
+    nrm2Errors += test_nrm2<double>(verrou_nrm2_double, e);
+  for (int e : test_exp_float)
+    nrm2Errors += test_nrm2<float>(verrou_nrm2_float, e);
+  printf("%-16s %s\n", "nrm2 scaling", nrm2Errors ? "FAILED" : "ok");
+  errors += nrm2Errors;
+
+  interflop_verrou_finalize(test_context);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Regression test of the vector entry points: in the rounding modes whose
+ * result does not depend on the order of the calls, every lane of add, sub,
+ * mul and div, for every vector size of every instruction set the CPU runs,
+ * must have the bits of the scalar entry point on the same operands.
+ *
+ * Operands cover the whole exponent range, so that results overflow,
+ * underflow and are subnormal, and half of the pairs are of close magnitude
+ * so that add and sub cancel.
+ */
+
+#include "verrou_test.h"
+
+#include "interflop_vector_verrou_scalar.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_sse.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_avx.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+#include "interflop_vector_verrou_avx512.h"
+#undef INTERFLOP_VECTOR_VERROU_API
+
+/* the modes of the vector kernels (vr_vroundingOp.hxx) whose result does
+   not depend on the order of the calls */
+static const enum vr_RoundingMode test_modes[] = {
+    VR_NEAREST,        VR_UPWARD,      VR_DOWNWARD,
+    VR_RANDOM_DET,     VR_RANDOM_COMDET, VR_AVERAGE_DET,
+    VR_AVERAGE_COMDET, VR_PRANDOM_DET, VR_PRANDOM_COMDET};
+
+static const int test_nb_ops = 4;
+static const char *test_op_name[test_nb_ops] = {"add", "sub", "mul", "div"};
+
+static const int test_nb_operands = 1 << 14; // a multiple of 16
+static const int test_max_errors = 8;        // printed per kernel
+
+// * Entry points
+
+typedef void (*test_scalar_float_t)(float, float, float *, void *);
+typedef void (*test_scalar_double_t)(double, double, double *, void *);
+typedef void (*test_vector_float_t)(float *, float *, float *, void *);
+typedef void (*test_vector_double_t)(double *, double *, double *, void *);
+
+static const test_scalar_float_t test_scalar_float[test_nb_ops] = {
+    interflop_verrou_add_float, interflop_verrou_sub_float,
+    interflop_verrou_mul_float, interflop_verrou_div_float};
+static const test_scalar_double_t test_scalar_double[test_nb_ops] = {
+    interflop_verrou_add_double, interflop_verrou_sub_double,
+    interflop_verrou_mul_double, interflop_verrou_div_double};
+
+static const int test_float_lanes[4] = {1, 4, 8, 16};
+static const int test_double_lanes[4] = {1, 2, 4, 8};
+
+#define TEST_FLOAT(OP, ISA)                                                    \
+  {                                                                            \
+    interflop_vector_verrou_##OP##_float_1_##ISA,                              \
+        interflop_vector_verrou_##OP##_float_4_##ISA,                          \
+        interflop_vector_verrou_##OP##_float_8_##ISA,                          \
+        interflop_vector_verrou_##OP##_float_16_##ISA                          \
+  }
+#define TEST_DOUBLE(OP, ISA)                                                   \
+  {                                                                            \
+    interflop_vector_verrou_##OP##_double_1_##ISA,                             \
+        interflop_vector_verrou_##OP##_double_2_##ISA,                         \
+        interflop_vector_verrou_##OP##_double_4_##ISA,                         \
+        interflop_vector_verrou_##OP##_double_8_##ISA                          \
+  }
+
+struct test_isa_t {
+  test_vector_float_t vfloat[test_nb_ops][4];
+  test_vector_double_t vdouble[test_nb_ops][4];
+};
+
+#define TEST_ISA(ISA)                                                          \
+  {                                                                            \
+    {TEST_FLOAT(add, ISA), TEST_FLOAT(sub, ISA), TEST_FLOAT(mul, ISA),         \
+     TEST_FLOAT(div, ISA)},                                                    \
+        {TEST_DOUBLE(add, ISA), TEST_DOUBLE(sub, ISA), TEST_DOUBLE(mul, ISA),  \
+         TEST_DOUBLE(div, ISA)},                                               \
+  }
+
+static const test_isa_t test_isa[TEST_NB_ISA] = {
+    TEST_ISA(scalar), TEST_ISA(sse), TEST_ISA(avx), TEST_ISA(avx512)};
+
+// * Operands
+
+template <class T> struct test_operands_t {
+  T a[test_nb_operands];
+  T b[test_nb_operands];
+};
+
+/* emax/2 bounds the exponents, so that products and quotients reach both
+   the overflow and the subnormal range; the fixed pairs come first */
+template <class T>
+static void test_fill(test_operands_t<T> &op, int emin, int emax,
+                      const T *fixed, int nb_fixed) {
+  int i = 0;
+  for (; i < nb_fixed; i++) {
+    op.a[i] = fixed[2 * i];
+    op.b[i] = fixed[2 * i + 1];
+  }
+  for (; i < test_nb_operands; i++) {
+    op.a[i] = test_random<T>(emin / 2, emax / 2);
+    if (i % 2) {
+      op.b[i] = test_random<T>(emin / 2, emax / 2);
+    } else {
+      const int e = ilogb(op.a[i]);
+      op.b[i] = test_random<T>(e - 30, e + 1);
+    }
+  }
+}
+
+static const float test_fixed_float[] = {
+    0x1.48c1ap-128f,   0x1.e9716ap-11f, // subnormal product
+    -0x1.28e68cp+123f, -0x1.5ed11ep-12f // the split of a overflows
+};
+
+// * Check
+
+template <class T, class S, class V>
+static long test_kernel(const char *isa, const char *op, const char *type,
+                        int lanes, S scalar, V vector,
+                        const test_operands_t<T> &in) {
+  long errors = 0;
+  for (int i = 0; i < test_nb_operands; i += lanes) {
+    T a[16], b[16], res[16];
+    memcpy(a, in.a + i, lanes * sizeof(T));
+    memcpy(b, in.b + i, lanes * sizeof(T));
+    vector(a, b, res, test_context);
+    for (int j = 0; j < lanes; j++) {
+      T expected;
+      scalar(in.a[i + j], in.b[i + j], &expected, test_context);
+      if (test_same(res[j], expected))
+        continue;
+      if (errors < test_max_errors)
+        fprintf(stderr, "  %s %s_%s_%d: %a %a -> %a, scalar %a\n", isa, op,
+                type, lanes, (double)in.a[i + j], (double)in.b[i + j],
+                (double)res[j], (double)expected);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main(void) {
+  test_init();
+  srand48(42);
+
+  static test_operands_t<float> opf;
+  static test_operands_t<double> opd;
+  test_fill(opf, -149, 127, test_fixed_float,
+            sizeof(test_fixed_float) / (2 * sizeof(float)));
+  test_fill(opd, -1074, 1023, (const double *)NULL, 0);
+
+  long errors = 0;
+  for (enum vr_RoundingMode mode : test_modes) {
+    test_configure(mode);
+    long modeErrors = 0;
+    for (int isa = 0; isa < TEST_NB_ISA; isa++) {
+      if (!test_isa_supported(isa))
+        continue;
+      const char *name = test_isa_name[isa];
+      for (int op = 0; op < test_nb_ops; op++) {
+        for (int k = 0; k < 4; k++) {
+          modeErrors += test_kernel(name, test_op_name[op], "float",
+                                    test_float_lanes[k], test_scalar_float[op],
+                                    test_isa[isa].vfloat[op][k], opf);
+          modeErrors += test_kernel(
+              name, test_op_name[op], "double", test_double_lanes[k],
+              test_scalar_double[op], test_isa[isa].vdouble[op][k], opd);
+        }
+      }
+    }
+    printf("%-16s %s\n", verrou_rounding_mode_name(mode),
+           modeErrors ? "FAILED" : "ok");
+    errors += modeErrors;
+  }
+  for (int isa = 0; isa < TEST_NB_ISA; isa++)
+    if (!test_isa_supported(isa))
+      printf("%s not supported by the CPU: skipped\n", test_isa_name[isa]);
+
+  interflop_verrou_finalize(test_context);
+  return errors ? 1 : 0;
+}
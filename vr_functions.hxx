@@ -0,0 +1,145 @@
+#pragma once
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "interflop/interflop_stdlib.h"
+
+/*
+ * Functions of --exclude-functions and --include-functions, looked up by
+ * interflop_enter_function. The list file names one function per line, as
+ * the id of its interflop_function_info_t: the first word of the line, '#'
+ * starts a comment. It is mapped at initialization, and stays mapped: an
+ * open-addressing table, at most half full, keeps the 64-bit FNV-1a hash of
+ * each name with its offset and length in the mapping. A lookup hashes the
+ * name and probes about once, whatever the length of the list, and compares
+ * the names on a hash hit.
+ */
+typedef struct {
+  uint64_t hash; // 0 for an empty slot
+  uint32_t offset;
+  uint32_t len;
+} Vr_FunctionSlot;
+
+typedef struct {
+  Vr_FunctionSlot *slots;
+  uint64_t mask;
+  size_t size;
+  const char *names; // the list file
+} Vr_FunctionSet;
+
+/* FNV-1a of name[0, len), never 0 */
+static inline uint64_t vr_functionHash(const char *name, size_t len) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < len; i++) {
+    h ^= (unsigned char)name[i];
+    h *= 0x100000001b3ULL;
+  }
+  return h | (h == 0);
+}
+
+/* the slot of name[0, len) with hash h, or the empty slot which ends its
+   probes */
+static inline const Vr_FunctionSlot *
+vr_functionSet_find(const Vr_FunctionSet *set, const char *name, size_t len,
+                    uint64_t h) {
+  for (uint64_t i = h & set->mask;; i = (i + 1) & set->mask) {
+    const Vr_FunctionSlot *slot = &set->slots[i];
+    if (slot->hash == 0)
+      return slot;
+    if (slot->hash == h && slot->len == len &&
+        memcmp(set->names + slot->offset, name, len) == 0)
+      return slot;
+  }
+}
+
+/* inserts the name at offset of set->names */
+static inline void vr_functionSet_insert(Vr_FunctionSet *set, size_t offset,
+                                         size_t len) {
+  const char *name = set->names + offset;
+  const uint64_t h = vr_functionHash(name, len);
+  Vr_FunctionSlot *slot =
+      (Vr_FunctionSlot *)vr_functionSet_find(set, name, len, h);
+  if (slot->hash != 0)
+    return;
+  slot->hash = h;
+  slot->offset = (uint32_t)offset;
+  slot->len = (uint32_t)len;
+  set->size++;
+}
+
+static inline bool vr_functionSet_contains(const Vr_FunctionSet *set,
+                                           const char *name) {
+  const size_t len = strlen(name);
+  return vr_functionSet_find(set, name, len, vr_functionHash(name, len))
+             ->hash != 0;
+}
+
+/* calls f(name, len) for the function name of each line of [buf, end) */
+template <class F>
+static inline void vr_functionList_forEach(const char *buf, const char *end,
+                                           F f) {
+  while (buf < end) {
+    const char *eol = (const char *)memchr(buf, '\n', end - buf);
+    if (eol == NULL)
+      eol = end;
+    while (buf < eol && (*buf == ' ' || *buf == '\t'))
+      buf++;
+    const char *word = buf;
+    while (buf < eol && *buf != ' ' && *buf != '\t' && *buf != '\r' &&
+           *buf != '#')
+      buf++;
+    if (buf > word)
+      f(word, (size_t)(buf - word));
+    buf = eol + 1;
+  }
+}
+
+/* fills set from the list file path; false if it cannot be read */
+static inline bool vr_functionSet_load(Vr_FunctionSet *set,
+                                       const char *path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  const size_t len = (size_t)st.st_size;
+  if (len > UINT32_MAX) {
+    close(fd);
+    return false;
+  }
+  void *map = NULL;
+  if (len != 0) {
+    map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+  const char *buf = (const char *)map;
+
+  size_t count = 0;
+  vr_functionList_forEach(buf, buf + len,
+                          [&](const char *, size_t) { count++; });
+  uint64_t slots = 16;
+  while (slots < 2 * count)
+    slots *= 2;
+  set->slots =
+      (Vr_FunctionSlot *)interflop_malloc(slots * sizeof(Vr_FunctionSlot));
+  memset(set->slots, 0, slots * sizeof(Vr_FunctionSlot));
+  set->mask = slots - 1;
+  set->size = 0;
+  set->names = buf; // never unmapped, as the slots are never freed
+  vr_functionList_forEach(buf, buf + len, [&](const char *name, size_t n) {
+    vr_functionSet_insert(set, (size_t)(name - buf), n);
+  });
+  return true;
+}
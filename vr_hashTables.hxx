@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "interflop/prng/vr_rand.h"
+
+/*
+ * Tables of the tabulation and multiply-shift hashes. Each thread owns its
+ * copy in vr_hashTables, next to vr_rand: the hot path reads local memory
+ * only, and reseeding a thread leaves the tables of the other threads alone.
+ * The TLS block is first touched by its thread, so the tables are allocated
+ * on its NUMA node.
+ *
+ * vr_rand_setSeed only records the seed: each table is built on the first
+ * operation of the thread which hashes with it, so a reseed costs nothing
+ * for the modes and hashes without tables. A thread which has not called
+ * vr_rand_setSeed builds its tables from vr_hashTablesSeed, the seed given
+ * at initialization, so that all the threads hash with the same tables by
+ * default.
+ */
+enum {
+  VR_HASH_TABLES_TABULATION = 1,     // hashTable, hashTableOp
+  VR_HASH_TABLES_MULTIPLY_SHIFT = 2, // seedTab
+};
+
+typedef struct Vr_HashTables_ {
+  uint32_t hashTable[4][8][256];
+  uint32_t hashTableOp[2][256];
+  uint64_t seedTab[8];
+  uint64_t seed_; // of the last vr_rand_setSeed of the thread
+  uint8_t ready_; // VR_HASH_TABLES_* built from the seed
+  bool seeded_;   // false: vr_hashTablesSeed
+} __attribute__((aligned(64))) Vr_HashTables;
+
+/* C linkage: the vector objects include this header in their ISA namespace
+   and must still see the tables of interflop_verrou.cxx */
+extern "C" TLS Vr_HashTables vr_hashTables;
+
+// only written at initialization
+extern "C" uint64_t vr_hashTablesSeed;
+
+/*
+ * i-th output of splitmix64 from the state key. The outputs do not depend
+ * on each other, so the tables are filled without a dependency chain.
+ */
+static inline uint64_t vr_hashTables_draw(uint64_t key, uint64_t i) {
+  uint64_t z = key + (i + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// the tables of the calling thread, with TABLES built; defined in
+// vr_rand_implem.h, once the hashes are known
+template <unsigned TABLES> inline const Vr_HashTables &vr_hashTables_get();
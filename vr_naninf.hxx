@@ -0,0 +1,66 @@
+#pragma once
+
+#include "interflop/interflop_stdlib.h"
+#include "vr_isNan.hxx"
+
+/*
+ * NaN and Inf policies of the Rounding classes, selected by --naninf-check
+ * as the profiling one. The result rounded to nearest is tested once:
+ *
+ * - ROUND: a NaN or Inf result is not perturbed, and an overflow of the
+ *   directed modes to the wrong infinity is rounded to the largest finite
+ *   value. Otherwise it is rounded as any other result.
+ * - HANDLE: interflop_nanHandler or interflop_infHandler is called.
+ *
+ * Without both, the test is compiled out.
+ */
+
+// out of the operations: only the test of the result is inlined
+template <class REALTYPE>
+__attribute__((noinline, cold)) void vr_naninf_handle(const REALTYPE res) {
+  if (isNan<REALTYPE>(res))
+    interflop_nanHandler();
+  else
+    interflop_infHandler();
+}
+
+template <bool ROUND, bool HANDLE> struct vr_naninf {
+  // true when the Rounding class must keep res as a NaN or an Inf
+  template <class REALTYPE>
+  static inline __attribute__((always_inline)) bool
+  isSpecial([[maybe_unused]] const REALTYPE &res) {
+    if constexpr (!ROUND && !HANDLE) {
+      return false;
+    } else {
+      if (__builtin_expect(!isNanInf<REALTYPE>(res), 1))
+        return false;
+      if constexpr (HANDLE)
+        vr_naninf_handle<REALTYPE>(res);
+      return ROUND;
+    }
+  }
+};
+
+typedef vr_naninf<true, true> vr_naninfFull;
+typedef vr_naninf<false, true> vr_naninfHandlerOnly;
+typedef vr_naninf<false, false> vr_naninfOff;
+// the vector backend and its scalar fallbacks never call the handlers
+typedef vr_naninf<true, false> vr_naninfNoHandler;
+
+/*
+ * Runtime choice of the policy (--naninf-check): F<NANINF>::apply(args...)
+ * for the selected one. Called once per call of the array entry points and
+ * of the reductions, and once at initialization otherwise.
+ */
+template <template <class> class F, class... ARGS>
+inline auto vr_naninfDispatch(enum vr_NanInfCheck check, ARGS &&...args) {
+  switch (check) {
+  case VR_NANINF_CHECK_FULL:
+    return F<vr_naninfFull>::apply(args...);
+  case VR_NANINF_CHECK_HANDLER_ONLY:
+    return F<vr_naninfHandlerOnly>::apply(args...);
+  case VR_NANINF_CHECK_OFF:
+    return F<vr_naninfOff>::apply(args...);
+  }
+  return F<vr_naninfFull>::apply(args...);
+}
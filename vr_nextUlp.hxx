@@ -96,3 +96,68 @@ template <class REALTYPE> inline REALTYPE nextPrev(REALTYPE a) {
     return nextAwayFromZero(a);
   }
 };
+
+/*
+ * Branchless variants for the scalar rounding modes, on the representation
+ * of float and double: adding 1 moves away from zero and adding -1 toward
+ * zero, as in nextAwayFromZero and nextTowardZero. change and the direction
+ * only select masks and steps, so that a random bit costs no misprediction.
+ * They are forced inline, as the calls would cost more than the branches.
+ */
+#define VR_NEXTULP_INLINE inline __attribute__((always_inline))
+
+template <class REALTYPE> struct vr_realBits {};
+
+template <> struct vr_realBits<double> {
+  typedef uint64_t UInt;
+};
+
+template <> struct vr_realBits<float> {
+  typedef uint32_t UInt;
+};
+
+template <class REALTYPE>
+VR_NEXTULP_INLINE typename vr_realBits<REALTYPE>::UInt vr_toBits(REALTYPE a) {
+  typename vr_realBits<REALTYPE>::UInt u;
+  std::memcpy(&u, &a, sizeof(REALTYPE));
+  return u;
+};
+
+template <class REALTYPE>
+VR_NEXTULP_INLINE REALTYPE vr_fromBits(typename vr_realBits<REALTYPE>::UInt u) {
+  REALTYPE a;
+  std::memcpy(&a, &u, sizeof(REALTYPE));
+  return a;
+};
+
+// a if !change, else nextAwayFromZero(a) if away and nextTowardZero(a) if not
+template <class REALTYPE>
+VR_NEXTULP_INLINE REALTYPE nextAwayOrTowardIf(REALTYPE a, bool change,
+                                              bool away) {
+  typedef typename vr_realBits<REALTYPE>::UInt UInt;
+  const UInt step = UInt(change) * (2 * UInt(away) - 1);
+  return vr_fromBits<REALTYPE>(vr_toBits<REALTYPE>(a) + step);
+};
+
+// a if !change, else nextAfter(a) if up and nextPrev(a) if not
+template <class REALTYPE>
+VR_NEXTULP_INLINE REALTYPE nextAfterOrPrevIf(REALTYPE a, bool change, bool up) {
+  typedef typename vr_realBits<REALTYPE>::UInt UInt;
+  const UInt sign = UInt(1) << (8 * sizeof(UInt) - 1);
+  // nextPrev(+-0) is -denorm_min, the step away from -0
+  const UInt u =
+      vr_toBits<REALTYPE>(a) | (sign & -UInt(change & !up & (a == 0)));
+  const bool away = (up & (a >= 0)) | (!up & !(a > 0));
+  return vr_fromBits<REALTYPE>(u + UInt(change) * (2 * UInt(away) - 1));
+};
+
+/* a if !change, else the next value toward +inf: nextAfter(a), except that
+   both zeros give denorm_min and -denorm_min gives +0 */
+template <class REALTYPE>
+VR_NEXTULP_INLINE REALTYPE nextUpIf(REALTYPE a, bool change) {
+  typedef typename vr_realBits<REALTYPE>::UInt UInt;
+  const UInt sign = UInt(1) << (8 * sizeof(UInt) - 1);
+  const UInt u = vr_toBits<REALTYPE>(a) & ~(sign & -UInt(change & (a == 0)));
+  const UInt v = u + UInt(change) * (2 * UInt(a >= 0) - 1);
+  return vr_fromBits<REALTYPE>(v & ~(sign & -UInt(change & (v == sign))));
+};
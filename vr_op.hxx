@@ -65,18 +65,64 @@ template <> inline uint64_t getTypeHash<double>() {
 
 template <class REALTYPE, int NB> struct vr_packArg;
 
+/*
+ * Type of the lane-wise masks returned by the vector NaN/Inf checks
+ * (hasOneArgNanInf, areInfNotSpecificToNearest). Specialized for each SIMD
+ * type in x86_64/vr_simd.hxx.
+ */
+template <class REALTYPE> struct vr_laneMask { typedef __m128i type; };
+
+/*
+ * The fma of the error terms is the one of the CPU when it has one: known at
+ * compile time with __FMA__ (the avx and avx512 objects), tested once at
+ * load time otherwise (the base, scalar and sse objects, which run on any
+ * x86_64). The software interflop_fma_binary* is the fallback, and the only
+ * fma of __float128.
+ */
+#ifdef __FMA__
+#define VR_HARDWARE_FMA_ATTR
+#else
+#define VR_HARDWARE_FMA_ATTR __attribute__((target("fma")))
+
+inline const bool vr_hasHardwareFma = [] {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("fma") != 0;
+}();
+#endif
+
+VR_HARDWARE_FMA_ATTR inline float vr_hardwareFma(float a, float b, float c) {
+  return _mm_cvtss_f32(
+      _mm_fmadd_ss(_mm_set_ss(a), _mm_set_ss(b), _mm_set_ss(c)));
+}
+
+VR_HARDWARE_FMA_ATTR inline double vr_hardwareFma(double a, double b,
+                                                  double c) {
+  return _mm_cvtsd_f64(
+      _mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(b), _mm_set_sd(c)));
+}
+
+#undef VR_HARDWARE_FMA_ATTR
+
 template <typename REAL>
 REAL __verrou_internal_fma(const REAL &a, const REAL &b, const REAL &c);
 
 template <>
 inline float __verrou_internal_fma(const float &a, const float &b, const float &c) {
-  return interflop_fma_binary32(a, b, c);
+#ifndef __FMA__
+  if (__builtin_expect(!vr_hasHardwareFma, 0))
+    return interflop_fma_binary32(a, b, c);
+#endif
+  return vr_hardwareFma(a, b, c);
 }
 
 template <>
 inline double __verrou_internal_fma(const double &a, const double &b,
                              const double &c) {
-  return interflop_fma_binary64(a, b, c);
+#ifndef __FMA__
+  if (__builtin_expect(!vr_hasHardwareFma, 0))
+    return interflop_fma_binary64(a, b, c);
+#endif
+  return vr_hardwareFma(a, b, c);
 }
 template <>
 inline __float128 __verrou_internal_fma(const __float128 &a, const __float128 &b,
@@ -84,6 +130,50 @@ inline __float128 __verrou_internal_fma(const __float128 &a, const __float128 &b
   return interflop_fma_binary128(a, b, c);
 }
 
+/*
+ * Float operations through double. The product of two floats is exact in
+ * double, and so is its difference with a float within a factor of 2 of it
+ * (Sterbenz): the error terms of MulOp<float> and DivOp<float> need one double
+ * operation instead of __verrou_internal_fma, and the float fma one TwoSum.
+ * The sum of two floats is not exact in double once their exponents differ by
+ * more than 29: AddOp<float> and SubOp<float> keep their float TwoSum, which
+ * needs no fma either.
+ */
+
+// a * b + c == s + e exactly, with s the double nearest to it
+inline void vr_floatMAdd(const float a, const float b, const float c,
+                         double &s, double &e) {
+  const double p = (double)a * (double)b;
+  const double cd = c;
+  s = p + cd;
+  const double z = s - p;
+  e = (p - (s - z)) + (cd - z); // algo TwoSum
+}
+
+// s + e rounded to float: s is first rounded to odd, so that the double
+// rounding is the correct one (Boldo and Melquiond)
+inline float vr_floatRoundOdd(double s, const double e) {
+  if (e > 0 || e < 0) { // false for NaN, when s is not finite
+    uint64_t u;
+    std::memcpy(&u, &s, sizeof(s));
+    if ((u & 1) == 0) {
+      u += ((s > 0) == (e > 0)) ? 1 : -1;
+      std::memcpy(&s, &u, sizeof(s));
+    }
+  }
+  return (float)s;
+}
+
+inline float vr_floatSign(const double r) {
+  if (r < 0) {
+    return -1;
+  }
+  if (r > 0) {
+    return 1;
+  }
+  return 0.;
+}
+
 /*
  * takes a real number and returns a uint64_t by reinterpreting its bits, NOT
  * casting it used by the getHash function in the vr_packArg classes
@@ -114,7 +204,7 @@ template <class REALTYPE> struct vr_packArg<REALTYPE, 1> {
 
   inline bool isOneArgNanInf() const { return isNanInf<RealType>(arg1); }
   
-  inline __m128i hasOneArgNanInf() const {
+  inline typename vr_laneMask<RealType>::type hasOneArgNanInf() const {
     interflop_panic ("Not implemented");
     return _mm_set1_epi8 ( (char) 1);
   }
@@ -137,7 +227,7 @@ template <class REALTYPE> struct vr_packArg<REALTYPE, 2> {
     return (isNanInf<RealType>(arg1) || isNanInf<RealType>(arg2));
   }
 
-  inline __m128i hasOneArgNanInf() const {
+  inline typename vr_laneMask<RealType>::type hasOneArgNanInf() const {
     interflop_panic ("Not implemented");
     return _mm_set1_epi8 ( (char) 1);
   }
@@ -164,7 +254,7 @@ template <class REALTYPE> struct vr_packArg<REALTYPE, 3> {
             isNanInf<RealType>(arg3));
   }
 
-  inline __m128i hasOneArgNanInf() const {
+  inline typename vr_laneMask<RealType>::type hasOneArgNanInf() const {
     interflop_panic ("Not implemented");
     return _mm_set1_epi8 ( (char) 1);
   }
@@ -174,11 +264,20 @@ template <class REALTYPE> struct vr_packArg<REALTYPE, 3> {
   const RealType &arg3;
 };
 
+/* x rounded to float and back, opaque to the optimizer: GCC 12 otherwise
+   folds the conversions with the operation which follows, once the array
+   loops are SLP-vectorized */
+template <class REALTYPE> static inline REALTYPE vr_toFloatValue(REALTYPE x) {
+  REALTYPE v = REALTYPE(float(x));
+  asm("" : "+x"(v));
+  return v;
+}
+
 template <class REALTYPE, int NB> class vr_roundFloat;
 
 template <class REALTYPE> struct vr_roundFloat<REALTYPE, 1> {
   vr_roundFloat(const vr_packArg<REALTYPE, 1> &p)
-      : arg1(REALTYPE(float(p.arg1))) {}
+      : arg1(vr_toFloatValue(p.arg1)) {}
   vr_packArg<REALTYPE, 1> getPack() const {
     return vr_packArg<REALTYPE, 1>(arg1);
   }
@@ -188,7 +287,7 @@ template <class REALTYPE> struct vr_roundFloat<REALTYPE, 1> {
 
 template <class REALTYPE> struct vr_roundFloat<REALTYPE, 2> {
   vr_roundFloat(const vr_packArg<REALTYPE, 2> &p)
-      : arg1(REALTYPE(float(p.arg1))), arg2(REALTYPE(float(p.arg2))) {}
+      : arg1(vr_toFloatValue(p.arg1)), arg2(vr_toFloatValue(p.arg2)) {}
   vr_packArg<REALTYPE, 2> getPack() const {
     return vr_packArg<REALTYPE, 2>(arg1, arg2);
   }
@@ -198,8 +297,8 @@ template <class REALTYPE> struct vr_roundFloat<REALTYPE, 2> {
 
 template <class REALTYPE> struct vr_roundFloat<REALTYPE, 3> {
   vr_roundFloat(const vr_packArg<REALTYPE, 3> &p)
-      : arg1(REALTYPE(float(p.arg1))), arg2(REALTYPE(float(p.arg2))),
-        arg3(REALTYPE(float(p.arg3))) {}
+      : arg1(vr_toFloatValue(p.arg1)), arg2(vr_toFloatValue(p.arg2)),
+        arg3(vr_toFloatValue(p.arg3)) {}
   vr_packArg<REALTYPE, 3> getPack() const {
     return vr_packArg<REALTYPE, 3>(arg1, arg2, arg3);
   }
@@ -244,7 +343,8 @@ public:
     return p.isOneArgNanInf();
   }
 
-  static inline __m128i areInfNotSpecificToNearest(const PackArgs &p) {
+  static inline typename vr_laneMask<RealType>::type
+  areInfNotSpecificToNearest(const PackArgs &p) {
     return p.hasOneArgNanInf();
   }
 
@@ -286,7 +386,8 @@ public:
     return p.isOneArgNanInf();
   }
 
-  static inline __m128i areInfNotSpecificToNearest(const PackArgs &p) {
+  static inline typename vr_laneMask<RealType>::type
+  areInfNotSpecificToNearest(const PackArgs &p) {
     return p.hasOneArgNanInf();
   }
 
@@ -372,7 +473,8 @@ public:
     return p.isOneArgNanInf();
   }
 
-  static inline __m128i areInfNotSpecificToNearest(const PackArgs &p) {
+  static inline typename vr_laneMask<RealType>::type
+  areInfNotSpecificToNearest(const PackArgs &p) {
     return p.hasOneArgNanInf();
   }
 
@@ -403,11 +505,9 @@ public:
     return a * b;
   };
 
+  // the residual of the double product, exact, rounded once as by the fma
   static inline RealType error(const PackArgs &p, const RealType &x) {
-    /*Provient de "Accurate Sum and dot product" OGITA RUMP OISHI */
-    const RealType a(p.arg1);
-    const RealType b(p.arg2);
-    return __verrou_internal_fma(a, b, -x);
+    return (float)((double)p.arg1 * (double)p.arg2 - (double)x);
   };
 
   static inline void split(RealType a, RealType &x, RealType &y) {
@@ -419,15 +519,7 @@ public:
   }
 
   static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
-    double res = MulOp<double>::error(
-        vr_packArg<double, 2>((double)p.arg1, (double)p.arg2), (double)c);
-    if (res < 0) {
-      return -1;
-    }
-    if (res > 0) {
-      return 1;
-    }
-    return 0.;
+    return vr_floatSign((double)p.arg1 * (double)p.arg2 - (double)c);
   };
 
   static inline const PackArgs comdetPack(const PackArgs &p) {
@@ -469,13 +561,21 @@ public:
   static inline RealType error(const PackArgs &p, const RealType &c) {
     const RealType &x(p.arg1);
     const RealType &y(p.arg2);
-    return -__verrou_internal_fma(c, y, -x);
+    return -__verrou_internal_fma(c, y, -x) / y;
   };
 
+  // the error is the residual x-c*y divided by y: its sign depends on y
   static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
     const RealType &x(p.arg1);
     const RealType &y(p.arg2);
-    return -__verrou_internal_fma(c, y, -x);
+    const RealType r = -__verrou_internal_fma(c, y, -x);
+    if (r > 0) {
+      return y;
+    } else if (r < 0) {
+      return -y;
+    } else {
+      return 0.0;
+    }
   };
 
   static inline const PackArgs comdetPack(const PackArgs &p) { return p; }
@@ -505,16 +605,17 @@ public:
     return a / b;
   };
 
+  // the residual x-c*y is exact in double
+  static inline double residual(const PackArgs &p, const RealType &c) {
+    return (double)p.arg1 - (double)c * (double)p.arg2;
+  }
+
   static inline RealType error(const PackArgs &p, const RealType &c) {
-    const RealType &x(p.arg1);
-    const RealType &y(p.arg2);
-    return -__verrou_internal_fma(c, y, -x) / y;
+    return (float)residual(p, c) / p.arg2;
   };
 
   static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
-    const double x((double)p.arg1);
-    const double y((double)p.arg2);
-    const double r = -__verrou_internal_fma((double)c, y, -x);
+    const double r = residual(p, c);
     if (r > 0) {
       return p.arg2;
     } else if (r < 0) {
@@ -583,8 +684,36 @@ public:
   static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
     return p.isOneArgNanInf();
   }
+
+  static inline typename vr_laneMask<RealType>::type
+  areInfNotSpecificToNearest(const PackArgs &p) {
+    return p.hasOneArgNanInf();
+  }
 };
 
+template <>
+inline float MAddOp<float>::nearestOp(const PackArgs &p) {
+  double s, e;
+  vr_floatMAdd(p.arg1, p.arg2, p.arg3, s, e);
+  return vr_floatRoundOdd(s, e);
+}
+
+// z is within a factor of 2 of s: s-z is exact
+template <>
+inline float MAddOp<float>::error(const PackArgs &p, const float &z) {
+  double s, e;
+  vr_floatMAdd(p.arg1, p.arg2, p.arg3, s, e);
+  return (float)((s - (double)z) + e);
+}
+
+// the sign of the double error, which does not underflow
+template <>
+inline float MAddOp<float>::sameSignOfError(const PackArgs &p, const float &c) {
+  double s, e;
+  vr_floatMAdd(p.arg1, p.arg2, p.arg3, s, e);
+  return vr_floatSign((s - (double)c) + e);
+}
+
 template <typename REALINPUT, typename REALOUTPUT> class CastOp {
 public:
   typedef REALINPUT RealTypeIn;
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <new>
+#include <stdint.h>
+#include <type_traits>
+
+#include "interflop/interflop_stdlib.h"
+#include "interflop/prng/vr_rand.h"
+#include "interflop_verrou.h"
+
+/*
+ * Counters of --profile-exact: number of operations and of exact operations,
+ * by operation and type. Each thread increments its own block, padded to a
+ * cache line, with relaxed loads and stores: no lock and no false sharing on
+ * the hot path. The blocks are registered on first use in a lock-free list
+ * and never freed, so that the counts of finished threads are kept;
+ * vr_profiling_sum adds them up on demand.
+ */
+typedef struct Vr_ProfCounters_ {
+  std::atomic<uint64_t> numOp[VR_PROF_NB_OP][VR_PROF_NB_TYPE];
+  std::atomic<uint64_t> numExactOp[VR_PROF_NB_OP][VR_PROF_NB_TYPE];
+  struct Vr_ProfCounters_ *next;
+} __attribute__((aligned(64))) Vr_ProfCounters;
+
+/*
+ * Histograms of --profile-error, in the same way as Vr_ProfCounters: a block
+ * per thread, allocated on its first profiled operation only.
+ */
+typedef struct Vr_ProfHistograms_ {
+  std::atomic<uint64_t> error[VR_PROF_NB_OP][VR_PROF_NB_TYPE]
+                             [VR_PROF_NB_ERROR_BUCKET];
+  std::atomic<uint64_t> exponent[VR_PROF_NB_OP][VR_PROF_NB_TYPE]
+                                [VR_PROF_NB_EXP_BUCKET];
+  struct Vr_ProfHistograms_ *next;
+} __attribute__((aligned(64))) Vr_ProfHistograms;
+
+// defined in interflop_verrou.cxx, with C linkage as vr_hashTables
+extern "C" TLS Vr_ProfCounters *vr_profCounters;
+extern "C" TLS Vr_ProfHistograms *vr_profHistograms;
+extern "C" std::atomic<Vr_ProfCounters *> vr_profList;
+extern "C" std::atomic<Vr_ProfHistograms *> vr_profHistList;
+
+// the helpers run on each profiled operation, registering a block does not
+#define VR_PROF_INLINE inline __attribute__((always_inline))
+
+/* a zeroed block, pushed on list */
+template <class BLOCK>
+__attribute__((noinline)) BLOCK *
+vr_profiling_register(std::atomic<BLOCK *> &list) {
+  void *mem = interflop_malloc(sizeof(BLOCK) + 63);
+  BLOCK *c = new ((void *)(((uintptr_t)mem + 63) & ~(uintptr_t)63)) BLOCK;
+  memset((void *)c, 0, sizeof(BLOCK));
+  c->next = list.load(std::memory_order_relaxed);
+  while (!list.compare_exchange_weak(c->next, c, std::memory_order_release,
+                                     std::memory_order_relaxed))
+    ;
+  return c;
+}
+
+VR_PROF_INLINE Vr_ProfCounters *vr_profiling_get() {
+  if (__builtin_expect(vr_profCounters == nullptr, 0))
+    vr_profCounters = vr_profiling_register(vr_profList);
+  return vr_profCounters;
+}
+
+VR_PROF_INLINE Vr_ProfHistograms *vr_profiling_getHistograms() {
+  if (__builtin_expect(vr_profHistograms == nullptr, 0))
+    vr_profHistograms = vr_profiling_register(vr_profHistList);
+  return vr_profHistograms;
+}
+
+// only the owner thread writes a counter
+VR_PROF_INLINE void vr_profiling_add(std::atomic<uint64_t> &counter,
+                                     uint64_t n) {
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+/* the blocks of all the threads, finished ones included */
+inline void vr_profiling_sum(verrou_profiling_t *prof) {
+  for (int op = 0; op < VR_PROF_NB_OP; op++) {
+    for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+      prof->numOp[op][type] = 0;
+      prof->numExactOp[op][type] = 0;
+    }
+  }
+  for (Vr_ProfCounters *c = vr_profList.load(std::memory_order_acquire);
+       c != nullptr; c = c->next) {
+    for (int op = 0; op < VR_PROF_NB_OP; op++) {
+      for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+        prof->numOp[op][type] +=
+            c->numOp[op][type].load(std::memory_order_relaxed);
+        prof->numExactOp[op][type] +=
+            c->numExactOp[op][type].load(std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+inline void vr_profiling_sumHistograms(verrou_error_histograms_t *hist) {
+  memset((void *)hist, 0, sizeof(verrou_error_histograms_t));
+  for (Vr_ProfHistograms *c = vr_profHistList.load(std::memory_order_acquire);
+       c != nullptr; c = c->next) {
+    for (int op = 0; op < VR_PROF_NB_OP; op++) {
+      for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+        for (int b = 0; b < VR_PROF_NB_ERROR_BUCKET; b++)
+          hist->error[op][type][b] +=
+              c->error[op][type][b].load(std::memory_order_relaxed);
+        for (int b = 0; b < VR_PROF_NB_EXP_BUCKET; b++)
+          hist->exponent[op][type][b] +=
+              c->exponent[op][type][b].load(std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+/* operations still running in other threads may be counted after a reset */
+inline void vr_profiling_reset() {
+  for (Vr_ProfCounters *c = vr_profList.load(std::memory_order_acquire);
+       c != nullptr; c = c->next) {
+    for (int op = 0; op < VR_PROF_NB_OP; op++) {
+      for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+        c->numOp[op][type].store(0, std::memory_order_relaxed);
+        c->numExactOp[op][type].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+  for (Vr_ProfHistograms *c = vr_profHistList.load(std::memory_order_acquire);
+       c != nullptr; c = c->next) {
+    for (int op = 0; op < VR_PROF_NB_OP; op++) {
+      for (int type = 0; type < VR_PROF_NB_TYPE; type++) {
+        for (int b = 0; b < VR_PROF_NB_ERROR_BUCKET; b++)
+          c->error[op][type][b].store(0, std::memory_order_relaxed);
+        for (int b = 0; b < VR_PROF_NB_EXP_BUCKET; b++)
+          c->exponent[op][type][b].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+/* counter of an operation class, scalar or vector */
+template <class OP> struct vr_profOp;
+template <typename> class AddOp;
+template <typename> class SubOp;
+template <typename> class MulOp;
+template <typename> class DivOp;
+template <typename> class MAddOp;
+template <typename, typename> class CastOp;
+template <class T> struct vr_profOp<AddOp<T>> {
+  static const enum vr_ProfOp value = VR_PROF_ADD;
+};
+template <class T> struct vr_profOp<SubOp<T>> {
+  static const enum vr_ProfOp value = VR_PROF_SUB;
+};
+template <class T> struct vr_profOp<MulOp<T>> {
+  static const enum vr_ProfOp value = VR_PROF_MUL;
+};
+template <class T> struct vr_profOp<DivOp<T>> {
+  static const enum vr_ProfOp value = VR_PROF_DIV;
+};
+template <class T> struct vr_profOp<MAddOp<T>> {
+  static const enum vr_ProfOp value = VR_PROF_MADD;
+};
+template <class I, class O> struct vr_profOp<CastOp<I, O>> {
+  static const enum vr_ProfOp value = VR_PROF_CAST;
+};
+
+/* type of a result, of its lanes for a vector one */
+template <class REALTYPE> struct vr_profType;
+template <> struct vr_profType<float> {
+  typedef float ScalarType;
+  static const enum vr_ProfType value = VR_PROF_FLOAT;
+};
+template <> struct vr_profType<double> {
+  typedef double ScalarType;
+  static const enum vr_ProfType value = VR_PROF_DOUBLE;
+};
+// the attributes of the vector types do not matter to a tag
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+template <> struct vr_profType<__m128> : vr_profType<float> {};
+template <> struct vr_profType<__m256> : vr_profType<float> {};
+template <> struct vr_profType<__m512> : vr_profType<float> {};
+template <> struct vr_profType<__m128d> : vr_profType<double> {};
+template <> struct vr_profType<__m256d> : vr_profType<double> {};
+template <> struct vr_profType<__m512d> : vr_profType<double> {};
+#pragma GCC diagnostic pop
+
+// a vector operation counts for each lane
+template <class OP> VR_PROF_INLINE void vr_profiling_incOp() {
+  typedef typename OP::RealType RealType;
+  typedef vr_profType<RealType> T;
+  vr_profiling_add(
+      vr_profiling_get()->numOp[vr_profOp<OP>::value][T::value],
+      sizeof(RealType) / sizeof(typename T::ScalarType));
+}
+
+template <class OP>
+VR_PROF_INLINE void vr_profiling_incExactOp(uint64_t n = 1) {
+  typedef typename OP::RealType RealType;
+  typedef vr_profType<RealType> T;
+  vr_profiling_add(
+      vr_profiling_get()->numExactOp[vr_profOp<OP>::value][T::value], n);
+}
+
+/*
+ * exponent of x, [2^e, 2^(e+1)): max_exponent for an infinity or a NaN and
+ * an arbitrary value for 0. Only subnormals branch, a zero result or error
+ * does not.
+ */
+template <class REAL> VR_PROF_INLINE int vr_profExponent(REAL x) {
+  typedef std::numeric_limits<REAL> L;
+  typedef typename std::conditional<sizeof(REAL) == 8, uint64_t,
+                                    uint32_t>::type Bits;
+  const int mantBits = L::digits - 1;
+  const int expMask = (1 << (sizeof(REAL) * 8 - 1 - mantBits)) - 1;
+  Bits bits;
+  memcpy(&bits, &x, sizeof(REAL));
+  const Bits abs2 = bits << 1; // without the sign
+  if (__builtin_expect((Bits)(abs2 - 1) < ((Bits)2 << mantBits) - 1, 0))
+    return std::ilogb(x); // subnormal
+  return ((int)(bits >> mantBits) & expMask) - (L::max_exponent - 1);
+}
+
+/* histograms of a scalar result rounded to nearest and of its error */
+template <class OP, class REAL>
+VR_PROF_INLINE void vr_profiling_addError(REAL res, REAL error) {
+  typedef std::numeric_limits<REAL> L;
+  const int expRes = vr_profExponent(res);
+  const int expError = vr_profExponent(error);
+  if (expRes >= L::max_exponent || expError >= L::max_exponent)
+    return;
+  Vr_ProfHistograms *h = vr_profiling_getHistograms();
+  const int op = vr_profOp<OP>::value;
+  const int type = vr_profType<REAL>::value;
+
+  const int expBucket = (res == 0) ? 0 : expRes - VR_PROF_EXP_BUCKET_MIN;
+  vr_profiling_add(h->exponent[op][type][expBucket], 1);
+
+  // the ulp of res is a power of 2: the bucket is an exponent difference
+  const int denormExp = L::min_exponent - L::digits;
+  const int expUlp = std::max(expRes - (L::digits - 1), denormExp);
+  const int errBucket =
+      std::min(std::max(expUlp - expError, 1), VR_PROF_NB_ERROR_BUCKET - 1);
+  vr_profiling_add(h->error[op][type][(error == 0) ? 0 : errBucket], 1);
+}
+
+/*
+ * Profiling policies of the Rounding classes, selected at initialization
+ * with --profile-exact and --profile-error: vr_noProf compiles to nothing.
+ */
+struct vr_noProf {
+  template <class OP> static inline void incOp() {}
+  template <class OP> static inline void incExactOp(uint64_t = 1) {}
+  template <class OP, class PACK, class REAL>
+  static inline void incError(const PACK &, const REAL &) {}
+};
+
+struct vr_profExact {
+  template <class OP> static inline void incOp() { vr_profiling_incOp<OP>(); }
+  template <class OP> static inline void incExactOp(uint64_t n = 1) {
+    vr_profiling_incExactOp<OP>(n);
+  }
+  template <class OP, class PACK, class REAL>
+  static inline void incError(const PACK &, const REAL &) {}
+};
+
+// the counters of vr_profExact, and the histograms of each lane
+struct vr_profError : vr_profExact {
+  template <class OP, class PACK, class REAL>
+  static inline void incError(const PACK &p, const REAL &res) {
+    typedef typename vr_profType<REAL>::ScalarType ScalarType;
+    const int nbLanes = sizeof(REAL) / sizeof(ScalarType);
+    const REAL error = OP::error(p, res);
+    ScalarType laneRes[nbLanes], laneError[nbLanes];
+    memcpy(laneRes, &res, sizeof(REAL));
+    memcpy(laneError, &error, sizeof(REAL));
+    for (int i = 0; i < nbLanes; i++)
+      vr_profiling_addError<OP>(laneRes[i], laneError[i]);
+  }
+};
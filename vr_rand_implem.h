@@ -32,6 +32,7 @@
 #pragma once
 // Warning FILE include in vr_rand.h
 #include "interflop/prng/vr_rand.h"
+#include "interflop_verrou.h"
 
 #ifndef USE_XOSHIRO
 #include "interflop/prng/tinymt64.h"
@@ -39,10 +40,15 @@
 #include "interflop/prng/xoshiro.hxx"
 #endif
 
+#ifndef VERROU_DET_HASH
+#error "VERROU_DET_HASH has to be defined"
+#endif
+
 inline uint64_t vr_rand_getSeed(const Vr_Rand *r);
 
 #include "dietzfelbingerHash.hxx"
 #include "mersenneHash.hxx"
+#include "mix64Hash.hxx"
 #include "multiplyShiftHash.hxx"
 #include "tableHash.hxx"
 
@@ -67,15 +73,42 @@ inline void vr_rand_setSeed(Vr_Rand *r, int seed) {
   init_xoshiro256_state(r->rng256_, r->seed_);
 #endif
   r->current_ = vr_rand_next(r);
-  vr_tabulation_hash::genTable((r->gen_));
-  //  vr_twisted_tabulation_hash::genTable((r->gen_));
-  vr_multiply_shift_hash::genTable((r->gen_));
   const double p = tinymt64_generate_double(&(r->gen_));
   r->p = p;
+  // the det hash tables of the thread are rebuilt on first use, from seed
+  if (!vr_hashTables.seeded_ || vr_hashTables.seed_ != r->seed_) {
+    vr_hashTables.seed_ = r->seed_;
+    vr_hashTables.seeded_ = true;
+    vr_hashTables.ready_ = 0;
+  }
 }
 
 inline uint64_t vr_rand_getSeed(const Vr_Rand *r) { return r->seed_; }
 
+/*
+ * Builds the tables of the calling thread, from the seed of its last
+ * vr_rand_setSeed, or vr_hashTablesSeed. Out of line: it runs once per table
+ * and seed.
+ */
+__attribute__((noinline)) inline void vr_hashTables_build(unsigned tables) {
+  if (!vr_hashTables.seeded_) {
+    vr_hashTables.seed_ = (uint64_t)(int)vr_hashTablesSeed;
+    vr_hashTables.seeded_ = true;
+  }
+  const uint64_t key = vr_hashTables_draw(vr_hashTables.seed_, 0);
+  if (tables & ~vr_hashTables.ready_ & VR_HASH_TABLES_TABULATION)
+    vr_tabulation_hash::genTable(key, vr_hashTables);
+  if (tables & ~vr_hashTables.ready_ & VR_HASH_TABLES_MULTIPLY_SHIFT)
+    vr_multiply_shift_hash::genTable(key, vr_hashTables);
+  vr_hashTables.ready_ |= tables;
+}
+
+template <unsigned TABLES> inline const Vr_HashTables &vr_hashTables_get() {
+  if (__builtin_expect((vr_hashTables.ready_ & TABLES) != TABLES, 0))
+    vr_hashTables_build(TABLES);
+  return vr_hashTables;
+}
+
 inline bool vr_rand_bool(Vr_Rand *r) {
   if (r->count_ == vr_loop()) {
     r->current_ = vr_rand_next(r);
@@ -197,55 +230,55 @@ public:
  * produces a pseudo random number in a deterministic way
  * the same seed and inputs will always produce the same output
  */
-template <class OP> class vr_rand_det {
+template <class OP, class HASH = VERROU_DET_HASH> class vr_rand_det {
 public:
   static inline bool randBool(const Vr_Rand *r,
                               const typename OP::PackArgs &p) {
-#ifdef VERROU_DET_HASH
-    typedef VERROU_DET_HASH hash;
-    return hash::hashBool(r, p, OP::getHash());
-#else
-#error "VERROU_DET_HASH has to be defined"
-#endif
+    return HASH::hashBool(r, p, OP::getHash());
   }
 
   static inline const typename OP::RealType
   randRatio(const Vr_Rand *r, const typename OP::PackArgs &p) {
-#ifdef VERROU_DET_HASH
-    typedef VERROU_DET_HASH hash;
-    return hash::hashRatio(r, p, OP::getHash());
-#else
-#error "VERROU_DET_HASH has to be defined"
-#endif
+    return HASH::hashRatio(r, p, OP::getHash());
   }
 };
 
+template <typename REAL> class SubOp;
+
+/*
+ * Arguments hashed by vr_rand_comdet. comdetPack returns references: for
+ * SubOp they would refer to the temporary -arg2, which is kept here instead.
+ */
+template <class OP> struct vr_comdetPack {
+  vr_comdetPack(const typename OP::PackArgs &p) : pack(OP::comdetPack(p)) {}
+  const typename OP::PackArgs pack;
+};
+
+template <typename REAL> struct vr_comdetPack<SubOp<REAL>> {
+  vr_comdetPack(const vr_packArg<REAL, 2> &p)
+      : negArg2(-p.arg2), pack(std::min(p.arg1, negArg2),
+                               std::max(p.arg1, negArg2)) {}
+  const REAL negArg2;
+  const vr_packArg<REAL, 2> pack;
+};
+
 /*
  * produces a pseudo random number in a deterministic way
  * the same seed and inputs will always produce the same output
  * if the opertor is commutative the order is not taken into account
  */
-template <class OP> class vr_rand_comdet {
+template <class OP, class HASH = VERROU_DET_HASH> class vr_rand_comdet {
 public:
   static inline bool randBool(const Vr_Rand *r,
                               const typename OP::PackArgs &p) {
-
-#ifdef VERROU_DET_HASH
-    typedef VERROU_DET_HASH hash;
-    return hash::hashBool(r, OP::comdetPack(p), OP::getComdetHash());
-#else
-#error "VERROU_DET_HASH has to be defined"
-#endif
+    const vr_comdetPack<OP> comdet(p);
+    return HASH::hashBool(r, comdet.pack, OP::getComdetHash());
   }
 
   static inline const typename OP::RealType
   randRatio(const Vr_Rand *r, const typename OP::PackArgs &p) {
-#ifdef VERROU_DET_HASH
-    typedef VERROU_DET_HASH hash;
-    return hash::hashRatio(r, OP::comdetPack(p), OP::getComdetHash());
-#else
-#error "VERROU_DET_HASH has to be defined"
-#endif
+    const vr_comdetPack<OP> comdet(p);
+    return HASH::hashRatio(r, comdet.pack, OP::getComdetHash());
   }
 };
 
@@ -255,3 +288,61 @@ public:
     return RAND<OP>::randRatio(r, args) < (r->p);
   }
 };
+
+/*
+ * The det and comdet policies bound to one hash, and vr_rand_p bound to one
+ * RAND, where a template <class OP> class is expected (StaticRounding, ...)
+ */
+template <class HASH> struct vr_rand_hash {
+  template <class OP> using det = vr_rand_det<OP, HASH>;
+  template <class OP> using comdet = vr_rand_comdet<OP, HASH>;
+};
+
+template <template <class> class RAND> struct vr_rand_pOf {
+  template <class OP> using type = vr_rand_p<OP, RAND>;
+};
+
+/*
+ * Runtime choice of the det hash (--det-hash): F<HASH>::apply(args...) for
+ * the selected hash. Called once per operation in the dynamic backend, and
+ * once at initialization in the static one.
+ */
+template <template <class> class F, class... ARGS>
+inline auto vr_detHashDispatch(enum vr_DetHash hash, ARGS &&...args) {
+  switch (hash) {
+  case VR_DET_HASH_DOUBLE_TABULATION:
+    return F<vr_double_tabulation_hash>::apply(args...);
+  case VR_DET_HASH_TABULATION:
+    return F<vr_tabulation_hash>::apply(args...);
+  case VR_DET_HASH_MULTIPLY_SHIFT:
+    return F<vr_multiply_shift_hash>::apply(args...);
+  case VR_DET_HASH_DIETZFELBINGER:
+    return F<vr_dietzfelbinger_hash>::apply(args...);
+  case VR_DET_HASH_MERSENNE_TWISTER:
+    return F<vr_mersenne_twister_hash>::apply(args...);
+  case VR_DET_HASH_MIX64:
+    return F<vr_mix64_hash>::apply(args...);
+  }
+  return F<VERROU_DET_HASH>::apply(args...);
+}
+
+// enum value of the hash chosen at build time, the default of --det-hash
+template <class HASH> struct vr_detHashId;
+template <> struct vr_detHashId<vr_double_tabulation_hash> {
+  static const enum vr_DetHash value = VR_DET_HASH_DOUBLE_TABULATION;
+};
+template <> struct vr_detHashId<vr_tabulation_hash> {
+  static const enum vr_DetHash value = VR_DET_HASH_TABULATION;
+};
+template <> struct vr_detHashId<vr_multiply_shift_hash> {
+  static const enum vr_DetHash value = VR_DET_HASH_MULTIPLY_SHIFT;
+};
+template <> struct vr_detHashId<vr_dietzfelbinger_hash> {
+  static const enum vr_DetHash value = VR_DET_HASH_DIETZFELBINGER;
+};
+template <> struct vr_detHashId<vr_mersenne_twister_hash> {
+  static const enum vr_DetHash value = VR_DET_HASH_MERSENNE_TWISTER;
+};
+template <> struct vr_detHashId<vr_mix64_hash> {
+  static const enum vr_DetHash value = VR_DET_HASH_MIX64;
+};
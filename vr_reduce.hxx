@@ -0,0 +1,327 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "interflop/interflop_stdlib.h"
+#include "vr_rand_implem.h"
+#include "vr_region.hxx"
+#include "x86_64/vr_vrand.hxx"
+
+/*
+ * Reductions of verrou_sum, verrou_dot and verrou_nrm2. The input is cut into
+ * blocks of VR_REDUCE_BLOCK elements, each one reduced from zero into a
+ * partial, and the partials are summed by the pairwise tree of the blocks:
+ * the operations and their order only depend on n. The blocks are shared
+ * among the threads by contiguous ranges, and each range leaves the roots of
+ * its complete subtrees in a Vr_ReduceTree, which the caller merges in order.
+ * Whatever the number of threads, the det and comdet modes give the same
+ * bits.
+ *
+ * The threads are the workers of a pool, started by interflop_verrou_init
+ * and joined by finalize: a worker keeps its profiling counters and its det
+ * hash tables from one reduction to the next. It starts from the rounding
+ * state of the caller: its region, and its generator, so that the det and
+ * comdet modes hash with the same seed. In the random modes, each worker is
+ * instead seeded with a draw of the caller, so that it does not repeat the
+ * random bits of the caller. The caller reduces every block without
+ * RNG_THREAD_SAFE, where this state is shared, while another thread uses the
+ * pool, and in a process forked after init, as the samples, which have no
+ * workers.
+ */
+#define VR_REDUCE_BLOCK 4096
+#define VR_REDUCE_MIN_BLOCKS 16 // per thread
+#define VR_REDUCE_MAX_THREADS 64
+
+/* roots of the complete subtrees of the blocks reduced so far, the last
+   one rightmost */
+template <class T> struct Vr_ReduceTree {
+  T value[64];
+  size_t first[64]; // block
+  int level[64];    // of 2^level blocks
+  int size;
+};
+
+/* adds the subtree of 2^level blocks from first, which follows the others,
+   merging it with the left siblings */
+template <class T, class ADD>
+static inline void vr_reduceTree_push(Vr_ReduceTree<T> *tree, T value,
+                                      size_t first, int level, ADD add) {
+  while (tree->size > 0) {
+    const int top = tree->size - 1;
+    if (tree->level[top] != level || ((tree->first[top] >> level) & 1))
+      break;
+    value = add(tree->value[top], value);
+    first = tree->first[top];
+    level++;
+    tree->size--;
+  }
+  tree->value[tree->size] = value;
+  tree->first[tree->size] = first;
+  tree->level[tree->size] = level;
+  tree->size++;
+}
+
+/* sum of the roots, the smallest subtrees first: the root of the tree */
+template <class T, class ADD>
+static inline T vr_reduceTree_root(const Vr_ReduceTree<T> *tree, ADD add) {
+  if (tree->size == 0)
+    return 0;
+  T value = tree->value[tree->size - 1];
+  for (int i = tree->size - 2; i >= 0; i--)
+    value = add(tree->value[i], value);
+  return value;
+}
+
+/* rounding state handed by the caller to a worker */
+typedef struct {
+  const Vr_Region *region;
+  Vr_Rand rand;
+  Vr_VRand vrand;
+  uint64_t hashSeed;
+  bool hashSeeded;
+  bool reseed; // random modes: seed the worker with seed
+  uint64_t seed;
+} Vr_ReduceState;
+
+static inline bool vr_reduce_randomMode(enum vr_RoundingMode mode) {
+  return mode == VR_RANDOM || mode == VR_AVERAGE || mode == VR_PRANDOM;
+}
+
+static inline void vr_reduce_saveState(Vr_ReduceState *state,
+                                       enum vr_RoundingMode mode) {
+  state->region = vr_region;
+  state->rand = vr_rand;
+  state->vrand = vr_vrand;
+  state->hashSeed = vr_hashTables.seed_;
+  state->hashSeeded = vr_hashTables.seeded_;
+  state->reseed = vr_reduce_randomMode(mode);
+  state->seed = state->reseed ? vr_rand_next(&vr_rand) : 0;
+}
+
+static inline void vr_reduce_loadState(const Vr_ReduceState *state) {
+  vr_region = state->region;
+  vr_rand = state->rand;
+  vr_vrand = state->vrand;
+  // the tables of the previous reduction serve while the seed is the same
+  if (vr_hashTables.seeded_ != state->hashSeeded ||
+      vr_hashTables.seed_ != state->hashSeed) {
+    vr_hashTables.seed_ = state->hashSeed;
+    vr_hashTables.seeded_ = state->hashSeeded;
+    vr_hashTables.ready_ = 0;
+  }
+  if (state->reseed) {
+    vr_rand_setSeed(&vr_rand, (int)state->seed);
+    vr_rand.p = state->rand.p; // prandom keeps the p of the caller
+    vr_vrand_setSeed(&vr_vrand, state->seed);
+  }
+}
+
+/* blocks [first, last) of a reduction, with block(blockFn, b) the partial of
+   block b and add(addFn, ...) the sum of two partials */
+template <class T> struct Vr_ReduceJob {
+  T (*block)(const void *blockFn, size_t b);
+  T (*add)(const void *addFn, T a, T b);
+  const void *blockFn;
+  const void *addFn;
+  size_t first, last;
+  Vr_ReduceState state;
+  Vr_ReduceTree<T> tree;
+};
+
+template <class T> static inline void vr_reduce_run(Vr_ReduceJob<T> *job) {
+  const auto add = [job](T a, T b) { return job->add(job->addFn, a, b); };
+  job->tree.size = 0;
+  for (size_t b = job->first; b < job->last; b++)
+    vr_reduceTree_push(&job->tree, job->block(job->blockFn, b), b, 0, add);
+}
+
+template <class T> static void vr_reduce_worker(void *arg) {
+  Vr_ReduceJob<T> *job = (Vr_ReduceJob<T> *)arg;
+  vr_reduce_loadState(&job->state);
+  vr_reduce_run(job);
+}
+
+#ifdef RNG_THREAD_SAFE
+typedef struct {
+  pthread_t id;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  void (*run)(void *job); // NULL when idle
+  void *job;
+  bool stop;
+} Vr_ReduceWorker;
+
+typedef struct {
+  pthread_mutex_t busy; // held by the reduction which uses the workers
+  Vr_ReduceWorker workers[VR_REDUCE_MAX_THREADS - 1];
+  unsigned int size; // started workers
+  pid_t pid;         // of the process which started them
+} Vr_ReducePool;
+
+inline Vr_ReducePool vr_reducePool = {PTHREAD_MUTEX_INITIALIZER, {}, 0, 0};
+
+/* the jobs of the workers, used under vr_reducePool.busy */
+template <class T>
+inline Vr_ReduceJob<T> vr_reduceJobs[VR_REDUCE_MAX_THREADS - 1];
+
+static void *vr_reducePool_loop(void *arg) {
+  Vr_ReduceWorker *w = (Vr_ReduceWorker *)arg;
+  pthread_mutex_lock(&w->mutex);
+  while (true) {
+    while (w->run == NULL && !w->stop)
+      pthread_cond_wait(&w->cond, &w->mutex);
+    if (w->run == NULL)
+      break;
+    pthread_mutex_unlock(&w->mutex);
+    w->run(w->job);
+    pthread_mutex_lock(&w->mutex);
+    w->run = NULL;
+    pthread_cond_broadcast(&w->cond);
+  }
+  pthread_mutex_unlock(&w->mutex);
+  return NULL;
+}
+
+static inline void vr_reducePool_submit(Vr_ReduceWorker *w,
+                                        void (*run)(void *), void *job) {
+  pthread_mutex_lock(&w->mutex);
+  w->run = run;
+  w->job = job;
+  pthread_cond_broadcast(&w->cond);
+  pthread_mutex_unlock(&w->mutex);
+}
+
+static inline void vr_reducePool_wait(Vr_ReduceWorker *w) {
+  pthread_mutex_lock(&w->mutex);
+  while (w->run != NULL)
+    pthread_cond_wait(&w->cond, &w->mutex);
+  pthread_mutex_unlock(&w->mutex);
+}
+
+static inline void vr_reducePool_stop() {
+  if (vr_reducePool.pid != getpid()) {
+    // forked: the workers are those of the parent
+    vr_reducePool.size = 0;
+    return;
+  }
+  pthread_mutex_lock(&vr_reducePool.busy);
+  for (unsigned int i = 0; i < vr_reducePool.size; i++) {
+    Vr_ReduceWorker *w = &vr_reducePool.workers[i];
+    pthread_mutex_lock(&w->mutex);
+    w->stop = true;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->mutex);
+    pthread_join(w->id, NULL);
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->mutex);
+  }
+  vr_reducePool.size = 0;
+  pthread_mutex_unlock(&vr_reducePool.busy);
+}
+
+/* threads - 1 workers, with threads 0 for the online CPUs: the caller is the
+   first thread. Keeps the workers already started with that count. */
+static inline void vr_reducePool_start(unsigned int threads) {
+  if (threads == 0)
+    threads = (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > VR_REDUCE_MAX_THREADS)
+    threads = VR_REDUCE_MAX_THREADS;
+  const unsigned int size = (threads > 0) ? threads - 1 : 0;
+  if (vr_reducePool.pid == getpid() && vr_reducePool.size == size)
+    return;
+  vr_reducePool_stop();
+  if (vr_reducePool.pid != getpid())
+    pthread_mutex_init(&vr_reducePool.busy, NULL);
+  vr_reducePool.pid = getpid();
+  for (unsigned int i = 0; i < size; i++) {
+    Vr_ReduceWorker *w = &vr_reducePool.workers[i];
+    pthread_mutex_init(&w->mutex, NULL);
+    pthread_cond_init(&w->cond, NULL);
+    w->run = NULL;
+    w->stop = false;
+    if (pthread_create(&w->id, NULL, vr_reducePool_loop, w) != 0) {
+      pthread_cond_destroy(&w->cond);
+      pthread_mutex_destroy(&w->mutex);
+      break; // the started ones serve
+    }
+    vr_reducePool.size++;
+  }
+}
+
+/* the number of workers of the calling reduction, which holds the pool when
+   it is not 0 */
+static inline unsigned int vr_reducePool_acquire() {
+  if (vr_reducePool.size == 0 || vr_reducePool.pid != getpid())
+    return 0;
+  if (pthread_mutex_trylock(&vr_reducePool.busy) != 0)
+    return 0;
+  return vr_reducePool.size;
+}
+
+static inline void vr_reducePool_release() {
+  pthread_mutex_unlock(&vr_reducePool.busy);
+}
+#endif
+
+/* reduction of nbBlocks blocks, by the caller and the workers of the pool */
+template <class T, class BLOCK, class ADD>
+static inline T vr_reduce(size_t nbBlocks, enum vr_RoundingMode mode,
+                          const BLOCK &block, const ADD &add) {
+  Vr_ReduceJob<T> callerJob;
+  Vr_ReduceJob<T> *jobs[VR_REDUCE_MAX_THREADS] = {&callerJob};
+  size_t nbThreads = 1;
+#ifdef RNG_THREAD_SAFE
+  unsigned int workers = 0;
+  if (nbBlocks >= 2 * VR_REDUCE_MIN_BLOCKS)
+    workers = vr_reducePool_acquire();
+  nbThreads = nbBlocks / VR_REDUCE_MIN_BLOCKS;
+  if (nbThreads > workers + 1)
+    nbThreads = workers + 1;
+  if (nbThreads == 0)
+    nbThreads = 1;
+  for (size_t t = 1; t < nbThreads; t++)
+    jobs[t] = &vr_reduceJobs<T>[t - 1];
+#else
+  (void)mode;
+#endif
+  for (size_t t = 0; t < nbThreads; t++) {
+    Vr_ReduceJob<T> *job = jobs[t];
+    job->block = [](const void *fn, size_t b) {
+      return (*(const BLOCK *)fn)(b);
+    };
+    job->add = [](const void *fn, T a, T b) {
+      return (*(const ADD *)fn)(a, b);
+    };
+    job->blockFn = &block;
+    job->addFn = &add;
+    job->first = nbBlocks * t / nbThreads;
+    job->last = nbBlocks * (t + 1) / nbThreads;
+  }
+#ifdef RNG_THREAD_SAFE
+  for (size_t t = 1; t < nbThreads; t++) {
+    vr_reduce_saveState(&jobs[t]->state, mode);
+    vr_reducePool_submit(&vr_reducePool.workers[t - 1], vr_reduce_worker<T>,
+                         jobs[t]);
+  }
+#endif
+  vr_reduce_run(jobs[0]);
+#ifdef RNG_THREAD_SAFE
+  for (size_t t = 1; t < nbThreads; t++)
+    vr_reducePool_wait(&vr_reducePool.workers[t - 1]);
+#endif
+
+  Vr_ReduceTree<T> tree;
+  tree.size = 0;
+  for (size_t t = 0; t < nbThreads; t++)
+    for (int i = 0; i < jobs[t]->tree.size; i++)
+      vr_reduceTree_push(&tree, jobs[t]->tree.value[i], jobs[t]->tree.first[i],
+                         jobs[t]->tree.level[i], add);
+#ifdef RNG_THREAD_SAFE
+  if (workers > 0)
+    vr_reducePool_release();
+#endif
+  return vr_reduceTree_root(&tree, add);
+}
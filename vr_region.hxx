@@ -0,0 +1,48 @@
+#pragma once
+
+#include "interflop/prng/vr_rand.h"
+#include "interflop_verrou.h"
+
+/*
+ * Per-thread rounding regions, pushed and popped with
+ * verrou_push_rounding_mode and verrou_pop_rounding_mode: vr_region is the
+ * innermost region of the thread, NULL outside of them. The dynamic entry
+ * points round with its mode instead of the one of the context. The static
+ * ones, whose mode is fixed, call the static entry point of the region mode,
+ * built by interflop_verrou_init, unless it is themselves. Outside of a
+ * region an operation only pays the load of vr_region, which is initial-exec
+ * TLS. Without RNG_THREAD_SAFE, like the generator, the regions are shared by
+ * all the threads.
+ */
+typedef struct {
+  enum vr_RoundingMode mode;
+  struct interflop_backend_interface_t backend; // with --static-backend
+} Vr_Region;
+
+#ifdef RNG_THREAD_SAFE
+#define VR_REGION_TLS TLS __attribute__((tls_model("initial-exec")))
+#else
+#define VR_REGION_TLS TLS
+#endif
+
+extern "C" VR_REGION_TLS const Vr_Region *vr_region;
+
+/* rounding mode of the dynamic entry points */
+static inline enum vr_RoundingMode
+vr_regionMode(const verrou_context_t *ctx) {
+  const Vr_Region *region = vr_region;
+  if (__builtin_expect(region == nullptr, 1))
+    return ctx->rounding_mode;
+  return region->mode;
+}
+
+/* first statement of the static entry point FN(ARGS) */
+#define VR_REGION_STATIC(FN, ...)                                              \
+  {                                                                            \
+    const Vr_Region *region = vr_region;                                       \
+    if (__builtin_expect(region != nullptr, 0) &&                              \
+        region->backend.interflop_##FN != FN) {                                \
+      region->backend.interflop_##FN(__VA_ARGS__);                             \
+      return;                                                                  \
+    }                                                                          \
+  }
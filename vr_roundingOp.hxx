@@ -32,6 +32,7 @@
 
 #pragma once
 #include <limits>
+#include <type_traits>
 #include <math.h> //pour isinf
 //#ifndef LIBMATHINTERP
 extern vr_RoundingMode ROUNDINGMODE;
@@ -39,26 +40,29 @@ extern vr_RoundingMode ROUNDINGMODE;
 // extern vr_RoundingMode ROUNDINGMODE;
 //#endif
 
-#ifdef PROFILING_EXACT
-extern unsigned int vr_NumOp;
-extern unsigned int vr_NumExactOp;
+// counters of the profiling policy PROF of the Rounding classes
+#include "vr_profiling.hxx"
+#include "vr_region.hxx"
 #define INC_OP                                                                 \
-  { vr_NumOp++; }
+  { PROF::template incOp<OP>(); }
 #define INC_EXACTOP                                                            \
-  { vr_NumExactOp++; }
-#else
-#define INC_OP
-#define INC_EXACTOP
-#endif
+  { PROF::template incExactOp<OP>(); }
+#define INC_VEXACTOP(NB)                                                       \
+  { PROF::template incExactOp<OP>(NB); }
+#define INC_ERROR                                                              \
+  { PROF::template incError<OP>(p, res); }
 
 #include "vr_isNan.hxx"
+#include "vr_naninf.hxx"
 #include "vr_nextUlp.hxx"
 
 #include "interflop/interflop_stdlib.h"
 #include "vr_op.hxx"
 #include "vr_rand_implem.h"
 
-template <class OP, class RAND = void> class RoundingNearest {
+template <class OP, class RAND = void, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingNearest {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -66,11 +70,15 @@ public:
   static inline RealType apply(const PackArgs &p) {
     const RealType res = OP::nearestOp(p);
     OP::check(p, res);
+    INC_ERROR;
+    NANINF::isSpecial(res);
     return res;
   };
 };
 
-template <class OP, class RAND = void> class RoundingFloat {
+template <class OP, class RAND = void, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingFloat {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -78,11 +86,14 @@ public:
   static inline RealType apply(const PackArgs &p) {
     vr_roundFloat<typename PackArgs::RealType, PackArgs::nb> roundedArgs(p);
     const float res = (float)OP::nearestOp(roundedArgs.getPack());
+    NANINF::isSpecial(res);
     return RealType(res);
   };
 };
 
-template <class OP, class RAND> class RoundingRandom {
+template <class OP, class RAND, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingRandom {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -90,33 +101,26 @@ public:
   static inline RealType apply(const PackArgs &p) {
     const RealType res = OP::nearestOp(p);
     INC_OP;
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+    INC_ERROR;
+    if (NANINF::isSpecial(res)) {
       return res;
     }
-#endif
     OP::check(p, res);
     const RealType signError = OP::sameSignOfError(p, res);
 
     if (signError == 0.) {
       INC_EXACTOP;
       return res;
-    } else {
-      const bool doNoChange = RAND::randBool(&vr_rand, p);
-      if (doNoChange) {
-        return res;
-      } else {
-        if (signError > 0) {
-          return nextAfter<RealType>(res);
-        } else {
-          return nextPrev<RealType>(res);
-        }
-      }
     }
+    // only the inexact results draw a bit: that test stays a branch
+    const bool doChange = !RAND::randBool(&vr_rand, p);
+    return nextAfterOrPrevIf<RealType>(res, doChange, signError > 0);
   };
 };
 
-template <class OP, class RAND> class RoundingPRandom {
+template <class OP, class RAND, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingPRandom {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -124,45 +128,29 @@ public:
   static inline RealType apply(const PackArgs &p) {
     const RealType res = OP::nearestOp(p);
     INC_OP;
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+    INC_ERROR;
+    if (NANINF::isSpecial(res)) {
       return res;
     }
-#endif
     OP::check(p, res);
     const RealType signError = OP::sameSignOfError(p, res);
 
     if (signError == 0.) {
       INC_EXACTOP;
       return res;
-    } else {
-      if (signError > 0) {
-        const bool doNoChange = RAND::randBool(&vr_rand, p);
-        if (doNoChange) {
-          return res;
-        } else {
-          if (res > 0) {
-            return nextAwayFromZero<RealType>(res);
-          } else {
-            return nextTowardZero<RealType>(res);
-          }
-        }
-      }
-      const bool doChange = !RAND::randBool(&vr_rand, p);
-      if (doChange) {
-        return res;
-      } else {
-        if (res < 0) {
-          return nextAwayFromZero<RealType>(res);
-        } else {
-          return nextTowardZero<RealType>(res);
-        }
-      }
     }
+    // the bit keeps res for a positive error, and changes it for a negative one
+    const bool up = signError > 0;
+    const bool doChange = RAND::randBool(&vr_rand, p) != up;
+    // on the sign bit: a zero rounded from a tiny result moves away from zero
+    const bool away = up != std::signbit(res);
+    return nextAwayOrTowardIf<RealType>(res, doChange, away);
   };
 };
 
-template <class OP, class RAND> class RoundingAverage {
+template <class OP, class RAND, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingAverage {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -171,11 +159,11 @@ public:
     const RealType res = OP::nearestOp(p);
 
     INC_OP;
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+
+    INC_ERROR;
+    if (NANINF::isSpecial(res)) {
       return res;
     }
-#endif
     OP::check(p, res);
     const RealType error = OP::error(p, res);
     if (error == 0.) {
@@ -211,7 +199,9 @@ public:
   };
 };
 
-template <class OP, class RAND = void> class RoundingZero {
+template <class OP, class RAND = void, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingZero {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -219,10 +209,10 @@ public:
   static inline RealType apply(const PackArgs &p) {
     const RealType res = OP::nearestOp(p);
     INC_OP;
+    INC_ERROR;
     OP::check(p, res);
     const RealType signError = OP::sameSignOfError(p, res);
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+    if (NANINF::isSpecial(res)) {
       if ((res != std::numeric_limits<RealType>::infinity()) &&
           (res != -std::numeric_limits<RealType>::infinity())) {
         return res;
@@ -238,21 +228,19 @@ public:
         }
       }
     }
-#endif
-#ifdef PROFILING_EXACT
     if (signError == 0.) {
       INC_EXACTOP;
     }
-#endif
 
-    if ((signError > 0 && res < 0) || (signError < 0 && res > 0)) {
-      return nextTowardZero<RealType>(res);
-    }
-    return res;
+    const bool doChange =
+        ((signError > 0) & (res < 0)) | ((signError < 0) & (res > 0));
+    return nextAwayOrTowardIf<RealType>(res, doChange, false);
   };
 };
 
-template <class OP, class RAND = void> class RoundingUpward {
+template <class OP, class RAND = void, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingUpward {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -261,8 +249,8 @@ public:
     const RealType res = OP::nearestOp(p);
     OP::check(p, res);
     INC_OP;
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+    INC_ERROR;
+    if (NANINF::isSpecial(res)) {
       if (res != -std::numeric_limits<RealType>::infinity()) {
         return res;
       } else {
@@ -273,28 +261,18 @@ public:
         }
       }
     }
-#endif
     const RealType signError = OP::sameSignOfError(p, res);
-#ifdef PROFILING_EXACT
     if (signError == 0.) {
       INC_EXACTOP;
     }
-#endif
 
-    if (signError > 0.) {
-      if (res == 0.) {
-        return std::numeric_limits<RealType>::denorm_min();
-      }
-      if (res == -std::numeric_limits<RealType>::denorm_min()) {
-        return 0.;
-      }
-      return nextAfter<RealType>(res);
-    }
-    return res;
+    return nextUpIf<RealType>(res, signError > 0.);
   };
 };
 
-template <class OP, class RAND = void> class RoundingDownward {
+template <class OP, class RAND = void, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingDownward {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -303,8 +281,8 @@ public:
     const RealType res = OP::nearestOp(p);
     OP::check(p, res);
     INC_OP;
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+    INC_ERROR;
+    if (NANINF::isSpecial(res)) {
       if (res != std::numeric_limits<RealType>::infinity()) {
         return res;
       } else {
@@ -315,28 +293,19 @@ public:
         }
       }
     }
-#endif
 
     const RealType signError = OP::sameSignOfError(p, res);
-#ifdef PROFILING_EXACT
     if (signError == 0) {
       INC_EXACTOP;
     }
-#endif
-    if (signError < 0) {
-      if (res == 0.) {
-        return -std::numeric_limits<RealType>::denorm_min();
-      }
-      if (res == std::numeric_limits<RealType>::denorm_min()) {
-        return 0.;
-      }
-      return nextPrev<RealType>(res);
-    }
-    return res;
+    // nextPrev(denorm_min) is +0
+    return nextAfterOrPrevIf<RealType>(res, signError < 0, false);
   };
 };
 
-template <class OP, class RAND = void> class RoundingFarthest {
+template <class OP, class RAND = void, class PROF = vr_noProf,
+          class NANINF = vr_naninfNoHandler>
+class RoundingFarthest {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
@@ -344,11 +313,10 @@ public:
   static inline RealType apply(const PackArgs &p) {
     const RealType res = OP::nearestOp(p);
     INC_OP;
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf<RealType>(res)) {
+    INC_ERROR;
+    if (NANINF::isSpecial(res)) {
       return res;
     }
-#endif
     OP::check(p, res);
     const RealType error = OP::error(p, res);
     if (error == 0.) {
@@ -377,26 +345,158 @@ public:
 
 #include "vr_op.hxx"
 
-template <class OP> class OpWithSelectedRoundingMode {
+/*
+ * The rounding mode of the context, or of the region of the thread, applied
+ * to OP with the profiling policy PROF and the NaN and Inf policy NANINF: the
+ * default instantiation switches to the ones of the context for arrays.
+ */
+template <class OP, class PROF = vr_noProf, class NANINF = vr_naninfFull>
+class OpWithSelectedRoundingMode {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
 
+  // det and comdet modes, for each hash of vr_detHashDispatch
+  template <class HASH>
+  using RandomDet = RoundingRandom<OP, vr_rand_det<OP, HASH>, PROF, NANINF>;
+  template <class HASH>
+  using RandomComdet =
+      RoundingRandom<OP, vr_rand_comdet<OP, HASH>, PROF, NANINF>;
+  template <class HASH>
+  using AverageDet = RoundingAverage<OP, vr_rand_det<OP, HASH>, PROF, NANINF>;
+  template <class HASH>
+  using AverageComdet =
+      RoundingAverage<OP, vr_rand_comdet<OP, HASH>, PROF, NANINF>;
+  template <class HASH>
+  using PRandomDet =
+      RoundingPRandom<OP, vr_rand_p<OP, vr_rand_hash<HASH>::template det>,
+                      PROF, NANINF>;
+  template <class HASH>
+  using PRandomComdet =
+      RoundingPRandom<OP, vr_rand_p<OP, vr_rand_hash<HASH>::template comdet>,
+                      PROF, NANINF>;
+
+  // the handlers are called by the Rounding classes, see vr_naninf.hxx
   static inline void apply(const PackArgs &p, RealType *res, void *context) {
     *res = applySeq(p, context);
 #ifdef DEBUG_PRINT_OP
     print_debug(p, res);
 #endif
-#ifndef VERROU_IGNORE_NANINF_CHECK
-    if (isNanInf(*res)) {
-      if (isNan(*res)) {
-        interflop_nanHandler();
+  }
+
+  /*
+   * Applies OP on n elements: the i-th result is computed from the i-th
+   * element of each input array. The rounding mode is dispatched once for the
+   * whole array, so that the inner loop only contains the selected mode.
+   */
+  template <class... ARRAYS>
+  static inline void applyArray(RealType *res, size_t n, void *context,
+                                const ARRAYS *...args) {
+    verrou_context_t *ctx = (verrou_context_t *)context;
+    if constexpr (std::is_same<PROF, vr_noProf>::value &&
+                  std::is_same<NANINF, vr_naninfFull>::value) {
+      if (ctx->profile_error) {
+        return vr_naninfDispatch<ArrayOf<vr_profError>::template type>(
+            ctx->naninf_check, res, n, context, args...);
+      }
+      if (ctx->profile_exact) {
+        return vr_naninfDispatch<ArrayOf<vr_profExact>::template type>(
+            ctx->naninf_check, res, n, context, args...);
       }
-      if (isinf(*res)) {
-        interflop_infHandler();
+      if (ctx->naninf_check != VR_NANINF_CHECK_FULL) {
+        return vr_naninfDispatch<ArrayOf<vr_noProf>::template type>(
+            ctx->naninf_check, res, n, context, args...);
       }
     }
+    switch (vr_regionMode(ctx)) {
+    case VR_NEAREST:
+      return applyArrayWith<RoundingNearest<OP, void, PROF, NANINF>>(res, n,
+                                                                     args...);
+    case VR_UPWARD:
+      return applyArrayWith<RoundingUpward<OP, void, PROF, NANINF>>(res, n,
+                                                                    args...);
+    case VR_DOWNWARD:
+      return applyArrayWith<RoundingDownward<OP, void, PROF, NANINF>>(
+          res, n, args...);
+    case VR_ZERO:
+      return applyArrayWith<RoundingZero<OP, void, PROF, NANINF>>(res, n,
+                                                                  args...);
+    case VR_RANDOM:
+      return applyArrayWith<
+          RoundingRandom<OP, vr_rand_prng<OP>, PROF, NANINF>>(res, n, args...);
+    case VR_RANDOM_DET:
+      return vr_detHashDispatch<ArrayWith<RandomDet>::template type>(
+          ctx->det_hash, res, n, args...);
+    case VR_RANDOM_COMDET:
+      return vr_detHashDispatch<ArrayWith<RandomComdet>::template type>(
+          ctx->det_hash, res, n, args...);
+    case VR_AVERAGE:
+      return applyArrayWith<
+          RoundingAverage<OP, vr_rand_prng<OP>, PROF, NANINF>>(res, n,
+                                                               args...);
+    case VR_AVERAGE_DET:
+      return vr_detHashDispatch<ArrayWith<AverageDet>::template type>(
+          ctx->det_hash, res, n, args...);
+    case VR_AVERAGE_COMDET:
+      return vr_detHashDispatch<ArrayWith<AverageComdet>::template type>(
+          ctx->det_hash, res, n, args...);
+    case VR_PRANDOM:
+      return applyArrayWith<
+          RoundingPRandom<OP, vr_rand_p<OP, vr_rand_prng>, PROF, NANINF>>(
+          res, n, args...);
+    case VR_PRANDOM_DET:
+      return vr_detHashDispatch<ArrayWith<PRandomDet>::template type>(
+          ctx->det_hash, res, n, args...);
+    case VR_PRANDOM_COMDET:
+      return vr_detHashDispatch<ArrayWith<PRandomComdet>::template type>(
+          ctx->det_hash, res, n, args...);
+    case VR_FARTHEST:
+      return applyArrayWith<RoundingFarthest<OP, void, PROF, NANINF>>(
+          res, n, args...);
+    case VR_FLOAT:
+      return applyArrayWith<RoundingFloat<OP, void, PROF, NANINF>>(res, n,
+                                                                   args...);
+    case VR_NATIVE:
+      return applyArrayWith<RoundingNearest<OP, void, PROF, NANINF>>(res, n,
+                                                                     args...);
+    case VR_FTZ:
+      interflop_panic("FTZ not implemented in backend_verrou");
+    }
+  }
+
+  // applyArray with the policies PROF2 and NANINF2, F of vr_naninfDispatch
+  template <class PROF2> struct ArrayOf {
+    template <class NANINF2> struct type {
+      template <class... ARRAYS>
+      static inline void apply(RealType *res, size_t n, void *context,
+                               const ARRAYS *...args) {
+        OpWithSelectedRoundingMode<OP, PROF2, NANINF2>::applyArray(
+            res, n, context, args...);
+      }
+    };
+  };
+
+  // applyArrayWith as an F of vr_detHashDispatch
+  template <template <class> class ROUNDING> struct ArrayWith {
+    template <class HASH> struct type {
+      template <class... ARRAYS>
+      static inline void apply(RealType *res, size_t n,
+                               const ARRAYS *...args) {
+        applyArrayWith<ROUNDING<HASH>>(res, n, args...);
+      }
+    };
+  };
+
+  template <class ROUNDING, class... ARRAYS>
+  static inline void applyArrayWith(RealType *res, size_t n,
+                                    const ARRAYS *...args) {
+    for (size_t i = 0; i < n; i++) {
+      const PackArgs p(args[i]...);
+      res[i] = ROUNDING::apply(p);
+#ifdef DEBUG_PRINT_OP
+      print_debug(p, res + i);
 #endif
+    }
   }
 
 #ifdef DEBUG_PRINT_OP
@@ -414,39 +514,40 @@ public:
 
   static inline RealType applySeq(const PackArgs &p, void *context) {
     verrou_context_t *ctx = (verrou_context_t *)context;
-    switch (ctx->rounding_mode) {
+    switch (vr_regionMode(ctx)) {
     case VR_NEAREST:
-      return RoundingNearest<OP>::apply(p);
+      return RoundingNearest<OP, void, PROF, NANINF>::apply(p);
     case VR_UPWARD:
-      return RoundingUpward<OP>::apply(p);
+      return RoundingUpward<OP, void, PROF, NANINF>::apply(p);
     case VR_DOWNWARD:
-      return RoundingDownward<OP>::apply(p);
+      return RoundingDownward<OP, void, PROF, NANINF>::apply(p);
     case VR_ZERO:
-      return RoundingZero<OP>::apply(p);
+      return RoundingZero<OP, void, PROF, NANINF>::apply(p);
     case VR_RANDOM:
-      return RoundingRandom<OP, vr_rand_prng<OP>>::apply(p);
+      return RoundingRandom<OP, vr_rand_prng<OP>, PROF, NANINF>::apply(p);
     case VR_RANDOM_DET:
-      return RoundingRandom<OP, vr_rand_det<OP>>::apply(p);
+      return vr_detHashDispatch<RandomDet>(ctx->det_hash, p);
     case VR_RANDOM_COMDET:
-      return RoundingRandom<OP, vr_rand_comdet<OP>>::apply(p);
+      return vr_detHashDispatch<RandomComdet>(ctx->det_hash, p);
     case VR_AVERAGE:
-      return RoundingAverage<OP, vr_rand_prng<OP>>::apply(p);
+      return RoundingAverage<OP, vr_rand_prng<OP>, PROF, NANINF>::apply(p);
     case VR_AVERAGE_DET:
-      return RoundingAverage<OP, vr_rand_det<OP>>::apply(p);
+      return vr_detHashDispatch<AverageDet>(ctx->det_hash, p);
     case VR_AVERAGE_COMDET:
-      return RoundingAverage<OP, vr_rand_comdet<OP>>::apply(p);
+      return vr_detHashDispatch<AverageComdet>(ctx->det_hash, p);
     case VR_PRANDOM:
-      return RoundingPRandom<OP, vr_rand_p<OP, vr_rand_prng>>::apply(p);
+      return RoundingPRandom<OP, vr_rand_p<OP, vr_rand_prng>, PROF,
+                             NANINF>::apply(p);
     case VR_PRANDOM_DET:
-      return RoundingPRandom<OP, vr_rand_p<OP, vr_rand_det>>::apply(p);
+      return vr_detHashDispatch<PRandomDet>(ctx->det_hash, p);
     case VR_PRANDOM_COMDET:
-      return RoundingPRandom<OP, vr_rand_p<OP, vr_rand_comdet>>::apply(p);
+      return vr_detHashDispatch<PRandomComdet>(ctx->det_hash, p);
     case VR_FARTHEST:
-      return RoundingFarthest<OP>::apply(p);
+      return RoundingFarthest<OP, void, PROF, NANINF>::apply(p);
     case VR_FLOAT:
-      return RoundingFloat<OP>::apply(p);
+      return RoundingFloat<OP, void, PROF, NANINF>::apply(p);
     case VR_NATIVE:
-      return RoundingNearest<OP>::apply(p);
+      return RoundingNearest<OP, void, PROF, NANINF>::apply(p);
     case VR_FTZ:
       interflop_panic("FTZ not implemented in backend_verrou");
     }
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef RNG_THREAD_SAFE
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "interflop/interflop_stdlib.h"
+
+/*
+ * Samples of --samples and VERROU_SAMPLES_BEGIN_ID. The driver forks one
+ * copy-on-write child per sample, at most jobs at a time: each child returns
+ * from vr_samples_fork with its own seed and runs the rest of the program,
+ * the driver never returns. The values that the children record, by name,
+ * are kept in a shared anonymous mapping created before the first fork; the
+ * driver reads those of a child once it exited with status 0.
+ *
+ * After each sample, the driver estimates the number of significant digits
+ * of every value, -log10(std / |mean|). It stops, killing the running
+ * children, once the last VR_SAMPLES_WINDOW estimates of every value lie
+ * within the tolerance, and at least VR_SAMPLES_MIN samples succeeded.
+ *
+ * interflop_stdlib has no fork, mmap or waitpid: the driver calls libc, and
+ * is only built with RNG_THREAD_SAFE, as the threads of the reductions. The
+ * backend without TLS, which also runs without libc, rejects --samples.
+ */
+#define VR_SAMPLES_MAX_VALUES 64
+#define VR_SAMPLES_NAME_LEN 48
+#define VR_SAMPLES_MIN 10
+#define VR_SAMPLES_WINDOW 5
+#define VR_SAMPLES_MAX_DIGITS 17.
+
+enum { VR_SAMPLE_NAME_FREE, VR_SAMPLE_NAME_BUSY, VR_SAMPLE_NAME_READY };
+
+typedef struct {
+  double values[VR_SAMPLES_MAX_VALUES];
+  uint64_t recorded; // bit i: values[i] was recorded
+} Vr_SampleValues;
+
+/* shared by the driver and its children */
+typedef struct {
+  int nameState[VR_SAMPLES_MAX_VALUES]; // VR_SAMPLE_NAME_*
+  char names[VR_SAMPLES_MAX_VALUES][VR_SAMPLES_NAME_LEN];
+  Vr_SampleValues samples[]; // one per sample
+} Vr_SamplesShared;
+
+typedef struct {
+  Vr_SamplesShared *shared;
+  int index; // of the sample run by this process, -1 in the driver
+} Vr_Samples;
+
+/* statistics of one value in the driver (Welford) */
+typedef struct {
+  unsigned int count;
+  double mean;
+  double m2;
+  double digits[VR_SAMPLES_WINDOW]; // last estimates, circular
+} Vr_SampleStats;
+
+static inline double vr_samples_digits(const Vr_SampleStats *st) {
+  if (st->count < 2)
+    return 0.;
+  const double sigma = sqrt(st->m2 / (st->count - 1));
+  if (sigma == 0.)
+    return VR_SAMPLES_MAX_DIGITS;
+  if (st->mean == 0.)
+    return 0.;
+  return fmin(VR_SAMPLES_MAX_DIGITS, -log10(sigma / fabs(st->mean)));
+}
+
+/* index of the value name, claimed by the first child which records it; -1
+   when all the names are taken */
+static inline int vr_samples_nameIndex(Vr_SamplesShared *shared,
+                                       const char *name) {
+  for (int i = 0; i < VR_SAMPLES_MAX_VALUES; i++) {
+    int state = __atomic_load_n(&shared->nameState[i], __ATOMIC_ACQUIRE);
+    if (state == VR_SAMPLE_NAME_FREE) {
+      int expected = VR_SAMPLE_NAME_FREE;
+      if (__atomic_compare_exchange_n(&shared->nameState[i], &expected,
+                                      VR_SAMPLE_NAME_BUSY, false,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        strncpy(shared->names[i], name, VR_SAMPLES_NAME_LEN - 1);
+        __atomic_store_n(&shared->nameState[i], VR_SAMPLE_NAME_READY,
+                         __ATOMIC_RELEASE);
+        return i;
+      }
+      state = expected;
+    }
+    while (state == VR_SAMPLE_NAME_BUSY)
+      state = __atomic_load_n(&shared->nameState[i], __ATOMIC_ACQUIRE);
+    if (strncmp(shared->names[i], name, VR_SAMPLES_NAME_LEN - 1) == 0)
+      return i;
+  }
+  return -1;
+}
+
+/* in a sample, false when all the names are taken */
+static inline bool vr_samples_record(Vr_Samples *s, const char *name,
+                                     double value) {
+  const int i = vr_samples_nameIndex(s->shared, name);
+  if (i < 0)
+    return false;
+  Vr_SampleValues *sample = &s->shared->samples[s->index];
+  // several threads of the sample may record: the value before its bit
+  sample->values[i] = value;
+  __atomic_fetch_or(&sample->recorded, 1ULL << i, __ATOMIC_RELEASE);
+  return true;
+}
+
+/* adds sample k to stats, true once every value converged */
+static inline bool vr_samples_update(const Vr_SamplesShared *shared, int k,
+                                     Vr_SampleStats *stats, unsigned int done,
+                                     double tolerance) {
+  bool converged = (tolerance > 0. && done >= VR_SAMPLES_MIN);
+  bool any = false;
+  const uint64_t recorded =
+      __atomic_load_n(&shared->samples[k].recorded, __ATOMIC_ACQUIRE);
+  for (int i = 0; i < VR_SAMPLES_MAX_VALUES; i++) {
+    if (!(recorded & (1ULL << i)))
+      continue;
+    Vr_SampleStats *st = &stats[i];
+    const double x = shared->samples[k].values[i];
+    st->count++;
+    const double delta = x - st->mean;
+    st->mean += delta / st->count;
+    st->m2 += delta * (x - st->mean);
+    st->digits[st->count % VR_SAMPLES_WINDOW] = vr_samples_digits(st);
+  }
+  for (int i = 0; i < VR_SAMPLES_MAX_VALUES; i++) {
+    const Vr_SampleStats *st = &stats[i];
+    if (st->count == 0)
+      continue;
+    any = true;
+    double lo = st->digits[0], hi = st->digits[0];
+    for (int w = 1; w < VR_SAMPLES_WINDOW; w++) {
+      lo = fmin(lo, st->digits[w]);
+      hi = fmax(hi, st->digits[w]);
+    }
+    if (st->count < VR_SAMPLES_WINDOW + 1 || hi - lo > tolerance)
+      converged = false;
+  }
+  return converged && any;
+}
+
+static inline void vr_samples_report(File *stream,
+                                     const Vr_SamplesShared *shared,
+                                     const Vr_SampleStats *stats,
+                                     unsigned int seed, unsigned int started,
+                                     unsigned int done, unsigned int failed,
+                                     bool stopped) {
+  interflop_fprintf(stream,
+                    "VERROU SAMPLES : %u succeeded, %u failed, seeds %u to "
+                    "%u%s\n",
+                    done, failed, seed, seed + started - 1,
+                    stopped ? ", stopped early" : "");
+  interflop_fprintf(stream, "value,samples,mean,std,significant_digits\n");
+  for (int i = 0; i < VR_SAMPLES_MAX_VALUES; i++) {
+    const Vr_SampleStats *st = &stats[i];
+    if (st->count == 0)
+      continue;
+    const double sigma = st->count > 1 ? sqrt(st->m2 / (st->count - 1)) : 0.;
+    interflop_fprintf(stream, "%s,%u,%.17g,%.3g,%.2f\n", shared->names[i],
+                      st->count, st->mean, sigma, vr_samples_digits(st));
+  }
+}
+
+#ifdef RNG_THREAD_SAFE
+/* reaps a sample which exited, without reaping the other children of the
+   application: returns its index in pids, or -1 when none is left */
+static inline int vr_samples_wait(pid_t *pids, unsigned int started,
+                                  int *status) {
+  siginfo_t info;
+  info.si_pid = 0;
+  unsigned int k = started;
+  // the child which exited first, left waitable
+  if (waitid(P_ALL, 0, &info, WEXITED | WNOWAIT) == 0)
+    for (k = 0; k < started && pids[k] != info.si_pid; k++)
+      ;
+  // or another child of the application: the oldest running sample
+  if (k == started)
+    for (k = 0; k < started && pids[k] == 0; k++)
+      ;
+  if (k == started)
+    return -1;
+  pid_t pid;
+  do
+    pid = waitpid(pids[k], status, 0);
+  while (pid < 0 && errno == EINTR);
+  if (pid != pids[k])
+    return -1;
+  pids[k] = 0;
+  return (int)k;
+}
+
+/*
+ * Runs nbSamples samples, jobs at a time: returns the index of its sample in
+ * each child, which uses seed + index. The driver reports to stream and
+ * exits, with status 0 when a sample succeeded.
+ */
+static inline int vr_samples_fork(Vr_Samples *s, File *stream,
+                                  unsigned int nbSamples, unsigned int jobs,
+                                  double tolerance, unsigned int seed) {
+  const size_t size =
+      sizeof(Vr_SamplesShared) + nbSamples * sizeof(Vr_SampleValues);
+  void *map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED)
+    interflop_panic("verrou samples: cannot map the shared values");
+  s->shared = (Vr_SamplesShared *)map;
+  s->index = -1;
+  if (jobs == 0)
+    jobs = (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (jobs == 0)
+    jobs = 1;
+
+  pid_t *pids = (pid_t *)interflop_malloc(nbSamples * sizeof(pid_t));
+  Vr_SampleStats *stats = (Vr_SampleStats *)interflop_malloc(
+      VR_SAMPLES_MAX_VALUES * sizeof(Vr_SampleStats));
+  memset(stats, 0, VR_SAMPLES_MAX_VALUES * sizeof(Vr_SampleStats));
+  unsigned int started = 0, running = 0, done = 0, failed = 0;
+  bool stopped = false;
+
+  // the children must not flush what the driver buffered
+  fflush(NULL);
+  while (running > 0 || (started < nbSamples && !stopped)) {
+    while (running < jobs && started < nbSamples && !stopped) {
+      const pid_t pid = fork();
+      if (pid < 0)
+        interflop_panic("verrou samples: fork failed");
+      if (pid == 0) {
+        s->index = (int)started;
+        return s->index;
+      }
+      pids[started++] = pid;
+      running++;
+    }
+    int status;
+    const int k = vr_samples_wait(pids, started, &status);
+    if (k < 0)
+      break;
+    running--;
+    if (stopped)
+      continue; // killed
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failed++;
+      continue;
+    }
+    done++;
+    if (vr_samples_update(s->shared, k, stats, done, tolerance)) {
+      stopped = true;
+      for (unsigned int j = 0; j < started; j++)
+        if (pids[j] != 0)
+          kill(pids[j], SIGKILL);
+    }
+  }
+
+  vr_samples_report(stream, s->shared, stats, seed, started, done, failed,
+                    stopped);
+  fflush(NULL);
+  _exit(done > 0 ? 0 : 1);
+}
+#endif
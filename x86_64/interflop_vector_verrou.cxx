@@ -3,12 +3,27 @@
 #include <stddef.h>
 
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <limits>
+#include <math.h>
+#include <new>
+#include <stdint.h>
+#include <type_traits>
+#include "interflop/fma/interflop_fma.h"
+#include "interflop/interflop_stdlib.h"
+#include "interflop/prng/vr_rand.h"
+#ifndef USE_XOSHIRO
+#include "interflop/prng/tinymt64.h"
+#else
+#include "interflop/prng/xoshiro.hxx"
+#endif
 #include "../interflop_verrou.h"
-// #include "../static_backends.hxx"
-#include "vr_nextUlps.hxx"
-#include "vr_vop.hxx"
-#include "vr_vroundingOp.hxx"
 
 #include "interflop_vinterface.h"
 
@@ -17,303 +32,624 @@
 
 #if defined(VECT512)
 #include "interflop_vector_verrou_avx512.h"
+#define VR_ISA_NAMESPACE vr_isa_avx512
 #elif defined(VECT256)
 #include "interflop_vector_verrou_avx.h"
+#define VR_ISA_NAMESPACE vr_isa_avx
 #elif defined(VECT128)
 #include "interflop_vector_verrou_sse.h"
+#define VR_ISA_NAMESPACE vr_isa_sse
 #elif defined (SCALAR)
 #include "interflop_vector_verrou_scalar.h"
+#define VR_ISA_NAMESPACE vr_isa_scalar
 #else
 #error "Mustn't happened"
 #endif
 
-void INTERFLOP_VECTOR_VERROU_API(add_float_1)(float *a, float *b, float *res,
-                                          void *context) {
-  typedef VOpWithSelectedRoundingMode<AddOp<float>> Op;
-  Op::apply(Op::PackArgs(*a, *b), res, context);
-}
+/*
+ * This file is compiled once per instruction set into the same library. The
+ * inline and template functions of the headers are weak symbols, of which
+ * the linker keeps a single copy: each object puts them in its own namespace
+ * so that the avx512 code never runs on an sse CPU, nor the sse code in the
+ * avx512 table. The system and interflop headers are included above, out of
+ * the namespace, and the state shared with interflop_verrou.cxx is declared
+ * with C linkage.
+ */
+/*
+ * The vector types are declared with attributes (__may_alias__, alignment)
+ * which GCC drops from template arguments, with a -Wignored-attributes
+ * warning at each instantiation. The templates of vr_simd.hxx and of the
+ * operations only hold them by value and access memory through the
+ * unaligned load and store intrinsics, so the warning is silenced up to the
+ * end of this file.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
 
-void INTERFLOP_VECTOR_VERROU_API(add_float_4)(float *a, float *b, float *res,
-                                          void *context) {
-#if defined(__SSE4_1__)
-  typedef VOpWithSelectedRoundingMode<AddOp<__m128>> Op;
-  __m128 v_a = _mm_loadu_ps (a);
-  __m128 v_b = _mm_loadu_ps (b);
-  __m128 v_res = _mm_setzero_ps();
-  Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-  _mm_storeu_ps (res, v_res);
-#else
-  typedef VOpWithSelectedRoundingMode<AddOp<float>> Op;
-  for (size_t i = 0; i < 4; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-  
+/*
+ * Up to GCC 12, most AVX-512 intrinsics pass _mm512_undefined_*(), a
+ * variable initialized with itself, as the source operand of their masked
+ * builtin (GCC bug 105593). -Wuninitialized and -Wmaybe-uninitialized are
+ * emitted after inlining, at the call sites of this file, so they can only
+ * be silenced here and not around the include of the intrinsics.
+ */
+#if defined(VECT512) && !defined(__clang__) && __GNUC__ <= 12
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
 #endif
-}
 
-void INTERFLOP_VECTOR_VERROU_API(add_float_8)(float *a, float *b, float *res,
-                                          void *context) {
-#if defined(__AVX2__)
-  typedef VOpWithSelectedRoundingMode<AddOp<__m256>> Op;
-  __m256 v_a = _mm256_loadu_ps (a);
-  __m256 v_b = _mm256_loadu_ps (b);
-  __m256 v_res = _mm256_setzero_ps();
-  Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-  _mm256_storeu_ps (res, v_res);
+namespace VR_ISA_NAMESPACE {
+// #include "../static_backends.hxx"
+#include "vr_nextUlps.hxx"
+#include "vr_vop.hxx"
+#include "vr_vroundingOp.hxx"
+} // namespace VR_ISA_NAMESPACE
+
+using namespace VR_ISA_NAMESPACE;
+
+// Widest SIMD type available to process NB elements of type REAL
+template <class REAL, int NB> struct vr_vtype { typedef REAL type; };
+
+#if defined(__AVX512F__)
+template <> struct vr_vtype<float, 8> { typedef __m256 type; };
+template <> struct vr_vtype<float, 16> { typedef __m512 type; };
+template <> struct vr_vtype<double, 4> { typedef __m256d type; };
+template <> struct vr_vtype<double, 8> { typedef __m512d type; };
+#elif defined(__AVX2__)
+template <> struct vr_vtype<float, 8> { typedef __m256 type; };
+template <> struct vr_vtype<float, 16> { typedef __m256 type; };
+template <> struct vr_vtype<double, 4> { typedef __m256d type; };
+template <> struct vr_vtype<double, 8> { typedef __m256d type; };
 #elif defined(__SSE4_2__)
-  for (size_t i = 0; i < 2; i++)
+template <> struct vr_vtype<float, 8> { typedef __m128 type; };
+template <> struct vr_vtype<float, 16> { typedef __m128 type; };
+template <> struct vr_vtype<double, 4> { typedef __m128d type; };
+template <> struct vr_vtype<double, 8> { typedef __m128d type; };
+#endif
+
+#if defined(__SSE4_2__)
+template <> struct vr_vtype<float, 4> { typedef __m128 type; };
+template <> struct vr_vtype<double, 2> { typedef __m128d type; };
+#endif
+
+template <int NB> using vr_vfloat = typename vr_vtype<float, NB>::type;
+template <int NB> using vr_vdouble = typename vr_vtype<double, NB>::type;
+
+// Applies Op on NB elements, by chunks of Op::RealType
+template <class Op, int NB, class REAL>
+static inline void vr_vapplyOp2(const REAL *a, const REAL *b, REAL *res,
+                                void *context) {
+  typedef typename Op::RealType VT;
+  typedef vr_simd<VT> SIMD;
+  for (int i = 0; i < NB; i += SIMD::nbLanes)
   {
-    typedef VOpWithSelectedRoundingMode<AddOp<__m128>> Op;
-    __m128 v_a = _mm_loadu_ps (a+4*i);
-    __m128 v_b = _mm_loadu_ps (b+4*i);
-    __m128 v_res = _mm_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm_storeu_ps (res+4*i, v_res);
+    const VT v_a = SIMD::loadu (a + i);
+    const VT v_b = SIMD::loadu (b + i);
+    VT v_res;
+    Op::apply(typename Op::PackArgs(v_a, v_b), &v_res, context);
+    SIMD::storeu (res + i, v_res);
   }
-#else
-  typedef VOpWithSelectedRoundingMode<AddOp<float>> Op;
-  for (size_t i = 0; i < 8; i++)
+}
+
+// Applies the binary operation OP on NB elements, by chunks of OP::RealType
+template <class OP, int NB, class PROF = vr_noProf, class REAL>
+static inline void vr_vapply2(const REAL *a, const REAL *b, REAL *res,
+                              void *context) {
+  vr_vapplyOp2<VOpWithSelectedRoundingMode<OP, PROF>, NB>(a, b, res, context);
+}
+
+// Applies the ternary operation OP on NB elements, by chunks of OP::RealType
+template <class OP, int NB, class PROF = vr_noProf, class REAL>
+static inline void vr_vapply3(const REAL *a, const REAL *b, const REAL *c,
+                              REAL *res, void *context) {
+  typedef typename OP::RealType VT;
+  typedef vr_simd<VT> SIMD;
+  typedef VOpWithSelectedRoundingMode<OP, PROF> Op;
+  for (int i = 0; i < NB; i += SIMD::nbLanes)
   {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
+    const VT v_a = SIMD::loadu (a + i);
+    const VT v_b = SIMD::loadu (b + i);
+    const VT v_c = SIMD::loadu (c + i);
+    VT v_res;
+    Op::apply(typename Op::PackArgs(v_a, v_b, v_c), &v_res, context);
+    SIMD::storeu (res + i, v_res);
   }
-#endif
 }
 
-void INTERFLOP_VECTOR_VERROU_API(add_float_16)(float *a, float *b, float *res,
-                                          void *context) {
+// Rounds NB doubles to float, with the widest conversion available
+template <int NB, class PROF = vr_noProf>
+static inline void vr_vcast_double_to_float(const double *a, float *res,
+                                            void *context) {
+#if defined(__AVX512F__)
+  if constexpr (NB % 8 == 0) {
+    typedef VOpWithSelectedRoundingMode<CastOp<__m512d, __m256>, PROF> Op;
+    for (int i = 0; i < NB; i += 8)
+    {
+      const __m512d v_a = _mm512_loadu_pd (a + i);
+      __m256 v_res;
+      Op::apply(typename Op::PackArgs(v_a), &v_res, context);
+      _mm256_storeu_ps (res + i, v_res);
+    }
+    return;
+  }
+#endif
 #if defined(__AVX2__)
-  for (size_t i = 0; i < 2; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<AddOp<__m256>> Op;
-    __m256 v_a = _mm256_loadu_ps (a+8*i);
-    __m256 v_b = _mm256_loadu_ps (b+8*i);
-    __m256 v_res = _mm256_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm256_storeu_ps (res+8*i, v_res);
+  if constexpr (NB % 4 == 0) {
+    typedef VOpWithSelectedRoundingMode<CastOp<__m256d, __m128>, PROF> Op;
+    for (int i = 0; i < NB; i += 4)
+    {
+      const __m256d v_a = _mm256_loadu_pd (a + i);
+      __m128 v_res;
+      Op::apply(typename Op::PackArgs(v_a), &v_res, context);
+      _mm_storeu_ps (res + i, v_res);
+    }
+    return;
   }
-#elif defined(__SSE4_2__)
-  for (size_t i = 0; i < 4; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<AddOp<__m128>> Op;
-    __m128 v_a = _mm_loadu_ps (a+4*i);
-    __m128 v_b = _mm_loadu_ps (b+4*i);
-    __m128 v_res = _mm_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm_storeu_ps (res+4*i, v_res);
+#endif
+#if defined(__SSE4_2__)
+  if constexpr (NB % 2 == 0) {
+    typedef VOpWithSelectedRoundingMode<CastOp<__m128d, __m128>, PROF> Op;
+    for (int i = 0; i < NB; i += 2)
+    {
+      const __m128d v_a = _mm_loadu_pd (a + i);
+      __m128 v_res;
+      Op::apply(typename Op::PackArgs(v_a), &v_res, context);
+      _mm_storel_pi ((__m64 *)(res + i), v_res);
+    }
+    return;
   }
-#else
-  typedef VOpWithSelectedRoundingMode<AddOp<float>> Op;
-  for (size_t i = 0; i < 16; i++)
+#endif
+  typedef VOpWithSelectedRoundingMode<CastOp<double, float>, PROF> Op;
+  for (int i = 0; i < NB; i++)
   {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
+    Op::apply(typename Op::PackArgs(a[i]), res + i, context);
   }
-#endif
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_float_1)(float *a, float *b, float *res,
+                                          void *context) {
+  vr_vapply2<AddOp<float>, 1>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_float_4)(float *a, float *b, float *res,
+                                          void *context) {
+  vr_vapply2<AddOp<vr_vfloat<4>>, 4>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_float_8)(float *a, float *b, float *res,
+                                          void *context) {
+  vr_vapply2<AddOp<vr_vfloat<8>>, 8>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_float_16)(float *a, float *b, float *res,
+                                          void *context) {
+  vr_vapply2<AddOp<vr_vfloat<16>>, 16>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(sub_float_1)(float *a, float *b, float *res,
                                           void *context) {
-  typedef VOpWithSelectedRoundingMode<SubOp<float>> Op;
-  Op::apply(Op::PackArgs(*a, *b), res, context);
+  vr_vapply2<SubOp<float>, 1>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(sub_float_4)(float *a, float *b, float *res,
                                           void *context) {
-#if defined(__SSE4_1__)
-  typedef VOpWithSelectedRoundingMode<SubOp<__m128>> Op;
-  __m128 v_a = _mm_loadu_ps (a);
-  __m128 v_b = _mm_loadu_ps (b);
-  __m128 v_res = _mm_setzero_ps();
-  Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-  _mm_storeu_ps (res, v_res);
-#else
-  typedef VOpWithSelectedRoundingMode<SubOp<float>> Op;
-  for (size_t i = 0; i < 4; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-  
-#endif
+  vr_vapply2<SubOp<vr_vfloat<4>>, 4>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(sub_float_8)(float *a, float *b, float *res,
                                           void *context) {
-#if defined(__AVX2__)
-  typedef VOpWithSelectedRoundingMode<SubOp<__m256>> Op;
-  __m256 v_a = _mm256_loadu_ps (a);
-  __m256 v_b = _mm256_loadu_ps (b);
-  __m256 v_res = _mm256_setzero_ps();
-  Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-  _mm256_storeu_ps (res, v_res);
-#elif defined(__SSE4_2__)
-  for (size_t i = 0; i < 2; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<SubOp<__m128>> Op;
-    __m128 v_a = _mm_loadu_ps (a+4*i);
-    __m128 v_b = _mm_loadu_ps (b+4*i);
-    __m128 v_res = _mm_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm_storeu_ps (res+4*i, v_res);
-  }
-#else
-  typedef VOpWithSelectedRoundingMode<SubOp<float>> Op;
-  for (size_t i = 0; i < 8; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-#endif
+  vr_vapply2<SubOp<vr_vfloat<8>>, 8>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(sub_float_16)(float *a, float *b, float *res,
                                           void *context) {
-#if defined(__AVX2__)
-  for (size_t i = 0; i < 2; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<SubOp<__m256>> Op;
-    __m256 v_a = _mm256_loadu_ps (a+8*i);
-    __m256 v_b = _mm256_loadu_ps (b+8*i);
-    __m256 v_res = _mm256_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm256_storeu_ps (res+8*i, v_res);
-  }
-#elif defined(__SSE4_2__)
-  for (size_t i = 0; i < 4; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<SubOp<__m128>> Op;
-    __m128 v_a = _mm_loadu_ps (a+4*i);
-    __m128 v_b = _mm_loadu_ps (b+4*i);
-    __m128 v_res = _mm_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm_storeu_ps (res+4*i, v_res);
-  }
-#else
-  typedef VOpWithSelectedRoundingMode<SubOp<float>> Op;
-  for (size_t i = 0; i < 16; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-#endif
+  vr_vapply2<SubOp<vr_vfloat<16>>, 16>(a, b, res, context);
 }
+
 void INTERFLOP_VECTOR_VERROU_API(mul_float_1)(float *a, float *b, float *res,
                                           void *context) {
-  typedef VOpWithSelectedRoundingMode<MulOp<float>> Op;
-  Op::apply(Op::PackArgs(*a, *b), res, context);
+  vr_vapply2<MulOp<float>, 1>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(mul_float_4)(float *a, float *b, float *res,
                                           void *context) {
-#if defined(__SSE4_1__)
-  typedef VOpWithSelectedRoundingMode<MulOp<__m128>> Op;
-  __m128 v_a = _mm_loadu_ps (a);
-  __m128 v_b = _mm_loadu_ps (b);
-  __m128 v_res = _mm_setzero_ps();
-  Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-  _mm_storeu_ps (res, v_res);
-#else
-  typedef VOpWithSelectedRoundingMode<MulOp<float>> Op;
-  for (size_t i = 0; i < 4; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-  
-#endif
+  vr_vapply2<MulOp<vr_vfloat<4>>, 4>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(mul_float_8)(float *a, float *b, float *res,
                                           void *context) {
-#if defined(__AVX2__)
-  typedef VOpWithSelectedRoundingMode<MulOp<__m256>> Op;
-  __m256 v_a = _mm256_loadu_ps (a);
-  __m256 v_b = _mm256_loadu_ps (b);
-  __m256 v_res = _mm256_setzero_ps();
-  Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-  _mm256_storeu_ps (res, v_res);
-#elif defined(__SSE4_2__)
-  for (size_t i = 0; i < 2; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<MulOp<__m128>> Op;
-    __m128 v_a = _mm_loadu_ps (a+4*i);
-    __m128 v_b = _mm_loadu_ps (b+4*i);
-    __m128 v_res = _mm_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm_storeu_ps (res+4*i, v_res);
-  }
-#else
-  typedef VOpWithSelectedRoundingMode<MulOp<float>> Op;
-  for (size_t i = 0; i < 8; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-#endif
+  vr_vapply2<MulOp<vr_vfloat<8>>, 8>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(mul_float_16)(float *a, float *b, float *res,
                                           void *context) {
-#if defined(__AVX2__)
-  for (size_t i = 0; i < 2; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<MulOp<__m256>> Op;
-    __m256 v_a = _mm256_loadu_ps (a+8*i);
-    __m256 v_b = _mm256_loadu_ps (b+8*i);
-    __m256 v_res = _mm256_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm256_storeu_ps (res+8*i, v_res);
-  }
-#elif defined(__SSE4_2__)
-  for (size_t i = 0; i < 4; i++)
-  {
-    typedef VOpWithSelectedRoundingMode<MulOp<__m128>> Op;
-    __m128 v_a = _mm_loadu_ps (a+4*i);
-    __m128 v_b = _mm_loadu_ps (b+4*i);
-    __m128 v_res = _mm_setzero_ps();
-    Op::apply(Op::PackArgs(v_a, v_b), &v_res, context);
-    _mm_storeu_ps (res+4*i, v_res);
-  }
-#else
-  typedef VOpWithSelectedRoundingMode<MulOp<float>> Op;
-  for (size_t i = 0; i < 16; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-#endif
+  vr_vapply2<MulOp<vr_vfloat<16>>, 16>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(div_float_1)(float *a, float *b, float *res,
                                           void *context) {
-  typedef VOpWithSelectedRoundingMode<DivOp<float>> Op;
-  Op::apply(Op::PackArgs(*a, *b), res, context);
+  vr_vapply2<DivOp<float>, 1>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(div_float_4)(float *a, float *b, float *res,
                                           void *context) {
-  typedef VOpWithSelectedRoundingMode<DivOp<float>> Op;
-  for (size_t i = 0; i < 4; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
+  vr_vapply2<DivOp<vr_vfloat<4>>, 4>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(div_float_8)(float *a, float *b, float *res,
                                           void *context) {
-  typedef VOpWithSelectedRoundingMode<DivOp<float>> Op;
-  for (size_t i = 0; i < 8; i++)
-  {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
-  }
-
+  vr_vapply2<DivOp<vr_vfloat<8>>, 8>(a, b, res, context);
 }
 
 void INTERFLOP_VECTOR_VERROU_API(div_float_16)(float *a, float *b, float *res,
                                           void *context) {
-  typedef VOpWithSelectedRoundingMode<DivOp<float>> Op;
-  for (size_t i = 0; i < 16; i++)
+  vr_vapply2<DivOp<vr_vfloat<16>>, 16>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_double_1)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<AddOp<double>, 1>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_double_2)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<AddOp<vr_vdouble<2>>, 2>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_double_4)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<AddOp<vr_vdouble<4>>, 4>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(add_double_8)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<AddOp<vr_vdouble<8>>, 8>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(sub_double_1)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<SubOp<double>, 1>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(sub_double_2)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<SubOp<vr_vdouble<2>>, 2>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(sub_double_4)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<SubOp<vr_vdouble<4>>, 4>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(sub_double_8)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<SubOp<vr_vdouble<8>>, 8>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(mul_double_1)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<MulOp<double>, 1>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(mul_double_2)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<MulOp<vr_vdouble<2>>, 2>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(mul_double_4)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<MulOp<vr_vdouble<4>>, 4>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(mul_double_8)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<MulOp<vr_vdouble<8>>, 8>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(div_double_1)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<DivOp<double>, 1>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(div_double_2)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<DivOp<vr_vdouble<2>>, 2>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(div_double_4)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<DivOp<vr_vdouble<4>>, 4>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(div_double_8)(double *a, double *b, double *res,
+                                          void *context) {
+  vr_vapply2<DivOp<vr_vdouble<8>>, 8>(a, b, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_1)(double *a, float *res,
+                                          void *context) {
+  vr_vcast_double_to_float<1>(a, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_2)(double *a, float *res,
+                                          void *context) {
+  vr_vcast_double_to_float<2>(a, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_4)(double *a, float *res,
+                                          void *context) {
+  vr_vcast_double_to_float<4>(a, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_8)(double *a, float *res,
+                                          void *context) {
+  vr_vcast_double_to_float<8>(a, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_float_1)(float *a, float *b, float *c, float *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<float>, 1>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_float_4)(float *a, float *b, float *c, float *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<vr_vfloat<4>>, 4>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_float_8)(float *a, float *b, float *c, float *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<vr_vfloat<8>>, 8>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_float_16)(float *a, float *b, float *c, float *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<vr_vfloat<16>>, 16>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_double_1)(double *a, double *b, double *c, double *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<double>, 1>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_double_2)(double *a, double *b, double *c, double *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<vr_vdouble<2>>, 2>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_double_4)(double *a, double *b, double *c, double *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<vr_vdouble<4>>, 4>(a, b, c, res, context);
+}
+
+void INTERFLOP_VECTOR_VERROU_API(fma_double_8)(double *a, double *b, double *c, double *res,
+                                          void *context) {
+  vr_vapply3<MAddOp<vr_vdouble<8>>, 8>(a, b, c, res, context);
+}
+
+/*
+ * Lanes of verrou_sum and verrou_dot: acc[j] accumulates the elements
+ * i = j mod 8 of x, or of x * y with one fma, for n a multiple of 8. Each
+ * lane rounds its operations in the same order whatever the instruction set,
+ * so the lanes are those of the scalar build.
+ */
+template <class T, class PROF>
+static inline void vr_vreduce_sum(const T *x, size_t n, T *acc,
+                                  void *context) {
+  typedef vr_simd<typename vr_vtype<T, 8>::type> SIMD;
+  typedef VOpWithSelectedRoundingMode<AddOp<typename vr_vtype<T, 8>::type>,
+                                      PROF> Op;
+  static const int NV = 8 / SIMD::nbLanes;
+  typename Op::RealType v_acc[NV];
+  for (int k = 0; k < NV; k++)
+    v_acc[k] = SIMD::loadu (acc + k * SIMD::nbLanes);
+  for (size_t i = 0; i < n; i += 8)
   {
-    Op::apply(Op::PackArgs(a[i], b[i]), res+i, context);
+    for (int k = 0; k < NV; k++)
+    {
+      const typename Op::RealType v_x = SIMD::loadu (x + i + k * SIMD::nbLanes);
+      Op::apply(typename Op::PackArgs(v_acc[k], v_x), &v_acc[k], context);
+    }
+  }
+  for (int k = 0; k < NV; k++)
+    SIMD::storeu (acc + k * SIMD::nbLanes, v_acc[k]);
+}
+
+template <class T, class PROF>
+static inline void vr_vreduce_dot(const T *x, const T *y, size_t n, T *acc,
+                                  void *context) {
+  typedef vr_simd<typename vr_vtype<T, 8>::type> SIMD;
+  typedef VOpWithSelectedRoundingMode<MAddOp<typename vr_vtype<T, 8>::type>,
+                                      PROF> Op;
+  static const int NV = 8 / SIMD::nbLanes;
+  typename Op::RealType v_acc[NV];
+  for (int k = 0; k < NV; k++)
+    v_acc[k] = SIMD::loadu (acc + k * SIMD::nbLanes);
+  for (size_t i = 0; i < n; i += 8)
+  {
+    for (int k = 0; k < NV; k++)
+    {
+      const typename Op::RealType v_x = SIMD::loadu (x + i + k * SIMD::nbLanes);
+      const typename Op::RealType v_y = SIMD::loadu (y + i + k * SIMD::nbLanes);
+      Op::apply(typename Op::PackArgs(v_x, v_y, v_acc[k]), &v_acc[k], context);
+    }
   }
+  for (int k = 0; k < NV; k++)
+    SIMD::storeu (acc + k * SIMD::nbLanes, v_acc[k]);
 }
 
+// the profiling policy of the context, once per block
+#define VR_VREDUCE_PROF(KERNEL, T, ...)                                        \
+  {                                                                            \
+    const verrou_context_t *ctx = (const verrou_context_t *)context;          \
+    if (ctx->profile_error)                                                    \
+      return KERNEL<T, vr_profError>(__VA_ARGS__, context);                    \
+    if (ctx->profile_exact)                                                    \
+      return KERNEL<T, vr_profExact>(__VA_ARGS__, context);                    \
+    return KERNEL<T, vr_noProf>(__VA_ARGS__, context);                         \
+  }
+
+void INTERFLOP_VECTOR_VERROU_API(reduce_sum_float_8)(const float *x, size_t n,
+                                                     float *acc, void *context)
+    VR_VREDUCE_PROF(vr_vreduce_sum, float, x, n, acc)
+
+void INTERFLOP_VECTOR_VERROU_API(reduce_sum_double_8)(const double *x,
+                                                      size_t n, double *acc,
+                                                      void *context)
+    VR_VREDUCE_PROF(vr_vreduce_sum, double, x, n, acc)
+
+void INTERFLOP_VECTOR_VERROU_API(reduce_dot_float_8)(const float *x,
+                                                     const float *y, size_t n,
+                                                     float *acc, void *context)
+    VR_VREDUCE_PROF(vr_vreduce_dot, float, x, y, n, acc)
+
+void INTERFLOP_VECTOR_VERROU_API(reduce_dot_double_8)(const double *x,
+                                                      const double *y,
+                                                      size_t n, double *acc,
+                                                      void *context)
+    VR_VREDUCE_PROF(vr_vreduce_dot, double, x, y, n, acc)
+
+#undef VR_VREDUCE_PROF
+
+// Rounding of the table entries: the mode of the context, or of the region
+// of the thread, resolved at each call, with the profiling policy PROF
+template <class PROF> struct vr_vselectedMode {
+  static const bool isStatic = false;
+  template <class OP> using type = VOpWithSelectedRoundingMode<OP, PROF>;
+};
+
+// Rounding of the table entries: the mode MODE, resolved at initialization
+template <enum vr_RoundingMode MODE, class HASH, class PROF>
+struct vr_vstaticMode {
+  static const bool isStatic = true;
+  template <class OP>
+  using type = VOpWithStaticRoundingMode<OP, MODE, HASH, PROF>;
+};
+
+// Entry point of the table with the rounding MODE, in the slot OPSLOT.*SLOT.
+// A static entry point calls the one of the region of the thread, as
+// VR_REGION_STATIC.
+template <class OP, int NB, class MODE, auto OPSLOT, auto SLOT>
+static void vr_vop_float(float *a, float *b, float *res, void *context) {
+  if constexpr (MODE::isStatic) {
+    const Vr_Region *region = vr_region;
+    if (__builtin_expect(region != nullptr, 0)) {
+      const auto fn = (region->backend.vbackend.scalar.*OPSLOT).*SLOT;
+      if (fn != vr_vop_float<OP, NB, MODE, OPSLOT, SLOT>) {
+        fn(a, b, res, context);
+        return;
+      }
+    }
+  }
+  vr_vapplyOp2<typename MODE::template type<OP>, NB>(a, b, res, context);
+}
+
+// Fills the float slots of the operation OPSLOT of the table with OP and MODE
+template <template <class> class OP, auto OPSLOT, class MODE>
+static inline void vr_vop_float_fill(struct interflop_vector_type_t &table) {
+  typedef typename std::remove_reference<decltype(table.*OPSLOT)>::type Slots;
+  (table.*OPSLOT).op_vector_float_1 =
+      vr_vop_float<OP<float>, 1, MODE, OPSLOT, &Slots::op_vector_float_1>;
+  (table.*OPSLOT).op_vector_float_4 =
+      vr_vop_float<OP<vr_vfloat<4>>, 4, MODE, OPSLOT,
+                   &Slots::op_vector_float_4>;
+  (table.*OPSLOT).op_vector_float_8 =
+      vr_vop_float<OP<vr_vfloat<8>>, 8, MODE, OPSLOT,
+                   &Slots::op_vector_float_8>;
+  (table.*OPSLOT).op_vector_float_16 =
+      vr_vop_float<OP<vr_vfloat<16>>, 16, MODE, OPSLOT,
+                   &Slots::op_vector_float_16>;
+}
+
+// The table with the rounding MODE
+template <class MODE>
+static struct interflop_vector_type_t vr_vbackend(void) {
+  typedef struct interflop_vector_type_t T;
+  struct interflop_vector_type_t vbackend;
+  vr_vop_float_fill<AddOp, &T::add, MODE>(vbackend);
+  vr_vop_float_fill<SubOp, &T::sub, MODE>(vbackend);
+  vr_vop_float_fill<MulOp, &T::mul, MODE>(vbackend);
+  vr_vop_float_fill<DivOp, &T::div, MODE>(vbackend);
+  return vbackend;
+}
+
+// The static tables of the det and comdet modes with the hash HASH, F of
+// vr_detHashDispatch
+template <class HASH> struct vr_vstaticDetBackend {
+  template <enum vr_RoundingMode MODE, class PROF>
+  using Static = vr_vstaticMode<MODE, HASH, PROF>;
+
+  // PROF is deduced from its tag argument
+  template <class PROF>
+  static struct interflop_vector_type_t apply(const verrou_context_t *ctx,
+                                              PROF) {
+    switch (ctx->rounding_mode) {
+    case VR_RANDOM_DET:
+      return vr_vbackend<Static<VR_RANDOM_DET, PROF>>();
+    case VR_RANDOM_COMDET:
+      return vr_vbackend<Static<VR_RANDOM_COMDET, PROF>>();
+    case VR_AVERAGE_DET:
+      return vr_vbackend<Static<VR_AVERAGE_DET, PROF>>();
+    case VR_AVERAGE_COMDET:
+      return vr_vbackend<Static<VR_AVERAGE_COMDET, PROF>>();
+    case VR_PRANDOM_DET:
+      return vr_vbackend<Static<VR_PRANDOM_DET, PROF>>();
+    case VR_PRANDOM_COMDET:
+      return vr_vbackend<Static<VR_PRANDOM_COMDET, PROF>>();
+    default:
+      return vr_vbackend<vr_vselectedMode<PROF>>();
+    }
+  }
+};
+
+// The table of --static-backend: the modes without a vector implementation
+// keep the dynamic entries, which report them at the first call
+template <class PROF>
+static struct interflop_vector_type_t
+vr_vstatic_backend(const verrou_context_t *ctx) {
+  switch (ctx->rounding_mode) {
+  case VR_NEAREST:
+  case VR_NATIVE:
+    return vr_vbackend<vr_vstaticMode<VR_NEAREST, void, PROF>>();
+  case VR_UPWARD:
+    return vr_vbackend<vr_vstaticMode<VR_UPWARD, void, PROF>>();
+  case VR_DOWNWARD:
+    return vr_vbackend<vr_vstaticMode<VR_DOWNWARD, void, PROF>>();
+  case VR_RANDOM:
+    return vr_vbackend<vr_vstaticMode<VR_RANDOM, void, PROF>>();
+  case VR_AVERAGE:
+    return vr_vbackend<vr_vstaticMode<VR_AVERAGE, void, PROF>>();
+  case VR_PRANDOM:
+    return vr_vbackend<vr_vstaticMode<VR_PRANDOM, void, PROF>>();
+  case VR_RANDOM_DET:
+  case VR_RANDOM_COMDET:
+  case VR_AVERAGE_DET:
+  case VR_AVERAGE_COMDET:
+  case VR_PRANDOM_DET:
+  case VR_PRANDOM_COMDET:
+    return vr_detHashDispatch<vr_vstaticDetBackend>(ctx->det_hash, ctx,
+                                                    PROF());
+  default:
+    return vr_vbackend<vr_vselectedMode<PROF>>();
+  }
+}
+
+// context may be NULL; otherwise its profiling policy, and --static-backend,
+// select the table
 struct interflop_vector_type_t INTERFLOP_VECTOR_VERROU_API(init)(void *context)
 {
+  const verrou_context_t *ctx = (const verrou_context_t *)context;
+  if (ctx != nullptr && ctx->static_backend) {
+    if (ctx->profile_error)
+      return vr_vstatic_backend<vr_profError>(ctx);
+    if (ctx->profile_exact)
+      return vr_vstatic_backend<vr_profExact>(ctx);
+    return vr_vstatic_backend<vr_noProf>(ctx);
+  }
+  if (ctx != nullptr && ctx->profile_error)
+    return vr_vbackend<vr_vselectedMode<vr_profError>>();
+  if (ctx != nullptr && ctx->profile_exact)
+    return vr_vbackend<vr_vselectedMode<vr_profExact>>();
+
   struct interflop_vector_type_t vbackend = {
     add : {
       op_vector_float_1 : INTERFLOP_VECTOR_VERROU_API(add_float_1),
@@ -341,4 +677,6 @@ struct interflop_vector_type_t INTERFLOP_VECTOR_VERROU_API(init)(void *context)
     }
   };
   return vbackend;
-}
\ No newline at end of file
+}
+
+#pragma GCC diagnostic pop
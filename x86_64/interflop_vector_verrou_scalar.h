@@ -33,6 +33,8 @@
 #ifndef __INTERFLOP_VECTOR_VERROU_SCALAR_H
 #define __INTERFLOP_VECTOR_VERROU_SCALAR_H
 
+#include <stddef.h>
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -72,6 +74,77 @@ void INTERFLOP_VECTOR_VERROU_API(div_float_8)(float *a, float *b, float *c,
                                           void *context);
 void INTERFLOP_VECTOR_VERROU_API(div_float_16)(float *a, float *b, float *c,
                                           void *context);
+/* double and conversion kernels: not yet part of interflop_vector_type_t */
+void INTERFLOP_VECTOR_VERROU_API(add_double_1)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(add_double_2)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(add_double_4)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(add_double_8)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(sub_double_1)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(sub_double_2)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(sub_double_4)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(sub_double_8)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(mul_double_1)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(mul_double_2)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(mul_double_4)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(mul_double_8)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(div_double_1)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(div_double_2)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(div_double_4)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(div_double_8)(double *a, double *b, double *c,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_1)(double *a, float *b,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_2)(double *a, float *b,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_4)(double *a, float *b,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(cast_double_to_float_8)(double *a, float *b,
+                                          void *context);
+/* fma kernels: not yet part of interflop_vector_type_t */
+void INTERFLOP_VECTOR_VERROU_API(fma_float_1)(float *a, float *b, float *c, float *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_float_4)(float *a, float *b, float *c, float *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_float_8)(float *a, float *b, float *c, float *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_float_16)(float *a, float *b, float *c, float *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_double_1)(double *a, double *b, double *c, double *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_double_2)(double *a, double *b, double *c, double *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_double_4)(double *a, double *b, double *c, double *res,
+                                          void *context);
+void INTERFLOP_VECTOR_VERROU_API(fma_double_8)(double *a, double *b, double *c, double *res,
+                                          void *context);
+/* lanes of verrou_sum, verrou_dot and verrou_nrm2, n a multiple of 8 */
+void INTERFLOP_VECTOR_VERROU_API(reduce_sum_float_8)(const float *x, size_t n,
+                                                     float *acc, void *context);
+void INTERFLOP_VECTOR_VERROU_API(reduce_sum_double_8)(const double *x,
+                                                      size_t n, double *acc,
+                                                      void *context);
+void INTERFLOP_VECTOR_VERROU_API(reduce_dot_float_8)(const float *x,
+                                                     const float *y, size_t n,
+                                                     float *acc, void *context);
+void INTERFLOP_VECTOR_VERROU_API(reduce_dot_double_8)(const double *x,
+                                                      const double *y,
+                                                      size_t n, double *acc,
+                                                      void *context);
 struct interflop_vector_type_t INTERFLOP_VECTOR_VERROU_API(init)(void *context);
 
 #ifdef __cplusplus
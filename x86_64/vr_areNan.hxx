@@ -39,6 +39,7 @@
 
 #include "interflop/interflop_stdlib.h"
 #include "interflop_verrou.h"
+#include "vr_simd.hxx"
 
 template <class REALTYPE> inline __m128i areNan(const REALTYPE &x) {
   interflop_panic("isNan called on an unknown type");
@@ -73,38 +74,52 @@ template <> inline __m128i areNan<__m128>(const __m128 &x) {
   return false;
 }
 */
-template <class REALTYPE> inline __m128i hasNanInf(const REALTYPE &x) {
+template <class REALTYPE>
+inline typename vr_laneMask<REALTYPE>::type hasNanInf(const REALTYPE &x) {
   interflop_panic("isNanInf called on an unknown type");
   return _mm_set1_epi32( 0);
 }
 
 
 #if defined(__SSE4_2__)
-template <> inline __m128i hasNanInf<__m128d>(const __m128d &x) {
+template <> inline __m128d hasNanInf<__m128d>(const __m128d &x) {
   static const __m128i mask = _mm_set1_epi64x (0x7ff0000000000000);
   const __m128i X = _mm_castpd_si128(x);
-  return _mm_cmpeq_epi64 (_mm_and_si128 (X, mask), mask);
+  return _mm_castsi128_pd (_mm_cmpeq_epi64 (_mm_and_si128 (X, mask), mask));
 }
 
-template <> inline __m128i hasNanInf<__m128>(const __m128 &x) {
+template <> inline __m128 hasNanInf<__m128>(const __m128 &x) {
 
   static const __m128i v_mask = _mm_set1_epi32 (0x7f800000);
   const __m128i  v_X = _mm_castps_si128 (x);
-  return _mm_cmpeq_epi32 (_mm_and_si128 ( v_X, v_mask), v_mask);
+  return _mm_castsi128_ps (_mm_cmpeq_epi32 (_mm_and_si128 ( v_X, v_mask), v_mask));
 }
 #endif
 
 #if defined(__AVX2__)
-template <> inline __m128i hasNanInf<__m256>(const __m256 &x) {
+template <> inline __m256d hasNanInf<__m256d>(const __m256d &x) {
+  static const __m256i mask = _mm256_set1_epi64x (0x7ff0000000000000);
+  const __m256i X = _mm256_castpd_si256 (x);
+  return _mm256_castsi256_pd (_mm256_cmpeq_epi64 (_mm256_and_si256 (X, mask), mask));
+}
+
+template <> inline __m256 hasNanInf<__m256>(const __m256 &x) {
   static const __m256i v_mask = _mm256_set1_epi32 (0x7f800000);
   const __m256i  v_X = _mm256_castps_si256 (x);
-  __m256i eqNan = _mm256_cmpeq_epi32 (_mm256_and_si256 ( v_X, v_mask), v_mask);
+  return _mm256_castsi256_ps (_mm256_cmpeq_epi32 (_mm256_and_si256 ( v_X, v_mask), v_mask));
+}
+#endif
 
-  uint32_t acc_gather[8];
-  uint16_t acc_reduce[8]; 
-  _mm256_storeu_si256 ( (__m256i_u *)acc_gather, eqNan);
-  for (int i = 0; i < 8; i++) acc_reduce[i] = acc_gather[i];
+#if defined(__AVX512F__)
+template <> inline __mmask8 hasNanInf<__m512d>(const __m512d &x) {
+  static const __m512i mask = _mm512_set1_epi64 (0x7ff0000000000000);
+  const __m512i X = _mm512_castpd_si512 (x);
+  return _mm512_cmpeq_epi64_mask (_mm512_and_si512 (X, mask), mask);
+}
 
-  return _mm_loadu_si128((__m128i_u *)acc_reduce);
+template <> inline __mmask16 hasNanInf<__m512>(const __m512 &x) {
+  static const __m512i v_mask = _mm512_set1_epi32 (0x7f800000);
+  const __m512i  v_X = _mm512_castps_si512 (x);
+  return _mm512_cmpeq_epi32_mask (_mm512_and_si512 ( v_X, v_mask), v_mask);
 }
 #endif
@@ -82,7 +82,7 @@ template<> inline __m256 nextTowardZero<__m256>(__m256 a) {
 
 #if defined(__SSE2__)
 template <> inline __m128 nextAfter<__m128>(__m128 a) {
-  __m128 ge_zero = _mm_cmpeq_ps (a, _mm_setzero_ps());
+  __m128 ge_zero = _mm_cmpge_ps (a, _mm_setzero_ps());
   __m128 ret = _mm_blendv_ps (nextTowardZero(a), nextAwayFromZero(a), ge_zero);
   return ret;
 }
@@ -90,7 +90,7 @@ template <> inline __m128 nextAfter<__m128>(__m128 a) {
 
 #if defined(__AVX2__)
 template <> inline __m256 nextAfter<__m256>(__m256 a) {
-  __m256 ge_zero = _mm256_cmp_ps (a, _mm256_setzero_ps(), _CMP_EQ_OQ);
+  __m256 ge_zero = _mm256_cmp_ps (a, _mm256_setzero_ps(), _CMP_GE_OQ);
   __m256 ret = _mm256_blendv_ps (nextTowardZero(a), nextAwayFromZero(a), ge_zero);
   return ret;
 }
@@ -118,4 +118,124 @@ template<> inline __m256 nextPrev (__m256 a) {
   res            = _mm256_blendv_ps (res, nextAwayFromZero(a), lt_zero);
   return res;
 }
-#endif
\ No newline at end of file
+#endif
+
+#if defined(__SSE2__)
+template<> inline __m128d nextAwayFromZero<__m128d>(__m128d a) {
+  static const __m128i c_one128 = _mm_set1_epi64x (1);
+  __m128d x = a;
+  __m128i u = _mm_castpd_si128 (x);
+  u = _mm_add_epi64 (u, c_one128);
+  x = _mm_castsi128_pd (u);
+  return x;
+}
+
+template<> inline __m128d nextTowardZero<__m128d>(__m128d a) {
+  static const __m128i c_one128 = _mm_set1_epi64x (1);
+  __m128d x = a;
+  __m128i u = _mm_castpd_si128 (x);
+  u = _mm_sub_epi64 (u, c_one128);
+  x = _mm_castsi128_pd (u);
+  return x;
+}
+
+template <> inline __m128d nextAfter<__m128d>(__m128d a) {
+  __m128d ge_zero = _mm_cmpge_pd (a, _mm_setzero_pd());
+  __m128d ret = _mm_blendv_pd (nextTowardZero(a), nextAwayFromZero(a), ge_zero);
+  return ret;
+}
+
+template<> inline __m128d nextPrev (__m128d a) {
+  __m128d eq_zero = _mm_cmpeq_pd (a, _mm_setzero_pd());
+  __m128d gt_zero = _mm_cmpgt_pd (a, _mm_setzero_pd());
+  __m128d lt_zero = _mm_cmplt_pd (a, _mm_setzero_pd());
+  __m128d res     = _mm_blendv_pd (a, _mm_set1_pd(-std::numeric_limits<double>::denorm_min()), eq_zero);
+  res             = _mm_blendv_pd (res, nextTowardZero(a), gt_zero);
+  res             = _mm_blendv_pd (res, nextAwayFromZero(a), lt_zero);
+  return res;
+}
+#endif
+
+#if defined(__AVX2__)
+template<> inline __m256d nextAwayFromZero<__m256d>(__m256d a) {
+  static const __m256i c_one256 = _mm256_set1_epi64x (1);
+  __m256d x = a;
+  __m256i u = _mm256_castpd_si256 (x);
+  u = _mm256_add_epi64 (u, c_one256);
+  x = _mm256_castsi256_pd (u);
+  return x;
+}
+
+template<> inline __m256d nextTowardZero<__m256d>(__m256d a) {
+  static const __m256i c_one256 = _mm256_set1_epi64x (1);
+  __m256d x = a;
+  __m256i u = _mm256_castpd_si256 (x);
+  u = _mm256_sub_epi64 (u, c_one256);
+  x = _mm256_castsi256_pd (u);
+  return x;
+}
+
+template <> inline __m256d nextAfter<__m256d>(__m256d a) {
+  __m256d ge_zero = _mm256_cmp_pd (a, _mm256_setzero_pd(), _CMP_GE_OQ);
+  __m256d ret = _mm256_blendv_pd (nextTowardZero(a), nextAwayFromZero(a), ge_zero);
+  return ret;
+}
+
+template<> inline __m256d nextPrev (__m256d a) {
+  __m256d eq_zero = _mm256_cmp_pd (a, _mm256_setzero_pd(), _CMP_EQ_OQ);
+  __m256d gt_zero = _mm256_cmp_pd (a, _mm256_setzero_pd(), _CMP_GT_OQ);
+  __m256d lt_zero = _mm256_cmp_pd (a, _mm256_setzero_pd(), _CMP_LT_OQ);
+  __m256d res     = _mm256_blendv_pd (a, _mm256_set1_pd(-std::numeric_limits<double>::denorm_min()), eq_zero);
+  res             = _mm256_blendv_pd (res, nextTowardZero(a), gt_zero);
+  res             = _mm256_blendv_pd (res, nextAwayFromZero(a), lt_zero);
+  return res;
+}
+#endif
+
+#if defined(__AVX512F__)
+template<> inline __m512 nextAwayFromZero<__m512>(__m512 a) {
+  return _mm512_castsi512_ps (_mm512_add_epi32 (_mm512_castps_si512 (a), _mm512_set1_epi32 (1)));
+}
+
+template<> inline __m512 nextTowardZero<__m512>(__m512 a) {
+  return _mm512_castsi512_ps (_mm512_sub_epi32 (_mm512_castps_si512 (a), _mm512_set1_epi32 (1)));
+}
+
+template <> inline __m512 nextAfter<__m512>(__m512 a) {
+  __mmask16 ge_zero = _mm512_cmp_ps_mask (a, _mm512_setzero_ps(), _CMP_GE_OQ);
+  return _mm512_mask_blend_ps (ge_zero, nextTowardZero(a), nextAwayFromZero(a));
+}
+
+template<> inline __m512 nextPrev (__m512 a) {
+  __mmask16 eq_zero = _mm512_cmp_ps_mask (a, _mm512_setzero_ps(), _CMP_EQ_OQ);
+  __mmask16 gt_zero = _mm512_cmp_ps_mask (a, _mm512_setzero_ps(), _CMP_GT_OQ);
+  __mmask16 lt_zero = _mm512_cmp_ps_mask (a, _mm512_setzero_ps(), _CMP_LT_OQ);
+  __m512 res = _mm512_mask_blend_ps (eq_zero, a, _mm512_set1_ps(-std::numeric_limits<float>::denorm_min()));
+  res        = _mm512_mask_blend_ps (gt_zero, res, nextTowardZero(a));
+  res        = _mm512_mask_blend_ps (lt_zero, res, nextAwayFromZero(a));
+  return res;
+}
+
+template<> inline __m512d nextAwayFromZero<__m512d>(__m512d a) {
+  return _mm512_castsi512_pd (_mm512_add_epi64 (_mm512_castpd_si512 (a), _mm512_set1_epi64 (1)));
+}
+
+template<> inline __m512d nextTowardZero<__m512d>(__m512d a) {
+  return _mm512_castsi512_pd (_mm512_sub_epi64 (_mm512_castpd_si512 (a), _mm512_set1_epi64 (1)));
+}
+
+template <> inline __m512d nextAfter<__m512d>(__m512d a) {
+  __mmask8 ge_zero = _mm512_cmp_pd_mask (a, _mm512_setzero_pd(), _CMP_GE_OQ);
+  return _mm512_mask_blend_pd (ge_zero, nextTowardZero(a), nextAwayFromZero(a));
+}
+
+template<> inline __m512d nextPrev (__m512d a) {
+  __mmask8 eq_zero = _mm512_cmp_pd_mask (a, _mm512_setzero_pd(), _CMP_EQ_OQ);
+  __mmask8 gt_zero = _mm512_cmp_pd_mask (a, _mm512_setzero_pd(), _CMP_GT_OQ);
+  __mmask8 lt_zero = _mm512_cmp_pd_mask (a, _mm512_setzero_pd(), _CMP_LT_OQ);
+  __m512d res = _mm512_mask_blend_pd (eq_zero, a, _mm512_set1_pd(-std::numeric_limits<double>::denorm_min()));
+  res         = _mm512_mask_blend_pd (gt_zero, res, nextTowardZero(a));
+  res         = _mm512_mask_blend_pd (lt_zero, res, nextAwayFromZero(a));
+  return res;
+}
+#endif
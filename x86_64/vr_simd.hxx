@@ -0,0 +1,205 @@
+/*--------------------------------------------------------------------*/
+/*--- Verrou: a FPU instrumentation tool.                          ---*/
+/*--- Lane-wise primitives of the SIMD types used by the vector    ---*/
+/*--- rounding modes.                                              ---*/
+/*---                                                  vr_simd.hxx ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Verrou, a FPU instrumentation tool.
+
+   Copyright (C) 2014-2021 EDF
+     F. Févotte     <francois.fevotte@edf.fr>
+     B. Lathuilière <bruno.lathuiliere@edf.fr>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307, USA.
+
+   The GNU Lesser General Public License is contained in the file COPYING.
+*/
+
+#pragma once
+#include <immintrin.h>
+
+#include "../vr_op.hxx"
+
+/*
+ * vr_simd<VT> gathers the few lane-wise operations needed to write the
+ * rounding modes once for every SIMD type VT:
+ *  - ScalarType : type of one lane
+ *  - MaskType   : type of the result of the comparisons
+ *  - blend(a, b, m) returns b in the lanes selected by m, a elsewhere
+ *  - maskAnd(m1, m2) returns m1 & m2, maskAndNot(m1, m2) returns m1 & ~m2
+ * The scalar specializations are only used by the scalar fallbacks of the
+ * vector entry points.
+ * getTypeHash is specialized so that the deterministic hashes of a vector
+ * operation are the ones of the scalar operation, lane by lane.
+ */
+template <class VT> struct vr_simd;
+
+template <> struct vr_simd<float> {
+  typedef float ScalarType;
+  static const int nbLanes = 1;
+  static inline float loadu (const float *x) { return *x; }
+  static inline void storeu (float *x, float v) { *x = v; }
+};
+
+template <> struct vr_simd<double> {
+  typedef double ScalarType;
+  static const int nbLanes = 1;
+  static inline double loadu (const double *x) { return *x; }
+  static inline void storeu (double *x, double v) { *x = v; }
+};
+
+#if defined(__SSE4_2__)
+template <> struct vr_laneMask<__m128> { typedef __m128 type; };
+template <> struct vr_laneMask<__m128d> { typedef __m128d type; };
+template <> inline uint64_t getTypeHash<__m128>() { return typeHash::floatHash; }
+template <> inline uint64_t getTypeHash<__m128d>() { return typeHash::doubleHash; }
+
+template <> struct vr_simd<__m128> {
+  typedef float ScalarType;
+  typedef __m128 MaskType;
+  static const int nbLanes = 4;
+  static inline __m128 zero () { return _mm_setzero_ps (); }
+  static inline __m128 set1 (float x) { return _mm_set1_ps (x); }
+  static inline __m128 loadu (const float *x) { return _mm_loadu_ps (x); }
+  static inline void storeu (float *x, __m128 v) { _mm_storeu_ps (x, v); }
+  static inline __m128 sub (__m128 a, __m128 b) { return _mm_sub_ps (a, b); }
+  static inline __m128 mul (__m128 a, __m128 b) { return _mm_mul_ps (a, b); }
+  static inline MaskType cmplt (__m128 a, __m128 b) { return _mm_cmplt_ps (a, b); }
+  static inline MaskType cmpgt (__m128 a, __m128 b) { return _mm_cmpgt_ps (a, b); }
+  static inline MaskType cmpeq (__m128 a, __m128 b) { return _mm_cmpeq_ps (a, b); }
+  static inline MaskType maskAnd (MaskType m1, MaskType m2) { return _mm_and_ps (m1, m2); }
+  static inline MaskType maskAndNot (MaskType m1, MaskType m2) { return _mm_andnot_ps (m2, m1); }
+  static inline bool any (MaskType m) { return _mm_movemask_ps (m) != 0; }
+  static inline int count (MaskType m) { return __builtin_popcount (_mm_movemask_ps (m)); }
+  static inline __m128 blend (__m128 a, __m128 b, MaskType m) { return _mm_blendv_ps (a, b, m); }
+};
+
+template <> struct vr_simd<__m128d> {
+  typedef double ScalarType;
+  typedef __m128d MaskType;
+  static const int nbLanes = 2;
+  static inline __m128d zero () { return _mm_setzero_pd (); }
+  static inline __m128d set1 (double x) { return _mm_set1_pd (x); }
+  static inline __m128d loadu (const double *x) { return _mm_loadu_pd (x); }
+  static inline void storeu (double *x, __m128d v) { _mm_storeu_pd (x, v); }
+  static inline __m128d sub (__m128d a, __m128d b) { return _mm_sub_pd (a, b); }
+  static inline __m128d mul (__m128d a, __m128d b) { return _mm_mul_pd (a, b); }
+  static inline MaskType cmplt (__m128d a, __m128d b) { return _mm_cmplt_pd (a, b); }
+  static inline MaskType cmpgt (__m128d a, __m128d b) { return _mm_cmpgt_pd (a, b); }
+  static inline MaskType cmpeq (__m128d a, __m128d b) { return _mm_cmpeq_pd (a, b); }
+  static inline MaskType maskAnd (MaskType m1, MaskType m2) { return _mm_and_pd (m1, m2); }
+  static inline MaskType maskAndNot (MaskType m1, MaskType m2) { return _mm_andnot_pd (m2, m1); }
+  static inline bool any (MaskType m) { return _mm_movemask_pd (m) != 0; }
+  static inline int count (MaskType m) { return __builtin_popcount (_mm_movemask_pd (m)); }
+  static inline __m128d blend (__m128d a, __m128d b, MaskType m) { return _mm_blendv_pd (a, b, m); }
+};
+#endif
+
+#if defined(__AVX2__)
+template <> struct vr_laneMask<__m256> { typedef __m256 type; };
+template <> struct vr_laneMask<__m256d> { typedef __m256d type; };
+template <> inline uint64_t getTypeHash<__m256>() { return typeHash::floatHash; }
+template <> inline uint64_t getTypeHash<__m256d>() { return typeHash::doubleHash; }
+
+template <> struct vr_simd<__m256> {
+  typedef float ScalarType;
+  typedef __m256 MaskType;
+  static const int nbLanes = 8;
+  static inline __m256 zero () { return _mm256_setzero_ps (); }
+  static inline __m256 set1 (float x) { return _mm256_set1_ps (x); }
+  static inline __m256 loadu (const float *x) { return _mm256_loadu_ps (x); }
+  static inline void storeu (float *x, __m256 v) { _mm256_storeu_ps (x, v); }
+  static inline __m256 sub (__m256 a, __m256 b) { return _mm256_sub_ps (a, b); }
+  static inline __m256 mul (__m256 a, __m256 b) { return _mm256_mul_ps (a, b); }
+  static inline MaskType cmplt (__m256 a, __m256 b) { return _mm256_cmp_ps (a, b, _CMP_LT_OQ); }
+  static inline MaskType cmpgt (__m256 a, __m256 b) { return _mm256_cmp_ps (a, b, _CMP_GT_OQ); }
+  static inline MaskType cmpeq (__m256 a, __m256 b) { return _mm256_cmp_ps (a, b, _CMP_EQ_OQ); }
+  static inline MaskType maskAnd (MaskType m1, MaskType m2) { return _mm256_and_ps (m1, m2); }
+  static inline MaskType maskAndNot (MaskType m1, MaskType m2) { return _mm256_andnot_ps (m2, m1); }
+  static inline bool any (MaskType m) { return _mm256_movemask_ps (m) != 0; }
+  static inline int count (MaskType m) { return __builtin_popcount (_mm256_movemask_ps (m)); }
+  static inline __m256 blend (__m256 a, __m256 b, MaskType m) { return _mm256_blendv_ps (a, b, m); }
+};
+
+template <> struct vr_simd<__m256d> {
+  typedef double ScalarType;
+  typedef __m256d MaskType;
+  static const int nbLanes = 4;
+  static inline __m256d zero () { return _mm256_setzero_pd (); }
+  static inline __m256d set1 (double x) { return _mm256_set1_pd (x); }
+  static inline __m256d loadu (const double *x) { return _mm256_loadu_pd (x); }
+  static inline void storeu (double *x, __m256d v) { _mm256_storeu_pd (x, v); }
+  static inline __m256d sub (__m256d a, __m256d b) { return _mm256_sub_pd (a, b); }
+  static inline __m256d mul (__m256d a, __m256d b) { return _mm256_mul_pd (a, b); }
+  static inline MaskType cmplt (__m256d a, __m256d b) { return _mm256_cmp_pd (a, b, _CMP_LT_OQ); }
+  static inline MaskType cmpgt (__m256d a, __m256d b) { return _mm256_cmp_pd (a, b, _CMP_GT_OQ); }
+  static inline MaskType cmpeq (__m256d a, __m256d b) { return _mm256_cmp_pd (a, b, _CMP_EQ_OQ); }
+  static inline MaskType maskAnd (MaskType m1, MaskType m2) { return _mm256_and_pd (m1, m2); }
+  static inline MaskType maskAndNot (MaskType m1, MaskType m2) { return _mm256_andnot_pd (m2, m1); }
+  static inline bool any (MaskType m) { return _mm256_movemask_pd (m) != 0; }
+  static inline int count (MaskType m) { return __builtin_popcount (_mm256_movemask_pd (m)); }
+  static inline __m256d blend (__m256d a, __m256d b, MaskType m) { return _mm256_blendv_pd (a, b, m); }
+};
+#endif
+
+#if defined(__AVX512F__)
+template <> struct vr_laneMask<__m512> { typedef __mmask16 type; };
+template <> struct vr_laneMask<__m512d> { typedef __mmask8 type; };
+template <> inline uint64_t getTypeHash<__m512>() { return typeHash::floatHash; }
+template <> inline uint64_t getTypeHash<__m512d>() { return typeHash::doubleHash; }
+
+template <> struct vr_simd<__m512> {
+  typedef float ScalarType;
+  typedef __mmask16 MaskType;
+  static const int nbLanes = 16;
+  static inline __m512 zero () { return _mm512_setzero_ps (); }
+  static inline __m512 set1 (float x) { return _mm512_set1_ps (x); }
+  static inline __m512 loadu (const float *x) { return _mm512_loadu_ps (x); }
+  static inline void storeu (float *x, __m512 v) { _mm512_storeu_ps (x, v); }
+  static inline __m512 sub (__m512 a, __m512 b) { return _mm512_sub_ps (a, b); }
+  static inline __m512 mul (__m512 a, __m512 b) { return _mm512_mul_ps (a, b); }
+  static inline MaskType cmplt (__m512 a, __m512 b) { return _mm512_cmp_ps_mask (a, b, _CMP_LT_OQ); }
+  static inline MaskType cmpgt (__m512 a, __m512 b) { return _mm512_cmp_ps_mask (a, b, _CMP_GT_OQ); }
+  static inline MaskType cmpeq (__m512 a, __m512 b) { return _mm512_cmp_ps_mask (a, b, _CMP_EQ_OQ); }
+  static inline MaskType maskAnd (MaskType m1, MaskType m2) { return m1 & m2; }
+  static inline MaskType maskAndNot (MaskType m1, MaskType m2) { return m1 & ~m2; }
+  static inline bool any (MaskType m) { return m != 0; }
+  static inline int count (MaskType m) { return __builtin_popcount (m); }
+  static inline __m512 blend (__m512 a, __m512 b, MaskType m) { return _mm512_mask_blend_ps (m, a, b); }
+};
+
+template <> struct vr_simd<__m512d> {
+  typedef double ScalarType;
+  typedef __mmask8 MaskType;
+  static const int nbLanes = 8;
+  static inline __m512d zero () { return _mm512_setzero_pd (); }
+  static inline __m512d set1 (double x) { return _mm512_set1_pd (x); }
+  static inline __m512d loadu (const double *x) { return _mm512_loadu_pd (x); }
+  static inline void storeu (double *x, __m512d v) { _mm512_storeu_pd (x, v); }
+  static inline __m512d sub (__m512d a, __m512d b) { return _mm512_sub_pd (a, b); }
+  static inline __m512d mul (__m512d a, __m512d b) { return _mm512_mul_pd (a, b); }
+  static inline MaskType cmplt (__m512d a, __m512d b) { return _mm512_cmp_pd_mask (a, b, _CMP_LT_OQ); }
+  static inline MaskType cmpgt (__m512d a, __m512d b) { return _mm512_cmp_pd_mask (a, b, _CMP_GT_OQ); }
+  static inline MaskType cmpeq (__m512d a, __m512d b) { return _mm512_cmp_pd_mask (a, b, _CMP_EQ_OQ); }
+  static inline MaskType maskAnd (MaskType m1, MaskType m2) { return m1 & m2; }
+  static inline MaskType maskAndNot (MaskType m1, MaskType m2) { return m1 & ~m2; }
+  static inline bool any (MaskType m) { return m != 0; }
+  static inline int count (MaskType m) { return __builtin_popcount (m); }
+  static inline __m512d blend (__m512d a, __m512d b, MaskType m) { return _mm512_mask_blend_pd (m, a, b); }
+};
+#endif
@@ -0,0 +1,588 @@
+/*--------------------------------------------------------------------*/
+/*--- Verrou: a FPU instrumentation tool.                          ---*/
+/*--- SIMD versions of the deterministic hashes.                   ---*/
+/*---                                                  vr_vhash.hxx ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Verrou, a FPU instrumentation tool.
+
+   Copyright (C) 2014-2021 EDF
+     F. Févotte     <francois.fevotte@edf.fr>
+     B. Lathuilière <bruno.lathuiliere@edf.fr>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307, USA.
+
+   The GNU Lesser General Public License is contained in the file COPYING.
+*/
+
+#pragma once
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "../vr_rand_implem.h"
+#include "vr_simd.hxx"
+
+/*
+ * vr_vhash<HASH> hashes one argument pack per lane and returns the same
+ * booleans and ratios as the scalar HASH (../tableHash.hxx, ...) on every
+ * lane, so that the det and comdet modes do not depend on the vector width:
+ *  - hashBool<OUT>(r, pack, hashOp) returns a vr_simd<OUT>::MaskType
+ *  - hashRatio<OUT>(r, pack, hashOp) returns an OUT in [0,1)
+ * OUT is the result type of the operation: it differs from the type of the
+ * arguments for the casts.
+ */
+
+/*
+ * vr_simdi<VI> gathers the integer operations used by the hashes, on the
+ * 32-bit or 64-bit lanes of the integer vector VI.
+ *  - mullo64 is the low half of the 64x64 bits product (no AVX512DQ)
+ *  - gather32/gather64 look up t with the 32/64-bit lanes of idx, and
+ *    return 32-bit values in 32/64-bit lanes
+ *  - widenLo/widenHi zero-extend the low/high 32-bit lanes to 64-bit lanes,
+ *    narrow(lo, hi) packs back the low halves of the 64-bit lanes
+ */
+template <class VI> struct vr_simdi;
+
+#if defined(__SSE4_2__)
+template <> struct vr_simdi<__m128i> {
+  static inline __m128i set1_32 (uint32_t x) { return _mm_set1_epi32 ((int)x); }
+  static inline __m128i set1_64 (uint64_t x) { return _mm_set1_epi64x ((long long)x); }
+  static inline __m128i and_ (__m128i a, __m128i b) { return _mm_and_si128 (a, b); }
+  static inline __m128i xor_ (__m128i a, __m128i b) { return _mm_xor_si128 (a, b); }
+  static inline __m128i add64 (__m128i a, __m128i b) { return _mm_add_epi64 (a, b); }
+  static inline __m128i srli32 (__m128i a, int n) { return _mm_srli_epi32 (a, n); }
+  static inline __m128i srli64 (__m128i a, int n) { return _mm_srli_epi64 (a, n); }
+  static inline __m128i mullo32 (__m128i a, __m128i b) { return _mm_mullo_epi32 (a, b); }
+  static inline __m128i mullo64 (__m128i a, __m128i b) {
+    const __m128i cross = _mm_add_epi64 (_mm_mul_epu32 (_mm_srli_epi64 (a, 32), b),
+                                         _mm_mul_epu32 (a, _mm_srli_epi64 (b, 32)));
+    return _mm_add_epi64 (_mm_mul_epu32 (a, b), _mm_slli_epi64 (cross, 32));
+  }
+  static inline __m128i gather32 (const uint32_t *t, __m128i idx) {
+#if defined(__AVX2__)
+    return _mm_i32gather_epi32 ((const int *)t, idx, 4);
+#else
+    uint32_t i[4];
+    _mm_storeu_si128 ((__m128i *)i, idx);
+    return _mm_setr_epi32 (t[i[0]], t[i[1]], t[i[2]], t[i[3]]);
+#endif
+  }
+  static inline __m128i gather64 (const uint32_t *t, __m128i idx) {
+#if defined(__AVX2__)
+    return _mm_cvtepu32_epi64 (_mm_i64gather_epi32 ((const int *)t, idx, 4));
+#else
+    uint64_t i[2];
+    _mm_storeu_si128 ((__m128i *)i, idx);
+    return _mm_set_epi64x (t[i[1]], t[i[0]]);
+#endif
+  }
+  static inline __m128i widenLo (__m128i a) { return _mm_cvtepu32_epi64 (a); }
+  static inline __m128i widenHi (__m128i a) { return _mm_cvtepu32_epi64 (_mm_srli_si128 (a, 8)); }
+  static inline __m128i narrow (__m128i lo, __m128i hi) {
+    return _mm_castps_si128 (_mm_shuffle_ps (_mm_castsi128_ps (lo), _mm_castsi128_ps (hi),
+                                             _MM_SHUFFLE (2, 0, 2, 0)));
+  }
+};
+#endif
+
+#if defined(__AVX2__)
+template <> struct vr_simdi<__m256i> {
+  static inline __m256i set1_32 (uint32_t x) { return _mm256_set1_epi32 ((int)x); }
+  static inline __m256i set1_64 (uint64_t x) { return _mm256_set1_epi64x ((long long)x); }
+  static inline __m256i and_ (__m256i a, __m256i b) { return _mm256_and_si256 (a, b); }
+  static inline __m256i xor_ (__m256i a, __m256i b) { return _mm256_xor_si256 (a, b); }
+  static inline __m256i add64 (__m256i a, __m256i b) { return _mm256_add_epi64 (a, b); }
+  static inline __m256i srli32 (__m256i a, int n) { return _mm256_srli_epi32 (a, n); }
+  static inline __m256i srli64 (__m256i a, int n) { return _mm256_srli_epi64 (a, n); }
+  static inline __m256i mullo32 (__m256i a, __m256i b) { return _mm256_mullo_epi32 (a, b); }
+  static inline __m256i mullo64 (__m256i a, __m256i b) {
+    const __m256i cross = _mm256_add_epi64 (_mm256_mul_epu32 (_mm256_srli_epi64 (a, 32), b),
+                                            _mm256_mul_epu32 (a, _mm256_srli_epi64 (b, 32)));
+    return _mm256_add_epi64 (_mm256_mul_epu32 (a, b), _mm256_slli_epi64 (cross, 32));
+  }
+  static inline __m256i gather32 (const uint32_t *t, __m256i idx) {
+    return _mm256_i32gather_epi32 ((const int *)t, idx, 4);
+  }
+  static inline __m256i gather64 (const uint32_t *t, __m256i idx) {
+    return _mm256_cvtepu32_epi64 (_mm256_i64gather_epi32 ((const int *)t, idx, 4));
+  }
+  static inline __m256i widenLo (__m256i a) { return _mm256_cvtepu32_epi64 (_mm256_castsi256_si128 (a)); }
+  static inline __m256i widenHi (__m256i a) { return _mm256_cvtepu32_epi64 (_mm256_extracti128_si256 (a, 1)); }
+  static inline __m256i narrow (__m256i lo, __m256i hi) {
+    const __m256 packed = _mm256_shuffle_ps (_mm256_castsi256_ps (lo), _mm256_castsi256_ps (hi),
+                                             _MM_SHUFFLE (2, 0, 2, 0));
+    return _mm256_permute4x64_epi64 (_mm256_castps_si256 (packed), _MM_SHUFFLE (3, 1, 2, 0));
+  }
+};
+#endif
+
+#if defined(__AVX512F__)
+template <> struct vr_simdi<__m512i> {
+  static inline __m512i set1_32 (uint32_t x) { return _mm512_set1_epi32 ((int)x); }
+  static inline __m512i set1_64 (uint64_t x) { return _mm512_set1_epi64 ((long long)x); }
+  static inline __m512i and_ (__m512i a, __m512i b) { return _mm512_and_si512 (a, b); }
+  static inline __m512i xor_ (__m512i a, __m512i b) { return _mm512_xor_si512 (a, b); }
+  static inline __m512i add64 (__m512i a, __m512i b) { return _mm512_add_epi64 (a, b); }
+  static inline __m512i srli32 (__m512i a, int n) { return _mm512_srli_epi32 (a, n); }
+  static inline __m512i srli64 (__m512i a, int n) { return _mm512_srli_epi64 (a, n); }
+  static inline __m512i mullo32 (__m512i a, __m512i b) { return _mm512_mullo_epi32 (a, b); }
+  static inline __m512i mullo64 (__m512i a, __m512i b) {
+    const __m512i cross = _mm512_add_epi64 (_mm512_mul_epu32 (_mm512_srli_epi64 (a, 32), b),
+                                            _mm512_mul_epu32 (a, _mm512_srli_epi64 (b, 32)));
+    return _mm512_add_epi64 (_mm512_mul_epu32 (a, b), _mm512_slli_epi64 (cross, 32));
+  }
+  static inline __m512i gather32 (const uint32_t *t, __m512i idx) {
+    return _mm512_i32gather_epi32 (idx, (const void *)t, 4);
+  }
+  static inline __m512i gather64 (const uint32_t *t, __m512i idx) {
+    return _mm512_cvtepu32_epi64 (_mm512_i64gather_epi32 (idx, (const void *)t, 4));
+  }
+  static inline __m512i widenLo (__m512i a) { return _mm512_cvtepu32_epi64 (_mm512_castsi512_si256 (a)); }
+  static inline __m512i widenHi (__m512i a) { return _mm512_cvtepu32_epi64 (_mm512_extracti64x4_epi64 (a, 1)); }
+  static inline __m512i narrow (__m512i lo, __m512i hi) {
+    return _mm512_inserti64x4 (_mm512_castsi256_si512 (_mm512_cvtepi64_epi32 (lo)),
+                               _mm512_cvtepi64_epi32 (hi), 1);
+  }
+};
+#endif
+
+/*
+ * vr_vlanes<VT> links the SIMD type VT to the integer vector of its bits.
+ * The hashes return one 32-bit value per lane of VT (zero-extended in the
+ * 64-bit lanes of the double types), turned into:
+ *  - maskOfBit(v, bit): the lanes where the bit of v is set
+ *  - ratio(v): v * 2^-32, rounded as the scalar (REALTYPE)(double)
+ */
+template <class VT> struct vr_vlanes;
+
+#if defined(__SSE4_2__)
+template <> struct vr_vlanes<__m128> {
+  typedef __m128i IntType;
+  static const bool is64 = false;
+  static inline __m128i bits (__m128 x) { return _mm_castps_si128 (x); }
+  static inline __m128i fromValues (const uint32_t *v) { return _mm_loadu_si128 ((const __m128i *)v); }
+  static inline __m128 maskOfBit (__m128i v, int bit) {
+    return _mm_castsi128_ps (_mm_srai_epi32 (_mm_slli_epi32 (v, 31 - bit), 31));
+  }
+  static inline __m128 ratio (__m128i v) {
+    // hi * 2^16 is exact: the addition is the only rounding
+    const __m128 hi = _mm_cvtepi32_ps (_mm_srli_epi32 (v, 16));
+    const __m128 lo = _mm_cvtepi32_ps (_mm_and_si128 (v, _mm_set1_epi32 (0xffff)));
+    const __m128 f = _mm_add_ps (_mm_mul_ps (hi, _mm_set1_ps (65536.f)), lo);
+    return _mm_mul_ps (f, _mm_set1_ps (0x1p-32f));
+  }
+};
+
+template <> struct vr_vlanes<__m128d> {
+  typedef __m128i IntType;
+  static const bool is64 = true;
+  static inline __m128i bits (__m128d x) { return _mm_castpd_si128 (x); }
+  static inline __m128i fromValues (const uint32_t *v) {
+    return _mm_cvtepu32_epi64 (_mm_loadl_epi64 ((const __m128i *)v));
+  }
+  static inline __m128d maskOfBit (__m128i v, int bit) {
+    return _mm_castsi128_pd (_mm_cmpgt_epi64 (_mm_setzero_si128 (), _mm_slli_epi64 (v, 63 - bit)));
+  }
+  static inline __m128d ratio (__m128i v) {
+    const __m128d d = _mm_sub_pd (_mm_castsi128_pd (_mm_or_si128 (v, _mm_set1_epi64x (0x4330000000000000LL))),
+                                  _mm_set1_pd (0x1p52));
+    return _mm_mul_pd (d, _mm_set1_pd (0x1p-32));
+  }
+};
+#endif
+
+#if defined(__AVX2__)
+template <> struct vr_vlanes<__m256> {
+  typedef __m256i IntType;
+  static const bool is64 = false;
+  static inline __m256i bits (__m256 x) { return _mm256_castps_si256 (x); }
+  static inline __m256i fromValues (const uint32_t *v) { return _mm256_loadu_si256 ((const __m256i *)v); }
+  static inline __m256 maskOfBit (__m256i v, int bit) {
+    return _mm256_castsi256_ps (_mm256_srai_epi32 (_mm256_slli_epi32 (v, 31 - bit), 31));
+  }
+  static inline __m256 ratio (__m256i v) {
+    // hi * 2^16 is exact: the addition is the only rounding
+    const __m256 hi = _mm256_cvtepi32_ps (_mm256_srli_epi32 (v, 16));
+    const __m256 lo = _mm256_cvtepi32_ps (_mm256_and_si256 (v, _mm256_set1_epi32 (0xffff)));
+    const __m256 f = _mm256_add_ps (_mm256_mul_ps (hi, _mm256_set1_ps (65536.f)), lo);
+    return _mm256_mul_ps (f, _mm256_set1_ps (0x1p-32f));
+  }
+};
+
+template <> struct vr_vlanes<__m256d> {
+  typedef __m256i IntType;
+  static const bool is64 = true;
+  static inline __m256i bits (__m256d x) { return _mm256_castpd_si256 (x); }
+  static inline __m256i fromValues (const uint32_t *v) {
+    return _mm256_cvtepu32_epi64 (_mm_loadu_si128 ((const __m128i *)v));
+  }
+  static inline __m256d maskOfBit (__m256i v, int bit) {
+    return _mm256_castsi256_pd (_mm256_cmpgt_epi64 (_mm256_setzero_si256 (), _mm256_slli_epi64 (v, 63 - bit)));
+  }
+  static inline __m256d ratio (__m256i v) {
+    const __m256d d = _mm256_sub_pd (_mm256_castsi256_pd (_mm256_or_si256 (v, _mm256_set1_epi64x (0x4330000000000000LL))),
+                                     _mm256_set1_pd (0x1p52));
+    return _mm256_mul_pd (d, _mm256_set1_pd (0x1p-32));
+  }
+};
+#endif
+
+#if defined(__AVX512F__)
+template <> struct vr_vlanes<__m512> {
+  typedef __m512i IntType;
+  static const bool is64 = false;
+  static inline __m512i bits (__m512 x) { return _mm512_castps_si512 (x); }
+  static inline __m512i fromValues (const uint32_t *v) { return _mm512_loadu_si512 ((const void *)v); }
+  static inline __mmask16 maskOfBit (__m512i v, int bit) {
+    return _mm512_test_epi32_mask (v, _mm512_set1_epi32 ((int)(1U << bit)));
+  }
+  static inline __m512 ratio (__m512i v) {
+    return _mm512_mul_ps (_mm512_cvtepu32_ps (v), _mm512_set1_ps (0x1p-32f));
+  }
+};
+
+template <> struct vr_vlanes<__m512d> {
+  typedef __m512i IntType;
+  static const bool is64 = true;
+  static inline __m512i bits (__m512d x) { return _mm512_castpd_si512 (x); }
+  static inline __m512i fromValues (const uint32_t *v) {
+    return _mm512_cvtepu32_epi64 (_mm256_loadu_si256 ((const __m256i *)v));
+  }
+  static inline __mmask8 maskOfBit (__m512i v, int bit) {
+    return _mm512_test_epi64_mask (v, _mm512_set1_epi64 (1LL << bit));
+  }
+  static inline __m512d ratio (__m512i v) {
+    return _mm512_mul_pd (_mm512_cvtepu32_pd (_mm512_cvtepi64_epi32 (v)), _mm512_set1_pd (0x1p-32));
+  }
+};
+#endif
+
+/*
+ * Moves the hash values from the lanes of the arguments (IN) to the lanes of
+ * the result (OUT): only the casts change the lane width.
+ */
+template <class IN, class OUT> struct vr_vlanesCast {
+  static inline typename vr_vlanes<OUT>::IntType apply (typename vr_vlanes<IN>::IntType v) { return v; }
+};
+
+#if defined(__SSE4_2__)
+template <> struct vr_vlanesCast<__m128d, __m128> {
+  static inline __m128i apply (__m128i v) { return _mm_shuffle_epi32 (v, _MM_SHUFFLE (2, 0, 2, 0)); }
+};
+#endif
+
+#if defined(__AVX2__)
+template <> struct vr_vlanesCast<__m256d, __m128> {
+  static inline __m128i apply (__m256i v) {
+    return _mm256_castsi256_si128 (_mm256_permutevar8x32_epi32 (v, _mm256_setr_epi32 (0, 2, 4, 6, 0, 2, 4, 6)));
+  }
+};
+#endif
+
+#if defined(__AVX512F__)
+template <> struct vr_vlanesCast<__m512d, __m256> {
+  static inline __m256i apply (__m512i v) { return _mm512_cvtepi64_epi32 (v); }
+};
+#endif
+
+// Bits of the arguments of a pack
+template <class VT, int NB>
+inline void vr_vpackBits(const vr_packArg<VT, NB> &p, typename vr_vlanes<VT>::IntType *bits) {
+  bits[0] = vr_vlanes<VT>::bits (p.arg1);
+  if constexpr (NB > 1) {
+    bits[1] = vr_vlanes<VT>::bits (p.arg2);
+  }
+  if constexpr (NB > 2) {
+    bits[2] = vr_vlanes<VT>::bits (p.arg3);
+  }
+}
+
+// Arguments of a pack stored lane by lane, for the scalar fallback
+template <class VT, int NB> struct vr_vunpack {
+  typedef typename vr_simd<VT>::ScalarType ScalarType;
+  static const int nbLanes = vr_simd<VT>::nbLanes;
+
+  vr_vunpack(const vr_packArg<VT, NB> &p) {
+    vr_simd<VT>::storeu (arg[0], p.arg1);
+    if constexpr (NB > 1) {
+      vr_simd<VT>::storeu (arg[1], p.arg2);
+    }
+    if constexpr (NB > 2) {
+      vr_simd<VT>::storeu (arg[2], p.arg3);
+    }
+  }
+
+  vr_packArg<ScalarType, NB> lane(int i) const {
+    if constexpr (NB == 1) {
+      return vr_packArg<ScalarType, 1>(arg[0][i]);
+    } else if constexpr (NB == 2) {
+      return vr_packArg<ScalarType, 2>(arg[0][i], arg[1][i]);
+    } else {
+      return vr_packArg<ScalarType, 3>(arg[0][i], arg[1][i], arg[2][i]);
+    }
+  }
+
+  ScalarType arg[NB][nbLanes];
+};
+
+/*
+ * Default: the scalar HASH is called lane by lane (vr_mersenne_twister_hash
+ * seeds a tinymt64 per call and has no SIMD version).
+ */
+template <class HASH> struct vr_vhash {
+  template <class OUT, class VT, int NB>
+  static inline typename vr_simd<OUT>::MaskType
+  hashBool(const Vr_Rand *r, const vr_packArg<VT, NB> &pack, uint32_t hashOp) {
+    const vr_vunpack<VT, NB> args(pack);
+    uint32_t res[vr_simd<OUT>::nbLanes] = {0};
+    for (int i = 0; i < vr_simd<VT>::nbLanes; i++) {
+      res[i] = HASH::hashBool(r, args.lane(i), hashOp);
+    }
+    return vr_vlanes<OUT>::maskOfBit (vr_vlanes<OUT>::fromValues (res), 0);
+  }
+
+  template <class OUT, class VT, int NB>
+  static inline OUT hashRatio(const Vr_Rand *r, const vr_packArg<VT, NB> &pack,
+                              uint32_t hashOp) {
+    const vr_vunpack<VT, NB> args(pack);
+    typename vr_simd<OUT>::ScalarType res[vr_simd<OUT>::nbLanes] = {0};
+    for (int i = 0; i < vr_simd<VT>::nbLanes; i++) {
+      res[i] = HASH::hashRatio(r, args.lane(i), hashOp);
+    }
+    return vr_simd<OUT>::loadu (res);
+  }
+};
+
+/*
+ * Common part of the SIMD hashes: VHASH::hash returns the 32-bit value of
+ * each lane, VHASH::boolBit the bit of this value used by hashBool.
+ */
+template <class VHASH> struct vr_vhashValue {
+  template <class OUT, class VT, int NB>
+  static inline typename vr_simd<OUT>::MaskType
+  hashBool(const Vr_Rand *r, const vr_packArg<VT, NB> &pack, uint32_t hashOp) {
+    const typename vr_vlanes<OUT>::IntType v =
+        vr_vlanesCast<VT, OUT>::apply (VHASH::hash(r, pack, hashOp));
+    return vr_vlanes<OUT>::maskOfBit (v, VHASH::boolBit);
+  }
+
+  template <class OUT, class VT, int NB>
+  static inline OUT hashRatio(const Vr_Rand *r, const vr_packArg<VT, NB> &pack,
+                              uint32_t hashOp) {
+    return vr_vlanes<OUT>::ratio (vr_vlanesCast<VT, OUT>::apply (VHASH::hash(r, pack, hashOp)));
+  }
+};
+
+template <>
+struct vr_vhash<vr_multiply_shift_hash>
+    : public vr_vhashValue<vr_vhash<vr_multiply_shift_hash>> {
+  static const int boolBit = 31; // (m + seedTab[7]) >> 63
+
+  template <class VT, int NB>
+  static inline typename vr_vlanes<VT>::IntType
+  hash([[maybe_unused]] const Vr_Rand *r, const vr_packArg<VT, NB> &pack,
+       uint32_t hashOp) {
+    typedef typename vr_vlanes<VT>::IntType VI;
+    typedef vr_simdi<VI> SI;
+    const uint64_t *seedTab =
+        vr_hashTables_get<VR_HASH_TABLES_MULTIPLY_SHIFT>().seedTab;
+    VI a[NB];
+    vr_vpackBits (pack, a);
+
+    if constexpr (vr_vlanes<VT>::is64) {
+      VI m = SI::set1_64 (hashOp * seedTab[6]);
+      for (int i = 0; i < NB; i++) {
+        m = SI::add64 (m, multiplyHalves (seedTab, a[i], 2 * i));
+      }
+      return SI::srli64 (SI::add64 (m, SI::set1_64 (seedTab[7])), 32);
+    } else {
+      // the 64-bit products are computed on each half of the lanes
+      VI lo[NB], hi[NB];
+      for (int i = 0; i < NB; i++) {
+        lo[i] = SI::widenLo (a[i]);
+        hi[i] = SI::widenHi (a[i]);
+      }
+      return SI::narrow (multiply32<VI, NB> (seedTab, lo, hashOp),
+                         multiply32<VI, NB> (seedTab, hi, hashOp));
+    }
+  }
+
+private:
+  // (low + seedTab[i]) * (high + seedTab[i+1]) of the 64-bit lanes of a
+  template <class VI>
+  static inline VI multiplyHalves(const uint64_t *seedTab, VI a, int i) {
+    typedef vr_simdi<VI> SI;
+    const VI lo = SI::and_ (a, SI::set1_64 (0xffffffffULL));
+    const VI hi = SI::srli64 (a, 32);
+    return SI::mullo64 (SI::add64 (lo, SI::set1_64 (seedTab[i])),
+                        SI::add64 (hi, SI::set1_64 (seedTab[i + 1])));
+  }
+
+  // vr_multiply_shift_hash::multiply of float arguments widened to 64 bits
+  template <class VI, int NB>
+  static inline VI multiply32(const uint64_t *seedTab, const VI *a,
+                              uint32_t hashOp) {
+    typedef vr_simdi<VI> SI;
+    VI m;
+    if constexpr (NB == 1) {
+      m = SI::mullo64 (SI::add64 (a[0], SI::set1_64 (seedTab[0])),
+                       SI::set1_64 (hashOp + seedTab[6]));
+    } else {
+      m = SI::mullo64 (SI::add64 (a[0], SI::set1_64 (seedTab[0])),
+                       SI::add64 (a[1], SI::set1_64 (seedTab[1])));
+      if constexpr (NB == 2) {
+        m = SI::add64 (m, SI::set1_64 (hashOp * seedTab[6]));
+      } else {
+        m = SI::add64 (m, SI::mullo64 (SI::add64 (a[2], SI::set1_64 (seedTab[2])),
+                                       SI::set1_64 (hashOp + seedTab[6])));
+      }
+    }
+    return SI::srli64 (SI::add64 (m, SI::set1_64 (seedTab[7])), 32);
+  }
+};
+
+template <>
+struct vr_vhash<vr_mix64_hash>
+    : public vr_vhashValue<vr_vhash<vr_mix64_hash>> {
+  static const int boolBit = 31; // hash >> 63
+
+  template <class VT, int NB>
+  static inline typename vr_vlanes<VT>::IntType
+  hash(const Vr_Rand *r, const vr_packArg<VT, NB> &pack, uint32_t hashOp) {
+    typedef typename vr_vlanes<VT>::IntType VI;
+    typedef vr_simdi<VI> SI;
+    const uint64_t key = vr_mix64_hash::key(vr_rand_getSeed(r), hashOp);
+    VI a[NB];
+    vr_vpackBits (pack, a);
+
+    if constexpr (vr_vlanes<VT>::is64) {
+      return SI::srli64 (mix<VI, NB> (key, a), 32);
+    } else {
+      // the 64-bit mix is computed on each half of the lanes
+      VI lo[NB], hi[NB];
+      for (int i = 0; i < NB; i++) {
+        lo[i] = SI::widenLo (a[i]);
+        hi[i] = SI::widenHi (a[i]);
+      }
+      return SI::narrow (SI::srli64 (mix<VI, NB> (key, lo), 32),
+                         SI::srli64 (mix<VI, NB> (key, hi), 32));
+    }
+  }
+
+private:
+  // vr_mix64_hash::hash of the 64-bit lanes of a
+  template <class VI, int NB>
+  static inline VI mix(uint64_t key, const VI *a) {
+    typedef vr_simdi<VI> SI;
+    VI h = SI::set1_64 (key);
+    for (int i = 0; i < NB; i++) {
+      h = SI::mullo64 (SI::xor_ (h, a[i]), SI::set1_64 (vr_mix64_hash::P1));
+      h = SI::xor_ (h, SI::srli64 (h, 32));
+    }
+    h = SI::xor_ (h, SI::srli64 (h, 33));
+    h = SI::mullo64 (h, SI::set1_64 (vr_mix64_hash::F1));
+    h = SI::xor_ (h, SI::srli64 (h, 33));
+    h = SI::mullo64 (h, SI::set1_64 (vr_mix64_hash::F2));
+    return SI::xor_ (h, SI::srli64 (h, 33));
+  }
+};
+
+template <>
+struct vr_vhash<vr_dietzfelbinger_hash>
+    : public vr_vhashValue<vr_vhash<vr_dietzfelbinger_hash>> {
+  static const int boolBit = 31;
+
+  template <class VT, int NB>
+  static inline typename vr_vlanes<VT>::IntType
+  hash(const Vr_Rand *r, const vr_packArg<VT, NB> &pack, uint32_t hashOp) {
+    typedef typename vr_vlanes<VT>::IntType VI;
+    typedef vr_simdi<VI> SI;
+    VI a[NB];
+    vr_vpackBits (pack, a);
+    VI argsHash = a[0];
+    for (int i = 1; i < NB; i++) {
+      argsHash = SI::xor_ (argsHash, a[i]);
+    }
+
+    if constexpr (vr_vlanes<VT>::is64) {
+      const uint64_t seed = vr_rand_getSeed(r) ^ (hashOp << 2);
+      return SI::srli64 (SI::mullo64 (SI::set1_64 (seed | 1), argsHash), 32);
+    } else {
+      const uint32_t seed = vr_rand_getSeed(r) ^ (hashOp << 2);
+      return SI::mullo32 (SI::set1_32 (seed | 1), argsHash);
+    }
+  }
+};
+
+template <>
+struct vr_vhash<vr_tabulation_hash>
+    : public vr_vhashValue<vr_vhash<vr_tabulation_hash>> {
+  static const int boolBit = 0;
+
+  template <class VT, int NB>
+  static inline typename vr_vlanes<VT>::IntType
+  hash([[maybe_unused]] const Vr_Rand *r, const vr_packArg<VT, NB> &pack,
+       uint32_t hashOp) {
+    typedef typename vr_vlanes<VT>::IntType VI;
+    typedef vr_simdi<VI> SI;
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
+    uint32_t opHash = 0;
+    vr_tabulation_hash::hash_op(t, opHash, (uint16_t)hashOp);
+
+    VI a[NB];
+    vr_vpackBits (pack, a);
+    VI res = vr_vlanes<VT>::is64 ? SI::set1_64 (opHash) : SI::set1_32 (opHash);
+    for (int i = 0; i < NB; i++) {
+      res = hash_aux<VT> (t, res, i, a[i], vr_vlanes<VT>::is64 ? 8 : 4);
+    }
+    return res;
+  }
+
+  // vr_tabulation_hash::hash_aux on the nbBytes low bytes of each lane of x
+  template <class VT>
+  static inline typename vr_vlanes<VT>::IntType
+  hash_aux(const Vr_HashTables &t, typename vr_vlanes<VT>::IntType h, int index,
+           typename vr_vlanes<VT>::IntType x, int nbBytes) {
+    typedef vr_simdi<typename vr_vlanes<VT>::IntType> SI;
+    for (int i = 0; i < nbBytes; i++) {
+      if constexpr (vr_vlanes<VT>::is64) {
+        h = SI::xor_ (h, SI::gather64 (t.hashTable[index][i],
+                                       SI::and_ (SI::srli64 (x, 8 * i), SI::set1_64 (0xff))));
+      } else {
+        h = SI::xor_ (h, SI::gather32 (t.hashTable[index][i],
+                                       SI::and_ (SI::srli32 (x, 8 * i), SI::set1_32 (0xff))));
+      }
+    }
+    return h;
+  }
+};
+
+template <>
+struct vr_vhash<vr_double_tabulation_hash>
+    : public vr_vhashValue<vr_vhash<vr_double_tabulation_hash>> {
+  static const int boolBit = 0;
+
+  template <class VT, int NB>
+  static inline typename vr_vlanes<VT>::IntType
+  hash(const Vr_Rand *r, const vr_packArg<VT, NB> &pack, uint32_t hashOp) {
+    typedef vr_simdi<typename vr_vlanes<VT>::IntType> SI;
+    const typename vr_vlanes<VT>::IntType tmp =
+        vr_vhash<vr_tabulation_hash>::hash(r, pack, hashOp);
+    const Vr_HashTables &t = vr_hashTables_get<VR_HASH_TABLES_TABULATION>();
+    return vr_vhash<vr_tabulation_hash>::hash_aux<VT> (t, SI::set1_32 (0), 3, tmp, 4);
+  }
+};
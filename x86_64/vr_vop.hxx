@@ -40,35 +40,65 @@
 // vr_packArg
 #if defined(__SSE4_2__)
 template<>
-inline __m128i vr_packArg<__m128, 1>::hasOneArgNanInf() const {
+inline __m128 vr_packArg<__m128, 1>::hasOneArgNanInf() const {
   return hasNanInf(this->arg1);
 }
 
 template<>
-inline __m128i vr_packArg<__m128, 2>::hasOneArgNanInf() const {
-  return _mm_or_si128( hasNanInf(this->arg1), hasNanInf(this->arg2));
+inline __m128 vr_packArg<__m128, 2>::hasOneArgNanInf() const {
+  return _mm_or_ps( hasNanInf(this->arg1), hasNanInf(this->arg2));
 }
 
 template<>
-inline __m128i vr_packArg<__m128, 3>::hasOneArgNanInf() const {
-  return _mm_or_si128( _mm_or_si128( hasNanInf(this->arg1), hasNanInf(this->arg2)), hasNanInf(this->arg3));
+inline __m128 vr_packArg<__m128, 3>::hasOneArgNanInf() const {
+  return _mm_or_ps( _mm_or_ps( hasNanInf(this->arg1), hasNanInf(this->arg2)), hasNanInf(this->arg3));
+}
+
+template<>
+inline __m128d vr_packArg<__m128d, 1>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1);
+}
+
+template<>
+inline __m128d vr_packArg<__m128d, 2>::hasOneArgNanInf() const {
+  return _mm_or_pd( hasNanInf(this->arg1), hasNanInf(this->arg2));
+}
+
+template<>
+inline __m128d vr_packArg<__m128d, 3>::hasOneArgNanInf() const {
+  return _mm_or_pd( _mm_or_pd( hasNanInf(this->arg1), hasNanInf(this->arg2)), hasNanInf(this->arg3));
 }
 #endif
 
 #if defined(__AVX2__)
 template<>
-inline __m128i vr_packArg<__m256, 1>::hasOneArgNanInf() const {
+inline __m256 vr_packArg<__m256, 1>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1);
+}
+
+template<>
+inline __m256 vr_packArg<__m256, 2>::hasOneArgNanInf() const {
+  return _mm256_or_ps( hasNanInf(this->arg1), hasNanInf(this->arg2));
+}
+
+template<>
+inline __m256 vr_packArg<__m256, 3>::hasOneArgNanInf() const {
+  return _mm256_or_ps( _mm256_or_ps( hasNanInf(this->arg1), hasNanInf(this->arg2)), hasNanInf(this->arg3));
+}
+
+template<>
+inline __m256d vr_packArg<__m256d, 1>::hasOneArgNanInf() const {
   return hasNanInf(this->arg1);
 }
 
 template<>
-inline __m128i vr_packArg<__m256, 2>::hasOneArgNanInf() const {
-  return _mm_or_si128( hasNanInf(this->arg1), hasNanInf(this->arg2));
+inline __m256d vr_packArg<__m256d, 2>::hasOneArgNanInf() const {
+  return _mm256_or_pd( hasNanInf(this->arg1), hasNanInf(this->arg2));
 }
 
 template<>
-inline __m128i vr_packArg<__m256, 3>::hasOneArgNanInf() const {
-  return _mm_or_si128( _mm_or_si128( hasNanInf(this->arg1), hasNanInf(this->arg2)), hasNanInf(this->arg3));
+inline __m256d vr_packArg<__m256d, 3>::hasOneArgNanInf() const {
+  return _mm256_or_pd( _mm256_or_pd( hasNanInf(this->arg1), hasNanInf(this->arg2)), hasNanInf(this->arg3));
 }
 #endif
 // AddOp
@@ -112,6 +142,46 @@ inline __m256 AddOp<__m256>::error (const PackArgs& p, const RealType& x) {
 }
 #endif
 
+#if defined(__SSE4_2__)
+template<>
+inline __m128d AddOp<__m128d>::nearestOp(const PackArgs &p) {
+  const RealType &a(p.arg1);
+  const RealType &b(p.arg2);
+  return _mm_add_pd (a, b);
+}
+
+template<>
+inline __m128d AddOp<__m128d>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(p.arg2);
+  const RealType z = _mm_sub_pd (x, a);
+  return _mm_add_pd (
+            _mm_sub_pd (a, _mm_sub_pd(x, z)),
+            _mm_sub_pd (b, z)
+          );
+}
+#endif
+
+#if defined(__AVX2__)
+template<>
+inline __m256d AddOp<__m256d>::nearestOp(const PackArgs &p) {
+  const RealType &a(p.arg1);
+  const RealType &b(p.arg2);
+  return _mm256_add_pd (a, b);
+}
+
+template<>
+inline __m256d AddOp<__m256d>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(p.arg2);
+  const RealType z = _mm256_sub_pd (x, a);
+  return _mm256_add_pd (
+            _mm256_sub_pd (a, _mm256_sub_pd(x, z)),
+            _mm256_sub_pd (b, z)
+          );
+}
+#endif
+
 // SubOp
 #if defined(__SSE4_2__)
 template<>
@@ -153,16 +223,56 @@ inline __m256 SubOp<__m256>::error (const PackArgs& p, const RealType& x) {
 }
 #endif
 
+#if defined(__SSE4_2__)
+template<>
+inline __m128d SubOp<__m128d>::nearestOp(const PackArgs &p) {
+  const RealType &a(p.arg1);
+  const RealType &b(p.arg2);
+  return _mm_sub_pd (a, b);
+}
+
+template<>
+inline __m128d SubOp<__m128d>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(_mm_sub_pd (_mm_setzero_pd(), p.arg2));
+  const RealType z = _mm_sub_pd (x, a);
+  return _mm_add_pd (
+            _mm_sub_pd (a, _mm_sub_pd(x, z)),
+            _mm_sub_pd (b, z)
+          );
+}
+#endif
+
+#if defined(__AVX2__)
+template<>
+inline __m256d SubOp<__m256d>::nearestOp(const PackArgs &p) {
+  const RealType &a(p.arg1);
+  const RealType &b(p.arg2);
+  return _mm256_sub_pd (a, b);
+}
+
+template<>
+inline __m256d SubOp<__m256d>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(_mm256_sub_pd( _mm256_setzero_pd(), p.arg2));
+  const RealType z = _mm256_sub_pd (x, a);
+  return _mm256_add_pd (
+            _mm256_sub_pd (a, _mm256_sub_pd(x, z)),
+            _mm256_sub_pd (b, z)
+          );
+}
+#endif
+
 // MulOp
 #if defined(__SSE4_2__)
-template <> inline __m128 splitFactor<__m128>() {
-  return _mm_set1_ps((float)4097); //((2^12)+1); / 24/2 en float/
+template <> inline __m128d splitFactor<__m128d>() {
+  return _mm_set1_pd((double)134217729); //((2^27)+1); /27 en double  sup(53/2) /
 }
 #endif
 
 #if defined(__AVX2__)
-template <> inline __m256 splitFactor<__m256>() {
-  return _mm256_set1_ps((float)4097); //((2^12)+1); / 24/2 en float/
+template <> inline __m256d splitFactor<__m256d>() {
+  return _mm256_set1_pd((double)134217729); //((2^27)+1); /27 en double  sup(53/2) /
 }
 #endif
 
@@ -183,40 +293,39 @@ public:
     return _mm_mul_ps (a, b);
   };
 
+  // As MulOp<float>: the product of two floats is exact in double, where the
+  // error neither underflows for subnormal products nor overflows as the
+  // float split does near FLT_MAX
   static inline RealType error(const PackArgs &p, const RealType &x) {
-    /*Provient de "Accurate Sum and dot product" OGITA RUMP OISHI */
-    const RealType a(p.arg1);
-    const RealType b(p.arg2);
-    RealType a1,a2;
-    RealType b1,b2;
-    MulOp<RealType>::split(a,a1,a2);
-    MulOp<RealType>::split(b,b1,b2);
-
-    return _mm_add_ps (_mm_add_ps (_mm_sub_ps (_mm_mul_ps (a1, b1), x),
-                                   _mm_add_ps ( _mm_mul_ps (a1, b2), _mm_mul_ps (a2, b1))),
-                        _mm_mul_ps (a2, b2));
+    __m128d e_lo, e_hi;
+    MulOp<__m128>::doubleError(p, x, e_lo, e_hi);
+    return _mm_movelh_ps (_mm_cvtpd_ps (e_lo), _mm_cvtpd_ps (e_hi));
   };
 
-  static inline void split(RealType a, RealType &x, RealType &y) {
-    //    const RealType factor=134217729; //((2^27)+1); /*27 en double*/
-    const RealType factor(splitFactor<RealType>());
-    const RealType c = _mm_mul_ps (factor , a);
-    x = _mm_sub_ps (c, _mm_sub_ps(c, a));
-    y = _mm_sub_ps (a, x);
+  // the error of the 2 low and the 2 high lanes, in double
+  static inline void doubleError(const PackArgs &p, const RealType &x,
+                                 __m128d &e_lo, __m128d &e_hi) {
+    const RealType &a(p.arg1);
+    const RealType &b(p.arg2);
+    e_lo = _mm_sub_pd (_mm_mul_pd (_mm_cvtps_pd (a), _mm_cvtps_pd (b)), _mm_cvtps_pd (x));
+    e_hi = _mm_sub_pd (_mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (a, a)),
+                                   _mm_cvtps_pd (_mm_movehl_ps (b, b))),
+                       _mm_cvtps_pd (_mm_movehl_ps (x, x)));
   }
 
   static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
-    __m128 res = MulOp<__m128>::error(p, c);// Call for double later
-
-    __m128 res_lt_0 = _mm_cmplt_ps (res, _mm_setzero_ps());
-    __m128 res_gt_0 = _mm_cmpgt_ps (res, _mm_setzero_ps());
-
-    __m128 ret = _mm_setzero_ps();
-    ret = _mm_blendv_ps (ret, _mm_set1_ps(-1), res_lt_0);
-    ret = _mm_blendv_ps (ret, _mm_set1_ps( 1), res_gt_0);
-    return ret;
+    __m128d e_lo, e_hi;
+    MulOp<__m128>::doubleError(p, c, e_lo, e_hi);
+    return _mm_movelh_ps (_mm_cvtpd_ps (doubleSign (e_lo)), _mm_cvtpd_ps (doubleSign (e_hi)));
   };
 
+  // -1, 0 or 1
+  static inline __m128d doubleSign(const __m128d &e) {
+    const __m128d one = _mm_set1_pd (1.);
+    return _mm_sub_pd (_mm_and_pd (_mm_cmpgt_pd (e, _mm_setzero_pd ()), one),
+                       _mm_and_pd (_mm_cmplt_pd (e, _mm_setzero_pd ()), one));
+  }
+
   static inline const PackArgs comdetPack(const PackArgs &p) {
     return PackArgs(_mm_min_ps (p.arg1, p.arg2), _mm_max_ps(p.arg1, p.arg2));
   }
@@ -226,7 +335,7 @@ public:
     return p.isOneArgNanInf();
   }
 
-  static inline __m128i areInfNotSpecificToNearest(const PackArgs &p) {
+  static inline __m128 areInfNotSpecificToNearest(const PackArgs &p) {
     return p.hasOneArgNanInf();
   }
 
@@ -259,52 +368,195 @@ public:
     return _mm256_mul_ps (a, b);
   };
 
+  // in double, as MulOp<__m128>
+  static inline RealType error(const PackArgs &p, const RealType &x) {
+    __m256d e_lo, e_hi;
+    MulOp<__m256>::doubleError(p, x, e_lo, e_hi);
+    return _mm256_set_m128 (_mm256_cvtpd_ps (e_hi), _mm256_cvtpd_ps (e_lo));
+  };
+
+  // the error of the 4 low and the 4 high lanes, in double
+  static inline void doubleError(const PackArgs &p, const RealType &x,
+                                 __m256d &e_lo, __m256d &e_hi) {
+    const RealType &a(p.arg1);
+    const RealType &b(p.arg2);
+    e_lo = _mm256_sub_pd (_mm256_mul_pd (_mm256_cvtps_pd (_mm256_castps256_ps128 (a)),
+                                         _mm256_cvtps_pd (_mm256_castps256_ps128 (b))),
+                          _mm256_cvtps_pd (_mm256_castps256_ps128 (x)));
+    e_hi = _mm256_sub_pd (_mm256_mul_pd (_mm256_cvtps_pd (_mm256_extractf128_ps (a, 1)),
+                                         _mm256_cvtps_pd (_mm256_extractf128_ps (b, 1))),
+                          _mm256_cvtps_pd (_mm256_extractf128_ps (x, 1)));
+  }
+
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    __m256d e_lo, e_hi;
+    MulOp<__m256>::doubleError(p, c, e_lo, e_hi);
+    return _mm256_set_m128 (_mm256_cvtpd_ps (doubleSign (e_hi)), _mm256_cvtpd_ps (doubleSign (e_lo)));
+  };
+
+  // -1, 0 or 1
+  static inline __m256d doubleSign(const __m256d &e) {
+    const __m256d one = _mm256_set1_pd (1.);
+    return _mm256_sub_pd (_mm256_and_pd (_mm256_cmp_pd (e, _mm256_setzero_pd (), _CMP_GT_OQ), one),
+                          _mm256_and_pd (_mm256_cmp_pd (e, _mm256_setzero_pd (), _CMP_LT_OQ), one));
+  }
+
+  static inline const PackArgs comdetPack(const PackArgs &p) {
+    return PackArgs(_mm256_min_ps (p.arg1, p.arg2), _mm256_max_ps(p.arg1, p.arg2));
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return p.isOneArgNanInf();
+  }
+
+  static inline __m256 areInfNotSpecificToNearest(const PackArgs &p) {
+    return p.hasOneArgNanInf();
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+
+  static inline void twoProd(const RealType &a, const RealType &b, RealType &x,
+                             RealType &y) {
+    const PackArgs p(a, b);
+    x = MulOp<__m256>::nearestOp(p);
+    y = MulOp<__m256>::error(p, x);
+  }
+};
+#endif
+#if defined(__SSE4_2__)
+template <> class MulOp<__m128d> {
+public:
+  typedef __m128d RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "mul"; }
+  static inline uint64_t getHash() {
+    return opHash::mulHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    const RealType &a(p.arg1);
+    const RealType &b(p.arg2);
+    return _mm_mul_pd (a, b);
+  };
+
   static inline RealType error(const PackArgs &p, const RealType &x) {
-    /*Provient de "Accurate Sum and dot product" OGITA RUMP OISHI */
     const RealType a(p.arg1);
     const RealType b(p.arg2);
-    return _mm256_fmadd_ps (a, b, _mm256_sub_ps(_mm256_setzero_ps(), x));
-
+#if defined(__FMA__)
+    return _mm_fmsub_pd (a, b, x);
+#else
+    /*Provient de "Accurate Sum and dot product" OGITA RUMP OISHI */
     RealType a1,a2;
     RealType b1,b2;
     MulOp<RealType>::split(a,a1,a2);
     MulOp<RealType>::split(b,b1,b2);
-    return _mm256_add_ps (_mm256_add_ps ( _mm256_sub_ps (_mm256_mul_ps (a1, b1), x), 
-                                                         _mm256_add_ps (_mm256_mul_ps (a1, b2),
-                                                                        _mm256_mul_ps (a2, b1))),
-                          _mm256_mul_ps (a2, b2));
+
+    RealType res = _mm_add_pd (_mm_add_pd (_mm_sub_pd (_mm_mul_pd (a1, b1), x),
+                                           _mm_add_pd ( _mm_mul_pd (a1, b2), _mm_mul_pd (a2, b1))),
+                               _mm_mul_pd (a2, b2));
+
+    // The split overflows for huge arguments and the error terms underflow for
+    // tiny products: those lanes use the software fma, as the scalar MulOp.
+    const RealType absMask = _mm_castsi128_pd (_mm_set1_epi64x (0x7fffffffffffffff));
+    const RealType notSafe = _mm_or_pd (
+        _mm_cmpge_pd (_mm_max_pd (_mm_and_pd (a, absMask), _mm_and_pd (b, absMask)), _mm_set1_pd (0x1p995)),
+        _mm_cmplt_pd (_mm_and_pd (x, absMask), _mm_set1_pd (0x1p-969)));
+    const int notSafeLanes = _mm_movemask_pd (notSafe);
+    if (notSafeLanes) {
+      double v_a[2], v_b[2], v_x[2], v_res[2];
+      _mm_storeu_pd (v_a, a);
+      _mm_storeu_pd (v_b, b);
+      _mm_storeu_pd (v_x, x);
+      _mm_storeu_pd (v_res, res);
+      for (int i = 0; i < 2; i++) {
+        if (notSafeLanes & (1 << i)) {
+          v_res[i] = __verrou_internal_fma (v_a[i], v_b[i], -v_x[i]);
+        }
+      }
+      res = _mm_loadu_pd (v_res);
+    }
+    return res;
+#endif
   };
 
   static inline void split(RealType a, RealType &x, RealType &y) {
-    //    const RealType factor=134217729; //((2^27)+1); /*27 en double*/
     const RealType factor(splitFactor<RealType>());
-    const RealType c = _mm256_mul_ps (factor , a);
-    x = _mm256_sub_ps (c, _mm256_sub_ps(c, a));
-    y = _mm256_sub_ps (a, x);
+    const RealType c = _mm_mul_pd (factor , a);
+    x = _mm_sub_pd (c, _mm_sub_pd(c, a));
+    y = _mm_sub_pd (a, x);
   }
 
+  // Only the sign of the lanes is used by the rounding modes. When the
+  // product underflows to zero the sign of the error is the one of a*b.
   static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
-    __m256 res = MulOp<__m256>::error(p, c);// Call for double later
+    const RealType zero = _mm_setzero_pd ();
+    const RealType signOfProduct = _mm_andnot_pd (_mm_cmpeq_pd (p.arg1, zero),
+                                                  _mm_xor_pd (p.arg2, _mm_and_pd (p.arg1, _mm_set1_pd (-0.))));
+    return _mm_blendv_pd (MulOp<__m128d>::error(p, c), signOfProduct, _mm_cmpeq_pd (c, zero));
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return p.isOneArgNanInf();
+  }
 
-    __m256 res_lt_0 = _mm256_cmp_ps (res, _mm256_setzero_ps(), _CMP_LT_OQ);
-    __m256 res_gt_0 = _mm256_cmp_ps (res, _mm256_setzero_ps(), _CMP_GT_OQ);
+  static inline __m128d areInfNotSpecificToNearest(const PackArgs &p) {
+    return p.hasOneArgNanInf();
+  }
 
-    __m256 ret = _mm256_setzero_ps();
-    ret = _mm256_blendv_ps (ret, _mm256_set1_ps(-1), res_lt_0);
-    ret = _mm256_blendv_ps (ret, _mm256_set1_ps( 1), res_gt_0);
-    return ret;
-  };
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
 
-  static inline const PackArgs comdetPack(const PackArgs &p) {
-    return PackArgs(_mm256_min_ps (p.arg1, p.arg2), _mm256_max_ps(p.arg1, p.arg2));
+  static inline void twoProd(const RealType &a, const RealType &b, RealType &x,
+                             RealType &y) {
+    const PackArgs p(a, b);
+    x = MulOp<__m128d>::nearestOp(p);
+    y = MulOp<__m128d>::error(p, x);
+  }
+};
+#endif
+
+#if defined(__AVX2__)
+template <> class MulOp<__m256d> {
+public:
+  typedef __m256d RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "mul"; }
+  static inline uint64_t getHash() {
+    return opHash::mulHash * typeHash::nbTypeHash + getTypeHash<RealType>();
   }
   static inline uint64_t getComdetHash() { return getHash(); };
 
+  static inline RealType nearestOp(const PackArgs &p) {
+    const RealType &a(p.arg1);
+    const RealType &b(p.arg2);
+    return _mm256_mul_pd (a, b);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &x) {
+    const RealType a(p.arg1);
+    const RealType b(p.arg2);
+    return _mm256_fmsub_pd (a, b, x);
+  };
+
+  // Only the sign of the lanes is used by the rounding modes. When the
+  // product underflows to zero the sign of the error is the one of a*b.
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    const RealType zero = _mm256_setzero_pd ();
+    const RealType signOfProduct = _mm256_andnot_pd (_mm256_cmp_pd (p.arg1, zero, _CMP_EQ_OQ),
+                                                     _mm256_xor_pd (p.arg2, _mm256_and_pd (p.arg1, _mm256_set1_pd (-0.))));
+    return _mm256_blendv_pd (MulOp<__m256d>::error(p, c), signOfProduct, _mm256_cmp_pd (c, zero, _CMP_EQ_OQ));
+  };
+
   static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
     return p.isOneArgNanInf();
   }
 
-  static inline __m128i areInfNotSpecificToNearest(const PackArgs &p) {
+  static inline __m256d areInfNotSpecificToNearest(const PackArgs &p) {
     return p.hasOneArgNanInf();
   }
 
@@ -314,8 +566,874 @@ public:
   static inline void twoProd(const RealType &a, const RealType &b, RealType &x,
                              RealType &y) {
     const PackArgs p(a, b);
-    x = MulOp<__m256>::nearestOp(p);
-    y = MulOp<__m256>::error(p, x);
+    x = MulOp<__m256d>::nearestOp(p);
+    y = MulOp<__m256d>::error(p, x);
+  }
+};
+#endif
+
+// DivOp : the error is the residual x-c*y divided by y. As the scalar
+// DivOp<float>, the sign of the float residual is computed in double, where
+// c*y is exact.
+#if defined(__SSE4_2__)
+template <> class DivOp<__m128> {
+public:
+  typedef __m128 RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "div"; }
+  static inline uint64_t getHash() {
+    return opHash::divHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm_div_ps (p.arg1, p.arg2);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &c) {
+    const RealType &x(p.arg1);
+    const RealType &y(p.arg2);
+#if defined(__FMA__)
+    return _mm_div_ps (_mm_fnmadd_ps (c, y, x), y);
+#else
+    const __m128d r_lo = _mm_sub_pd (_mm_cvtps_pd (x), _mm_mul_pd (_mm_cvtps_pd (c), _mm_cvtps_pd (y)));
+    const __m128d r_hi = _mm_sub_pd (_mm_cvtps_pd (_mm_movehl_ps (x, x)),
+                                     _mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (c, c)),
+                                                 _mm_cvtps_pd (_mm_movehl_ps (y, y))));
+    return _mm_div_ps (_mm_movelh_ps (_mm_cvtpd_ps (r_lo), _mm_cvtpd_ps (r_hi)), y);
+#endif
+  };
+
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    const RealType &x(p.arg1);
+    const RealType &y(p.arg2);
+    const __m128d zero = _mm_setzero_pd ();
+    const __m128d r_lo = _mm_sub_pd (_mm_cvtps_pd (x), _mm_mul_pd (_mm_cvtps_pd (c), _mm_cvtps_pd (y)));
+    const __m128d r_hi = _mm_sub_pd (_mm_cvtps_pd (_mm_movehl_ps (x, x)),
+                                     _mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (c, c)),
+                                                 _mm_cvtps_pd (_mm_movehl_ps (y, y))));
+    const __m128 r_gt_0 = _mm_shuffle_ps (_mm_castpd_ps (_mm_cmpgt_pd (r_lo, zero)),
+                                          _mm_castpd_ps (_mm_cmpgt_pd (r_hi, zero)), _MM_SHUFFLE (2, 0, 2, 0));
+    const __m128 r_lt_0 = _mm_shuffle_ps (_mm_castpd_ps (_mm_cmplt_pd (r_lo, zero)),
+                                          _mm_castpd_ps (_mm_cmplt_pd (r_hi, zero)), _MM_SHUFFLE (2, 0, 2, 0));
+    return _mm_or_ps (_mm_and_ps (r_gt_0, y),
+                      _mm_and_ps (r_lt_0, _mm_xor_ps (y, _mm_set1_ps (-0.f))));
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return vr_simd<RealType>::any (areInfNotSpecificToNearest (p));
+  }
+
+  // division by zero
+  static inline __m128 areInfNotSpecificToNearest(const PackArgs &p) {
+    return _mm_or_ps (hasNanInf(p.arg1), _mm_cmpeq_ps (p.arg2, _mm_setzero_ps()));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+};
+#endif
+
+#if defined(__AVX2__)
+template <> class DivOp<__m256> {
+public:
+  typedef __m256 RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "div"; }
+  static inline uint64_t getHash() {
+    return opHash::divHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm256_div_ps (p.arg1, p.arg2);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &c) {
+    return _mm256_div_ps (_mm256_fnmadd_ps (c, p.arg2, p.arg1), p.arg2);
+  };
+
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    const RealType &x(p.arg1);
+    const RealType &y(p.arg2);
+    const __m256d zero = _mm256_setzero_pd ();
+    const __m256d r_lo = _mm256_fnmadd_pd (_mm256_cvtps_pd (_mm256_castps256_ps128 (c)),
+                                           _mm256_cvtps_pd (_mm256_castps256_ps128 (y)),
+                                           _mm256_cvtps_pd (_mm256_castps256_ps128 (x)));
+    const __m256d r_hi = _mm256_fnmadd_pd (_mm256_cvtps_pd (_mm256_extractf128_ps (c, 1)),
+                                           _mm256_cvtps_pd (_mm256_extractf128_ps (y, 1)),
+                                           _mm256_cvtps_pd (_mm256_extractf128_ps (x, 1)));
+    const __m256 r_gt_0 = packMasks (_mm256_cmp_pd (r_lo, zero, _CMP_GT_OQ), _mm256_cmp_pd (r_hi, zero, _CMP_GT_OQ));
+    const __m256 r_lt_0 = packMasks (_mm256_cmp_pd (r_lo, zero, _CMP_LT_OQ), _mm256_cmp_pd (r_hi, zero, _CMP_LT_OQ));
+    return _mm256_or_ps (_mm256_and_ps (r_gt_0, y),
+                         _mm256_and_ps (r_lt_0, _mm256_xor_ps (y, _mm256_set1_ps (-0.f))));
+  };
+
+  // the masks of the 4 low and 4 high float lanes, as one float mask
+  static inline __m256 packMasks(const __m256d &lo, const __m256d &hi) {
+    const __m256 mask = _mm256_shuffle_ps (_mm256_castpd_ps (lo), _mm256_castpd_ps (hi), _MM_SHUFFLE (2, 0, 2, 0));
+    return _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (mask), _MM_SHUFFLE (3, 1, 2, 0)));
   }
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return vr_simd<RealType>::any (areInfNotSpecificToNearest (p));
+  }
+
+  // division by zero
+  static inline __m256 areInfNotSpecificToNearest(const PackArgs &p) {
+    return _mm256_or_ps (hasNanInf(p.arg1), _mm256_cmp_ps (p.arg2, _mm256_setzero_ps(), _CMP_EQ_OQ));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
 };
-#endif
\ No newline at end of file
+#endif
+
+#if defined(__SSE4_2__)
+template <> class DivOp<__m128d> {
+public:
+  typedef __m128d RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "div"; }
+  static inline uint64_t getHash() {
+    return opHash::divHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm_div_pd (p.arg1, p.arg2);
+  };
+
+  // x-c*y
+  static inline RealType residual(const PackArgs &p, const RealType &c) {
+    const RealType &x(p.arg1);
+    const RealType &y(p.arg2);
+#if defined(__FMA__)
+    return _mm_fnmadd_pd (c, y, x);
+#else
+    // x-cy_hi is exact (Sterbenz) and so is x-cy_hi-cy_lo, unless twoProd
+    // overflows or the residual underflows: those lanes use the software fma
+    RealType cy_hi, cy_lo;
+    MulOp<__m128d>::twoProd(c, y, cy_hi, cy_lo);
+    RealType res = _mm_sub_pd (_mm_sub_pd (x, cy_hi), cy_lo);
+
+    const RealType absX = _mm_and_pd (x, _mm_castsi128_pd (_mm_set1_epi64x (0x7fffffffffffffff)));
+    const int notSafeLanes = _mm_movemask_pd (_mm_or_pd (_mm_cmpge_pd (absX, _mm_set1_pd (0x1p995)),
+                                                         _mm_cmplt_pd (absX, _mm_set1_pd (0x1p-969))));
+    if (notSafeLanes) {
+      double v_x[2], v_y[2], v_c[2], v_res[2];
+      _mm_storeu_pd (v_x, x);
+      _mm_storeu_pd (v_y, y);
+      _mm_storeu_pd (v_c, c);
+      _mm_storeu_pd (v_res, res);
+      for (int i = 0; i < 2; i++) {
+        if (notSafeLanes & (1 << i)) {
+          v_res[i] = -__verrou_internal_fma (v_c[i], v_y[i], -v_x[i]);
+        }
+      }
+      res = _mm_loadu_pd (v_res);
+    }
+    return res;
+#endif
+  }
+
+  static inline RealType error(const PackArgs &p, const RealType &c) {
+    return _mm_div_pd (residual(p, c), p.arg2);
+  };
+
+  // sign of the residual times the sign of y
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    return _mm_xor_pd (residual(p, c), _mm_and_pd (p.arg2, _mm_set1_pd (-0.)));
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return vr_simd<RealType>::any (areInfNotSpecificToNearest (p));
+  }
+
+  // division by zero
+  static inline __m128d areInfNotSpecificToNearest(const PackArgs &p) {
+    return _mm_or_pd (hasNanInf(p.arg1), _mm_cmpeq_pd (p.arg2, _mm_setzero_pd()));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+};
+#endif
+
+#if defined(__AVX2__)
+template <> class DivOp<__m256d> {
+public:
+  typedef __m256d RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "div"; }
+  static inline uint64_t getHash() {
+    return opHash::divHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm256_div_pd (p.arg1, p.arg2);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &c) {
+    return _mm256_div_pd (_mm256_fnmadd_pd (c, p.arg2, p.arg1), p.arg2);
+  };
+
+  // sign of the residual times the sign of y
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    return _mm256_xor_pd (_mm256_fnmadd_pd (c, p.arg2, p.arg1),
+                          _mm256_and_pd (p.arg2, _mm256_set1_pd (-0.)));
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return vr_simd<RealType>::any (areInfNotSpecificToNearest (p));
+  }
+
+  // division by zero
+  static inline __m256d areInfNotSpecificToNearest(const PackArgs &p) {
+    return _mm256_or_pd (hasNanInf(p.arg1), _mm256_cmp_pd (p.arg2, _mm256_setzero_pd(), _CMP_EQ_OQ));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+};
+#endif
+
+// MAddOp : ErrFmaApp (Exact and Aproximated Error of the FMA By Boldo and
+// Muller) on top of the vector twoProd and twoSum for double. The float
+// error is computed in double as vr_floatMAdd does: the product is exact,
+// TwoSum gives s + e == a * b + c, and s - z is exact. Without hardware fma
+// the SSE nearestOp uses the software fma, lane by lane.
+#if defined(__SSE4_2__)
+inline __m128d vr_floatMAddError(const __m128d &a, const __m128d &b,
+                                 const __m128d &c, const __m128d &z) {
+  const __m128d p = _mm_mul_pd (a, b);
+  const __m128d s = _mm_add_pd (p, c);
+  const __m128d t = _mm_sub_pd (s, p);
+  const __m128d e = _mm_add_pd (_mm_sub_pd (p, _mm_sub_pd (s, t)), _mm_sub_pd (c, t));
+  return _mm_add_pd (_mm_sub_pd (s, z), e);
+}
+
+// the error of the 2 low and the 2 high lanes
+inline void vr_floatMAddError(const vr_packArg<__m128, 3> &p, const __m128 &z,
+                              __m128d &e_lo, __m128d &e_hi) {
+  e_lo = vr_floatMAddError (_mm_cvtps_pd (p.arg1), _mm_cvtps_pd (p.arg2),
+                            _mm_cvtps_pd (p.arg3), _mm_cvtps_pd (z));
+  e_hi = vr_floatMAddError (_mm_cvtps_pd (_mm_movehl_ps (p.arg1, p.arg1)),
+                            _mm_cvtps_pd (_mm_movehl_ps (p.arg2, p.arg2)),
+                            _mm_cvtps_pd (_mm_movehl_ps (p.arg3, p.arg3)),
+                            _mm_cvtps_pd (_mm_movehl_ps (z, z)));
+}
+
+template<>
+inline __m128 MAddOp<__m128>::nearestOp(const PackArgs &p) {
+#if defined(__FMA__)
+  return _mm_fmadd_ps (p.arg1, p.arg2, p.arg3);
+#else
+  float v_a[4], v_b[4], v_c[4];
+  _mm_storeu_ps (v_a, p.arg1);
+  _mm_storeu_ps (v_b, p.arg2);
+  _mm_storeu_ps (v_c, p.arg3);
+  for (int i = 0; i < 4; i++) {
+    v_a[i] = __verrou_internal_fma (v_a[i], v_b[i], v_c[i]);
+  }
+  return _mm_loadu_ps (v_a);
+#endif
+}
+
+template<>
+inline __m128 MAddOp<__m128>::error (const PackArgs& p, const RealType& z) {
+  __m128d e_lo, e_hi;
+  vr_floatMAddError (p, z, e_lo, e_hi);
+  return _mm_movelh_ps (_mm_cvtpd_ps (e_lo), _mm_cvtpd_ps (e_hi));
+}
+
+template<>
+inline __m128 MAddOp<__m128>::sameSignOfError (const PackArgs& p, const RealType& c) {
+  __m128d e_lo, e_hi;
+  vr_floatMAddError (p, c, e_lo, e_hi);
+  return _mm_movelh_ps (_mm_cvtpd_ps (MulOp<__m128>::doubleSign (e_lo)),
+                        _mm_cvtpd_ps (MulOp<__m128>::doubleSign (e_hi)));
+}
+
+template<>
+inline __m128d MAddOp<__m128d>::nearestOp(const PackArgs &p) {
+#if defined(__FMA__)
+  return _mm_fmadd_pd (p.arg1, p.arg2, p.arg3);
+#else
+  double v_a[2], v_b[2], v_c[2];
+  _mm_storeu_pd (v_a, p.arg1);
+  _mm_storeu_pd (v_b, p.arg2);
+  _mm_storeu_pd (v_c, p.arg3);
+  for (int i = 0; i < 2; i++) {
+    v_a[i] = __verrou_internal_fma (v_a[i], v_b[i], v_c[i]);
+  }
+  return _mm_loadu_pd (v_a);
+#endif
+}
+
+template<>
+inline __m128d MAddOp<__m128d>::error (const PackArgs& p, const RealType& z) {
+  RealType ph, pl;
+  MulOp<RealType>::twoProd(p.arg1, p.arg2, ph, pl);
+  RealType uh, ul;
+  AddOp<RealType>::twoSum(p.arg3, ph, uh, ul);
+  return _mm_add_pd (_mm_sub_pd (uh, z), _mm_add_pd (pl, ul));
+}
+#endif
+
+#if defined(__AVX2__)
+inline __m256d vr_floatMAddError(const __m256d &a, const __m256d &b,
+                                 const __m256d &c, const __m256d &z) {
+  const __m256d p = _mm256_mul_pd (a, b);
+  const __m256d s = _mm256_add_pd (p, c);
+  const __m256d t = _mm256_sub_pd (s, p);
+  const __m256d e = _mm256_add_pd (_mm256_sub_pd (p, _mm256_sub_pd (s, t)), _mm256_sub_pd (c, t));
+  return _mm256_add_pd (_mm256_sub_pd (s, z), e);
+}
+
+// the error of the 4 low and the 4 high lanes
+inline void vr_floatMAddError(const vr_packArg<__m256, 3> &p, const __m256 &z,
+                              __m256d &e_lo, __m256d &e_hi) {
+  e_lo = vr_floatMAddError (_mm256_cvtps_pd (_mm256_castps256_ps128 (p.arg1)),
+                            _mm256_cvtps_pd (_mm256_castps256_ps128 (p.arg2)),
+                            _mm256_cvtps_pd (_mm256_castps256_ps128 (p.arg3)),
+                            _mm256_cvtps_pd (_mm256_castps256_ps128 (z)));
+  e_hi = vr_floatMAddError (_mm256_cvtps_pd (_mm256_extractf128_ps (p.arg1, 1)),
+                            _mm256_cvtps_pd (_mm256_extractf128_ps (p.arg2, 1)),
+                            _mm256_cvtps_pd (_mm256_extractf128_ps (p.arg3, 1)),
+                            _mm256_cvtps_pd (_mm256_extractf128_ps (z, 1)));
+}
+
+template<>
+inline __m256 MAddOp<__m256>::nearestOp(const PackArgs &p) {
+  return _mm256_fmadd_ps (p.arg1, p.arg2, p.arg3);
+}
+
+template<>
+inline __m256 MAddOp<__m256>::error (const PackArgs& p, const RealType& z) {
+  __m256d e_lo, e_hi;
+  vr_floatMAddError (p, z, e_lo, e_hi);
+  return _mm256_set_m128 (_mm256_cvtpd_ps (e_hi), _mm256_cvtpd_ps (e_lo));
+}
+
+template<>
+inline __m256 MAddOp<__m256>::sameSignOfError (const PackArgs& p, const RealType& c) {
+  __m256d e_lo, e_hi;
+  vr_floatMAddError (p, c, e_lo, e_hi);
+  return _mm256_set_m128 (_mm256_cvtpd_ps (MulOp<__m256>::doubleSign (e_hi)),
+                          _mm256_cvtpd_ps (MulOp<__m256>::doubleSign (e_lo)));
+}
+
+template<>
+inline __m256d MAddOp<__m256d>::nearestOp(const PackArgs &p) {
+  return _mm256_fmadd_pd (p.arg1, p.arg2, p.arg3);
+}
+
+template<>
+inline __m256d MAddOp<__m256d>::error (const PackArgs& p, const RealType& z) {
+  RealType ph, pl;
+  MulOp<RealType>::twoProd(p.arg1, p.arg2, ph, pl);
+  RealType uh, ul;
+  AddOp<RealType>::twoSum(p.arg3, ph, uh, ul);
+  return _mm256_add_pd (_mm256_sub_pd (uh, z), _mm256_add_pd (pl, ul));
+}
+#endif
+
+// CastOp : the float results of the conversion of a vector of doubles are
+// packed in the low lanes of a __m128
+#if defined(__SSE4_2__)
+template <> class CastOp<__m128d, __m128> {
+public:
+  typedef __m128d RealTypeIn;
+  typedef __m128 RealTypeOut;
+  typedef RealTypeOut RealType;
+  typedef vr_packArg<RealTypeIn, 1> PackArgs;
+
+  static const char *OpName() { return "cast"; }
+  static inline uint64_t getHash() {
+    return opHash::castHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealTypeOut nearestOp(const PackArgs &p) {
+    return _mm_cvtpd_ps (p.arg1);
+  };
+
+  static inline RealTypeOut error(const PackArgs &p, const RealTypeOut &z) {
+    const RealTypeIn errorHo = _mm_sub_pd (p.arg1, _mm_cvtps_pd (z));
+    return _mm_cvtpd_ps (errorHo);
+  };
+
+  static inline RealTypeOut sameSignOfError(const PackArgs &p,
+                                            const RealTypeOut &c) {
+    return error(p, c);
+  };
+
+  static inline __m128 areInfNotSpecificToNearest(const PackArgs &p) {
+    const __m128 mask = _mm_castpd_ps (p.hasOneArgNanInf());
+    return _mm_shuffle_ps (mask, _mm_setzero_ps(), _MM_SHUFFLE (0, 0, 2, 0));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealTypeOut &d){};
+};
+#endif
+
+#if defined(__AVX2__)
+template <> class CastOp<__m256d, __m128> {
+public:
+  typedef __m256d RealTypeIn;
+  typedef __m128 RealTypeOut;
+  typedef RealTypeOut RealType;
+  typedef vr_packArg<RealTypeIn, 1> PackArgs;
+
+  static const char *OpName() { return "cast"; }
+  static inline uint64_t getHash() {
+    return opHash::castHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealTypeOut nearestOp(const PackArgs &p) {
+    return _mm256_cvtpd_ps (p.arg1);
+  };
+
+  static inline RealTypeOut error(const PackArgs &p, const RealTypeOut &z) {
+    const RealTypeIn errorHo = _mm256_sub_pd (p.arg1, _mm256_cvtps_pd (z));
+    return _mm256_cvtpd_ps (errorHo);
+  };
+
+  static inline RealTypeOut sameSignOfError(const PackArgs &p,
+                                            const RealTypeOut &c) {
+    return error(p, c);
+  };
+
+  static inline __m128 areInfNotSpecificToNearest(const PackArgs &p) {
+    const __m256 mask = _mm256_castpd_ps (p.hasOneArgNanInf());
+    return _mm_shuffle_ps (_mm256_castps256_ps128 (mask),
+                           _mm256_extractf128_ps (mask, 1),
+                           _MM_SHUFFLE (2, 0, 2, 0));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealTypeOut &d){};
+};
+#endif
+
+#if defined(__AVX512F__)
+// vr_packArg
+template<>
+inline __mmask16 vr_packArg<__m512, 1>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1);
+}
+
+template<>
+inline __mmask16 vr_packArg<__m512, 2>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1) | hasNanInf(this->arg2);
+}
+
+template<>
+inline __mmask16 vr_packArg<__m512, 3>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1) | hasNanInf(this->arg2) | hasNanInf(this->arg3);
+}
+
+template<>
+inline __mmask8 vr_packArg<__m512d, 1>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1);
+}
+
+template<>
+inline __mmask8 vr_packArg<__m512d, 2>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1) | hasNanInf(this->arg2);
+}
+
+template<>
+inline __mmask8 vr_packArg<__m512d, 3>::hasOneArgNanInf() const {
+  return hasNanInf(this->arg1) | hasNanInf(this->arg2) | hasNanInf(this->arg3);
+}
+
+// AddOp
+template<>
+inline __m512 AddOp<__m512>::nearestOp(const PackArgs &p) {
+  return _mm512_add_ps (p.arg1, p.arg2);
+}
+
+template<>
+inline __m512 AddOp<__m512>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(p.arg2);
+  const RealType z = _mm512_sub_ps (x, a);
+  return _mm512_add_ps (
+            _mm512_sub_ps (a, _mm512_sub_ps(x, z)),
+            _mm512_sub_ps (b, z)
+          );
+}
+
+template<>
+inline __m512d AddOp<__m512d>::nearestOp(const PackArgs &p) {
+  return _mm512_add_pd (p.arg1, p.arg2);
+}
+
+template<>
+inline __m512d AddOp<__m512d>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(p.arg2);
+  const RealType z = _mm512_sub_pd (x, a);
+  return _mm512_add_pd (
+            _mm512_sub_pd (a, _mm512_sub_pd(x, z)),
+            _mm512_sub_pd (b, z)
+          );
+}
+
+// SubOp
+template<>
+inline __m512 SubOp<__m512>::nearestOp(const PackArgs &p) {
+  return _mm512_sub_ps (p.arg1, p.arg2);
+}
+
+template<>
+inline __m512 SubOp<__m512>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(_mm512_sub_ps (_mm512_setzero_ps(), p.arg2));
+  const RealType z = _mm512_sub_ps (x, a);
+  return _mm512_add_ps (
+            _mm512_sub_ps (a, _mm512_sub_ps(x, z)),
+            _mm512_sub_ps (b, z)
+          );
+}
+
+template<>
+inline __m512d SubOp<__m512d>::nearestOp(const PackArgs &p) {
+  return _mm512_sub_pd (p.arg1, p.arg2);
+}
+
+template<>
+inline __m512d SubOp<__m512d>::error (const PackArgs& p, const RealType& x) {
+  const RealType & a(p.arg1);
+  const RealType & b(_mm512_sub_pd (_mm512_setzero_pd(), p.arg2));
+  const RealType z = _mm512_sub_pd (x, a);
+  return _mm512_add_pd (
+            _mm512_sub_pd (a, _mm512_sub_pd(x, z)),
+            _mm512_sub_pd (b, z)
+          );
+}
+
+// MulOp
+template <> class MulOp<__m512> {
+public:
+  typedef __m512 RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "mul"; }
+  static inline uint64_t getHash() {
+    return opHash::mulHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm512_mul_ps (p.arg1, p.arg2);
+  };
+
+  // in double: the fma error underflows for subnormal products
+  static inline RealType error(const PackArgs &p, const RealType &x) {
+    __m512d e_lo, e_hi;
+    MulOp<__m512>::doubleError(p, x, e_lo, e_hi);
+    return fromHalves (_mm512_cvtpd_ps (e_lo), _mm512_cvtpd_ps (e_hi));
+  };
+
+  // the error of the 8 low and the 8 high lanes, in double
+  static inline void doubleError(const PackArgs &p, const RealType &x,
+                                 __m512d &e_lo, __m512d &e_hi) {
+    e_lo = _mm512_sub_pd (_mm512_mul_pd (_mm512_cvtps_pd (lowHalf (p.arg1)),
+                                         _mm512_cvtps_pd (lowHalf (p.arg2))),
+                          _mm512_cvtps_pd (lowHalf (x)));
+    e_hi = _mm512_sub_pd (_mm512_mul_pd (_mm512_cvtps_pd (highHalf (p.arg1)),
+                                         _mm512_cvtps_pd (highHalf (p.arg2))),
+                          _mm512_cvtps_pd (highHalf (x)));
+  }
+
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    __m512d e_lo, e_hi;
+    MulOp<__m512>::doubleError(p, c, e_lo, e_hi);
+    return doubleSign (e_lo, e_hi);
+  };
+
+  // -1, 0 or 1, for the 8 low and the 8 high lanes
+  static inline __m512 doubleSign(const __m512d &e_lo, const __m512d &e_hi) {
+    const __m512d zero = _mm512_setzero_pd ();
+    const __mmask16 gt = _mm512_cmp_pd_mask (e_lo, zero, _CMP_GT_OQ)
+                       | (_mm512_cmp_pd_mask (e_hi, zero, _CMP_GT_OQ) << 8);
+    const __mmask16 lt = _mm512_cmp_pd_mask (e_lo, zero, _CMP_LT_OQ)
+                       | (_mm512_cmp_pd_mask (e_hi, zero, _CMP_LT_OQ) << 8);
+    return _mm512_mask_blend_ps (lt, _mm512_maskz_mov_ps (gt, _mm512_set1_ps (1.f)), _mm512_set1_ps (-1.f));
+  }
+
+  // the 256-bit halves, with avx512f only
+  static inline __m256 lowHalf(const __m512 &x) { return _mm512_castps512_ps256 (x); }
+  static inline __m256 highHalf(const __m512 &x) {
+    return _mm256_castpd_ps (_mm512_extractf64x4_pd (_mm512_castps_pd (x), 1));
+  }
+  static inline __m512 fromHalves(const __m256 &lo, const __m256 &hi) {
+    return _mm512_castpd_ps (_mm512_insertf64x4 (_mm512_castpd256_pd512 (_mm256_castps_pd (lo)),
+                                                 _mm256_castps_pd (hi), 1));
+  }
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return p.isOneArgNanInf();
+  }
+
+  static inline __mmask16 areInfNotSpecificToNearest(const PackArgs &p) {
+    return p.hasOneArgNanInf();
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+
+  static inline void twoProd(const RealType &a, const RealType &b, RealType &x,
+                             RealType &y) {
+    const PackArgs p(a, b);
+    x = MulOp<__m512>::nearestOp(p);
+    y = MulOp<__m512>::error(p, x);
+  }
+};
+
+template <> class MulOp<__m512d> {
+public:
+  typedef __m512d RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "mul"; }
+  static inline uint64_t getHash() {
+    return opHash::mulHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm512_mul_pd (p.arg1, p.arg2);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &x) {
+    return _mm512_fmsub_pd (p.arg1, p.arg2, x);
+  };
+
+  // Only the sign of the lanes is used by the rounding modes. When the
+  // product underflows to zero the sign of the error is the one of a*b.
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    const __m512i signMask = _mm512_set1_epi64 (0x8000000000000000);
+    const __m512d signOfProduct = _mm512_castsi512_pd (
+        _mm512_xor_si512 (_mm512_castpd_si512 (p.arg2),
+                          _mm512_and_si512 (_mm512_castpd_si512 (p.arg1), signMask)));
+    const __mmask8 underflow = _mm512_cmp_pd_mask (c, _mm512_setzero_pd(), _CMP_EQ_OQ)
+                             & _mm512_cmp_pd_mask (p.arg1, _mm512_setzero_pd(), _CMP_NEQ_UQ);
+    return _mm512_mask_blend_pd (underflow, MulOp<__m512d>::error(p, c), signOfProduct);
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return p.isOneArgNanInf();
+  }
+
+  static inline __mmask8 areInfNotSpecificToNearest(const PackArgs &p) {
+    return p.hasOneArgNanInf();
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+
+  static inline void twoProd(const RealType &a, const RealType &b, RealType &x,
+                             RealType &y) {
+    const PackArgs p(a, b);
+    x = MulOp<__m512d>::nearestOp(p);
+    y = MulOp<__m512d>::error(p, x);
+  }
+};
+
+// DivOp
+template <> class DivOp<__m512> {
+public:
+  typedef __m512 RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "div"; }
+  static inline uint64_t getHash() {
+    return opHash::divHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm512_div_ps (p.arg1, p.arg2);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &c) {
+    return _mm512_div_ps (_mm512_fnmadd_ps (c, p.arg2, p.arg1), p.arg2);
+  };
+
+  // the sign of the residual is computed in double, as the scalar DivOp<float>
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    const RealType &x(p.arg1);
+    const RealType &y(p.arg2);
+    const __m512d zero = _mm512_setzero_pd ();
+    const __m512d r_lo = _mm512_fnmadd_pd (_mm512_cvtps_pd (_mm512_castps512_ps256 (c)),
+                                           _mm512_cvtps_pd (_mm512_castps512_ps256 (y)),
+                                           _mm512_cvtps_pd (_mm512_castps512_ps256 (x)));
+    const __m512d r_hi = _mm512_fnmadd_pd (_mm512_cvtps_pd (_mm256_castpd_ps (_mm512_extractf64x4_pd (_mm512_castps_pd (c), 1))),
+                                           _mm512_cvtps_pd (_mm256_castpd_ps (_mm512_extractf64x4_pd (_mm512_castps_pd (y), 1))),
+                                           _mm512_cvtps_pd (_mm256_castpd_ps (_mm512_extractf64x4_pd (_mm512_castps_pd (x), 1))));
+    const __mmask16 r_gt_0 = (__mmask16) (_mm512_cmp_pd_mask (r_lo, zero, _CMP_GT_OQ)
+                                          | (_mm512_cmp_pd_mask (r_hi, zero, _CMP_GT_OQ) << 8));
+    const __mmask16 r_lt_0 = (__mmask16) (_mm512_cmp_pd_mask (r_lo, zero, _CMP_LT_OQ)
+                                          | (_mm512_cmp_pd_mask (r_hi, zero, _CMP_LT_OQ) << 8));
+    const __m512 minus_y = _mm512_castsi512_ps (_mm512_xor_si512 (_mm512_castps_si512 (y), _mm512_set1_epi32 (0x80000000)));
+    return _mm512_mask_blend_ps (r_gt_0, _mm512_maskz_mov_ps (r_lt_0, minus_y), y);
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return areInfNotSpecificToNearest(p) != 0;
+  }
+
+  // division by zero
+  static inline __mmask16 areInfNotSpecificToNearest(const PackArgs &p) {
+    return hasNanInf(p.arg1) | _mm512_cmp_ps_mask (p.arg2, _mm512_setzero_ps(), _CMP_EQ_OQ);
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+};
+
+template <> class DivOp<__m512d> {
+public:
+  typedef __m512d RealType;
+  typedef vr_packArg<RealType, 2> PackArgs;
+
+  static const char *OpName() { return "div"; }
+  static inline uint64_t getHash() {
+    return opHash::divHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealType nearestOp(const PackArgs &p) {
+    return _mm512_div_pd (p.arg1, p.arg2);
+  };
+
+  static inline RealType error(const PackArgs &p, const RealType &c) {
+    return _mm512_div_pd (_mm512_fnmadd_pd (c, p.arg2, p.arg1), p.arg2);
+  };
+
+  // sign of the residual times the sign of y
+  static inline RealType sameSignOfError(const PackArgs &p, const RealType &c) {
+    return _mm512_castsi512_pd (
+        _mm512_xor_si512 (_mm512_castpd_si512 (_mm512_fnmadd_pd (c, p.arg2, p.arg1)),
+                          _mm512_and_si512 (_mm512_castpd_si512 (p.arg2), _mm512_set1_epi64 (0x8000000000000000))));
+  };
+
+  static inline bool isInfNotSpecificToNearest(const PackArgs &p) {
+    return areInfNotSpecificToNearest(p) != 0;
+  }
+
+  // division by zero
+  static inline __mmask8 areInfNotSpecificToNearest(const PackArgs &p) {
+    return hasNanInf(p.arg1) | _mm512_cmp_pd_mask (p.arg2, _mm512_setzero_pd(), _CMP_EQ_OQ);
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealType &c){};
+};
+
+// MAddOp, the float error in double as MAddOp<__m128>
+inline __m512d vr_floatMAddError(const __m512d &a, const __m512d &b,
+                                 const __m512d &c, const __m512d &z) {
+  const __m512d p = _mm512_mul_pd (a, b);
+  const __m512d s = _mm512_add_pd (p, c);
+  const __m512d t = _mm512_sub_pd (s, p);
+  const __m512d e = _mm512_add_pd (_mm512_sub_pd (p, _mm512_sub_pd (s, t)), _mm512_sub_pd (c, t));
+  return _mm512_add_pd (_mm512_sub_pd (s, z), e);
+}
+
+// the error of the 8 low and the 8 high lanes
+inline void vr_floatMAddError(const vr_packArg<__m512, 3> &p, const __m512 &z,
+                              __m512d &e_lo, __m512d &e_hi) {
+  typedef MulOp<__m512> Mul;
+  e_lo = vr_floatMAddError (_mm512_cvtps_pd (Mul::lowHalf (p.arg1)),
+                            _mm512_cvtps_pd (Mul::lowHalf (p.arg2)),
+                            _mm512_cvtps_pd (Mul::lowHalf (p.arg3)),
+                            _mm512_cvtps_pd (Mul::lowHalf (z)));
+  e_hi = vr_floatMAddError (_mm512_cvtps_pd (Mul::highHalf (p.arg1)),
+                            _mm512_cvtps_pd (Mul::highHalf (p.arg2)),
+                            _mm512_cvtps_pd (Mul::highHalf (p.arg3)),
+                            _mm512_cvtps_pd (Mul::highHalf (z)));
+}
+
+template<>
+inline __m512 MAddOp<__m512>::nearestOp(const PackArgs &p) {
+  return _mm512_fmadd_ps (p.arg1, p.arg2, p.arg3);
+}
+
+template<>
+inline __m512 MAddOp<__m512>::error (const PackArgs& p, const RealType& z) {
+  __m512d e_lo, e_hi;
+  vr_floatMAddError (p, z, e_lo, e_hi);
+  return MulOp<__m512>::fromHalves (_mm512_cvtpd_ps (e_lo), _mm512_cvtpd_ps (e_hi));
+}
+
+template<>
+inline __m512 MAddOp<__m512>::sameSignOfError (const PackArgs& p, const RealType& c) {
+  __m512d e_lo, e_hi;
+  vr_floatMAddError (p, c, e_lo, e_hi);
+  return MulOp<__m512>::doubleSign (e_lo, e_hi);
+}
+
+template<>
+inline __m512d MAddOp<__m512d>::nearestOp(const PackArgs &p) {
+  return _mm512_fmadd_pd (p.arg1, p.arg2, p.arg3);
+}
+
+template<>
+inline __m512d MAddOp<__m512d>::error (const PackArgs& p, const RealType& z) {
+  RealType ph, pl;
+  MulOp<RealType>::twoProd(p.arg1, p.arg2, ph, pl);
+  RealType uh, ul;
+  AddOp<RealType>::twoSum(p.arg3, ph, uh, ul);
+  return _mm512_add_pd (_mm512_sub_pd (uh, z), _mm512_add_pd (pl, ul));
+}
+
+// CastOp
+template <> class CastOp<__m512d, __m256> {
+public:
+  typedef __m512d RealTypeIn;
+  typedef __m256 RealTypeOut;
+  typedef RealTypeOut RealType;
+  typedef vr_packArg<RealTypeIn, 1> PackArgs;
+
+  static const char *OpName() { return "cast"; }
+  static inline uint64_t getHash() {
+    return opHash::castHash * typeHash::nbTypeHash + getTypeHash<RealType>();
+  }
+  static inline uint64_t getComdetHash() { return getHash(); };
+
+  static inline RealTypeOut nearestOp(const PackArgs &p) {
+    return _mm512_cvtpd_ps (p.arg1);
+  };
+
+  static inline RealTypeOut error(const PackArgs &p, const RealTypeOut &z) {
+    const RealTypeIn errorHo = _mm512_sub_pd (p.arg1, _mm512_cvtps_pd (z));
+    return _mm512_cvtpd_ps (errorHo);
+  };
+
+  static inline RealTypeOut sameSignOfError(const PackArgs &p,
+                                            const RealTypeOut &c) {
+    return error(p, c);
+  };
+
+  // The result lanes are __m256 lanes: expand the __mmask8 to a vector mask
+  static inline __m256 areInfNotSpecificToNearest(const PackArgs &p) {
+    const __m512i mask = _mm512_maskz_mov_epi64 (p.hasOneArgNanInf(), _mm512_set1_epi64 (-1));
+    return _mm256_castsi256_ps (_mm512_cvtepi64_epi32 (mask));
+  }
+
+  static inline void check([[maybe_unused]] const PackArgs &p,
+                           [[maybe_unused]] const RealTypeOut &d){};
+};
+#endif
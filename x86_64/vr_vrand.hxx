@@ -0,0 +1,353 @@
+/*--------------------------------------------------------------------*/
+/*--- Verrou: a FPU instrumentation tool.                          ---*/
+/*--- Lane-parallel random generator of the vector rounding modes. ---*/
+/*---                                                  vr_vrand.hxx ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of Verrou, a FPU instrumentation tool.
+
+   Copyright (C) 2014-2021 EDF
+     F. Févotte     <francois.fevotte@edf.fr>
+     B. Lathuilière <bruno.lathuiliere@edf.fr>
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307, USA.
+
+   The GNU Lesser General Public License is contained in the file COPYING.
+*/
+
+#pragma once
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "interflop/prng/vr_rand.h"
+#include "vr_simd.hxx"
+#include "vr_vhash.hxx"
+
+/*
+ * Vr_VRand holds VR_VRAND_NB_LANES independent xoshiro128+ streams, stored
+ * by state word so that one aligned load gives the same word of consecutive
+ * streams. A vector of n 32-bit lanes steps the n first streams at once:
+ *  - float lanes use one 32-bit output each
+ *  - double lanes use the two 32-bit outputs they overlap
+ * It lives in vr_vrand, next to vr_rand, and is seeded with it.
+ */
+#define VR_VRAND_NB_LANES 16
+
+typedef struct Vr_VRand_ {
+  uint32_t s[4][VR_VRAND_NB_LANES] __attribute__((aligned(64)));
+} Vr_VRand;
+
+extern "C" TLS Vr_VRand vr_vrand;
+
+inline void vr_vrand_setSeed(Vr_VRand *r, uint64_t seed) {
+  // splitmix64 gives uncorrelated initial states to the streams
+  uint64_t x = seed;
+  for (int lane = 0; lane < VR_VRAND_NB_LANES; lane++) {
+    for (int i = 0; i < 4; i++) {
+      uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      z = z ^ (z >> 31);
+      r->s[i][lane] = (uint32_t)(z >> 32);
+    }
+  }
+}
+
+template <class VT>
+inline typename vr_simd<VT>::MaskType vr_vrand_bool(Vr_VRand *r);
+
+template <class VT> inline VT vr_vrand_ratio(Vr_VRand *r);
+
+/*
+ * The random bits are taken from the high bits of the xoshiro128+ outputs:
+ * the sign bit for the booleans, the mantissa for the ratios in [0,1).
+ */
+#if defined(__SSE4_2__)
+inline __m128i vr_vrand_next128(Vr_VRand *r) {
+  __m128i s0 = _mm_load_si128 ((const __m128i *)r->s[0]);
+  __m128i s1 = _mm_load_si128 ((const __m128i *)r->s[1]);
+  __m128i s2 = _mm_load_si128 ((const __m128i *)r->s[2]);
+  __m128i s3 = _mm_load_si128 ((const __m128i *)r->s[3]);
+
+  const __m128i res = _mm_add_epi32 (s0, s3);
+  const __m128i t = _mm_slli_epi32 (s1, 9);
+  s2 = _mm_xor_si128 (s2, s0);
+  s3 = _mm_xor_si128 (s3, s1);
+  s1 = _mm_xor_si128 (s1, s2);
+  s0 = _mm_xor_si128 (s0, s3);
+  s2 = _mm_xor_si128 (s2, t);
+  s3 = _mm_or_si128 (_mm_slli_epi32 (s3, 11), _mm_srli_epi32 (s3, 21));
+
+  _mm_store_si128 ((__m128i *)r->s[0], s0);
+  _mm_store_si128 ((__m128i *)r->s[1], s1);
+  _mm_store_si128 ((__m128i *)r->s[2], s2);
+  _mm_store_si128 ((__m128i *)r->s[3], s3);
+  return res;
+}
+
+template <> inline __m128 vr_vrand_bool<__m128>(Vr_VRand *r) {
+  return _mm_castsi128_ps (_mm_srai_epi32 (vr_vrand_next128 (r), 31));
+}
+
+template <> inline __m128d vr_vrand_bool<__m128d>(Vr_VRand *r) {
+  const __m128i sign = _mm_srai_epi32 (vr_vrand_next128 (r), 31);
+  return _mm_castsi128_pd (_mm_shuffle_epi32 (sign, _MM_SHUFFLE (3, 3, 1, 1)));
+}
+
+template <> inline __m128 vr_vrand_ratio<__m128>(Vr_VRand *r) {
+  const __m128i u = _mm_or_si128 (_mm_srli_epi32 (vr_vrand_next128 (r), 9),
+                                  _mm_set1_epi32 (0x3f800000));
+  return _mm_sub_ps (_mm_castsi128_ps (u), _mm_set1_ps (1.f));
+}
+
+template <> inline __m128d vr_vrand_ratio<__m128d>(Vr_VRand *r) {
+  const __m128i u = _mm_or_si128 (_mm_srli_epi64 (vr_vrand_next128 (r), 12),
+                                  _mm_set1_epi64x (0x3ff0000000000000LL));
+  return _mm_sub_pd (_mm_castsi128_pd (u), _mm_set1_pd (1.));
+}
+#endif
+
+#if defined(__AVX2__)
+inline __m256i vr_vrand_next256(Vr_VRand *r) {
+  __m256i s0 = _mm256_load_si256 ((const __m256i *)r->s[0]);
+  __m256i s1 = _mm256_load_si256 ((const __m256i *)r->s[1]);
+  __m256i s2 = _mm256_load_si256 ((const __m256i *)r->s[2]);
+  __m256i s3 = _mm256_load_si256 ((const __m256i *)r->s[3]);
+
+  const __m256i res = _mm256_add_epi32 (s0, s3);
+  const __m256i t = _mm256_slli_epi32 (s1, 9);
+  s2 = _mm256_xor_si256 (s2, s0);
+  s3 = _mm256_xor_si256 (s3, s1);
+  s1 = _mm256_xor_si256 (s1, s2);
+  s0 = _mm256_xor_si256 (s0, s3);
+  s2 = _mm256_xor_si256 (s2, t);
+  s3 = _mm256_or_si256 (_mm256_slli_epi32 (s3, 11), _mm256_srli_epi32 (s3, 21));
+
+  _mm256_store_si256 ((__m256i *)r->s[0], s0);
+  _mm256_store_si256 ((__m256i *)r->s[1], s1);
+  _mm256_store_si256 ((__m256i *)r->s[2], s2);
+  _mm256_store_si256 ((__m256i *)r->s[3], s3);
+  return res;
+}
+
+template <> inline __m256 vr_vrand_bool<__m256>(Vr_VRand *r) {
+  return _mm256_castsi256_ps (_mm256_srai_epi32 (vr_vrand_next256 (r), 31));
+}
+
+template <> inline __m256d vr_vrand_bool<__m256d>(Vr_VRand *r) {
+  const __m256i sign = _mm256_srai_epi32 (vr_vrand_next256 (r), 31);
+  return _mm256_castsi256_pd (_mm256_shuffle_epi32 (sign, _MM_SHUFFLE (3, 3, 1, 1)));
+}
+
+template <> inline __m256 vr_vrand_ratio<__m256>(Vr_VRand *r) {
+  const __m256i u = _mm256_or_si256 (_mm256_srli_epi32 (vr_vrand_next256 (r), 9),
+                                     _mm256_set1_epi32 (0x3f800000));
+  return _mm256_sub_ps (_mm256_castsi256_ps (u), _mm256_set1_ps (1.f));
+}
+
+template <> inline __m256d vr_vrand_ratio<__m256d>(Vr_VRand *r) {
+  const __m256i u = _mm256_or_si256 (_mm256_srli_epi64 (vr_vrand_next256 (r), 12),
+                                     _mm256_set1_epi64x (0x3ff0000000000000LL));
+  return _mm256_sub_pd (_mm256_castsi256_pd (u), _mm256_set1_pd (1.));
+}
+#endif
+
+#if defined(__AVX512F__)
+inline __m512i vr_vrand_next512(Vr_VRand *r) {
+  __m512i s0 = _mm512_load_si512 ((const void *)r->s[0]);
+  __m512i s1 = _mm512_load_si512 ((const void *)r->s[1]);
+  __m512i s2 = _mm512_load_si512 ((const void *)r->s[2]);
+  __m512i s3 = _mm512_load_si512 ((const void *)r->s[3]);
+
+  const __m512i res = _mm512_add_epi32 (s0, s3);
+  const __m512i t = _mm512_slli_epi32 (s1, 9);
+  s2 = _mm512_xor_si512 (s2, s0);
+  s3 = _mm512_xor_si512 (s3, s1);
+  s1 = _mm512_xor_si512 (s1, s2);
+  s0 = _mm512_xor_si512 (s0, s3);
+  s2 = _mm512_xor_si512 (s2, t);
+  s3 = _mm512_rol_epi32 (s3, 11);
+
+  _mm512_store_si512 ((void *)r->s[0], s0);
+  _mm512_store_si512 ((void *)r->s[1], s1);
+  _mm512_store_si512 ((void *)r->s[2], s2);
+  _mm512_store_si512 ((void *)r->s[3], s3);
+  return res;
+}
+
+template <> inline __mmask16 vr_vrand_bool<__m512>(Vr_VRand *r) {
+  return _mm512_cmplt_epi32_mask (vr_vrand_next512 (r), _mm512_setzero_si512 ());
+}
+
+template <> inline __mmask8 vr_vrand_bool<__m512d>(Vr_VRand *r) {
+  return _mm512_cmplt_epi64_mask (vr_vrand_next512 (r), _mm512_setzero_si512 ());
+}
+
+template <> inline __m512 vr_vrand_ratio<__m512>(Vr_VRand *r) {
+  const __m512i u = _mm512_or_si512 (_mm512_srli_epi32 (vr_vrand_next512 (r), 9),
+                                     _mm512_set1_epi32 (0x3f800000));
+  return _mm512_sub_ps (_mm512_castsi512_ps (u), _mm512_set1_ps (1.f));
+}
+
+template <> inline __m512d vr_vrand_ratio<__m512d>(Vr_VRand *r) {
+  const __m512i u = _mm512_or_si512 (_mm512_srli_epi64 (vr_vrand_next512 (r), 12),
+                                     _mm512_set1_epi64 (0x3ff0000000000000LL));
+  return _mm512_sub_pd (_mm512_castsi512_pd (u), _mm512_set1_pd (1.));
+}
+#endif
+
+/*
+ * Vector counterparts of the RAND policies of ../vr_rand_implem.h: same
+ * interface, but one boolean or ratio per lane.
+ *  - vr_vrand_prng draws its bits from vr_vrand (the vr_rand argument only
+ *    provides the prandom probability)
+ *  - vr_vrand_det and vr_vrand_comdet give the same result on each lane as
+ *    vr_rand_det and vr_rand_comdet on the corresponding scalar operation
+ */
+template <class OP> class vr_vrand_prng {
+public:
+  typedef typename OP::RealType RealType;
+
+  static inline typename vr_simd<RealType>::MaskType
+  randBool([[maybe_unused]] Vr_Rand *r,
+           [[maybe_unused]] const typename OP::PackArgs &p) {
+    return vr_vrand_bool<RealType>(&vr_vrand);
+  }
+
+  static inline RealType randRatio([[maybe_unused]] Vr_Rand *r,
+                                   [[maybe_unused]] const typename OP::PackArgs &p) {
+    return vr_vrand_ratio<RealType>(&vr_vrand);
+  }
+};
+
+template <class OP, class HASH = VERROU_DET_HASH> class vr_vrand_det {
+public:
+  typedef typename OP::RealType RealType;
+
+  static inline typename vr_simd<RealType>::MaskType
+  randBool(const Vr_Rand *r, const typename OP::PackArgs &p) {
+    return vr_vhash<HASH>::template hashBool<RealType>(r, p, OP::getHash());
+  }
+
+  static inline RealType randRatio(const Vr_Rand *r,
+                                   const typename OP::PackArgs &p) {
+    return vr_vhash<HASH>::template hashRatio<RealType>(r, p, OP::getHash());
+  }
+};
+
+/*
+ * Arguments of vr_vrand_comdet. The scalar comdetPack returns references,
+ * so the vector ones are computed here and held by value. The lane-wise
+ * min/max follow std::min/std::max (the first argument is kept for equal or
+ * unordered lanes), as the scalar hash sees them.
+ */
+template <class OP> struct vr_vcomdetPack {
+  typedef typename OP::PackArgs PackArgs;
+  vr_vcomdetPack(const PackArgs &p) : pack(p) {}
+  const PackArgs pack;
+};
+
+template <class VT> struct vr_vcomdetMinMax {
+  typedef vr_simd<VT> SIMD;
+  typedef vr_packArg<VT, 2> PackArgs;
+  vr_vcomdetMinMax(const VT &a, const VT &b)
+      : arg1(SIMD::blend (a, b, SIMD::cmplt (b, a))),
+        arg2(SIMD::blend (a, b, SIMD::cmplt (a, b))), pack(arg1, arg2) {}
+  const VT arg1;
+  const VT arg2;
+  const PackArgs pack;
+};
+
+template <class VT>
+struct vr_vcomdetPack<AddOp<VT>> : public vr_vcomdetMinMax<VT> {
+  vr_vcomdetPack(const vr_packArg<VT, 2> &p) : vr_vcomdetMinMax<VT>(p.arg1, p.arg2) {}
+};
+
+template <class VT>
+struct vr_vcomdetPack<MulOp<VT>> : public vr_vcomdetMinMax<VT> {
+  vr_vcomdetPack(const vr_packArg<VT, 2> &p) : vr_vcomdetMinMax<VT>(p.arg1, p.arg2) {}
+};
+
+// -0 - x flips the sign of x, zeros included
+template <class VT>
+struct vr_vcomdetPack<SubOp<VT>> : public vr_vcomdetMinMax<VT> {
+  vr_vcomdetPack(const vr_packArg<VT, 2> &p)
+      : vr_vcomdetMinMax<VT>(p.arg1, vr_simd<VT>::sub (vr_simd<VT>::set1 (-0.), p.arg2)) {}
+};
+
+// the product is commutative, the addend keeps its place
+template <class VT> struct vr_vcomdetPack<MAddOp<VT>> {
+  vr_vcomdetPack(const vr_packArg<VT, 3> &p)
+      : minMax(p.arg1, p.arg2), pack(minMax.arg1, minMax.arg2, p.arg3) {}
+  const vr_vcomdetMinMax<VT> minMax;
+  const vr_packArg<VT, 3> pack;
+};
+
+template <class OP, class HASH = VERROU_DET_HASH> class vr_vrand_comdet {
+public:
+  typedef typename OP::RealType RealType;
+
+  static inline typename vr_simd<RealType>::MaskType
+  randBool(const Vr_Rand *r, const typename OP::PackArgs &p) {
+    const vr_vcomdetPack<OP> comdet(p);
+    return vr_vhash<HASH>::template hashBool<RealType>(r, comdet.pack,
+                                                        OP::getComdetHash());
+  }
+
+  static inline RealType randRatio(const Vr_Rand *r,
+                                   const typename OP::PackArgs &p) {
+    const vr_vcomdetPack<OP> comdet(p);
+    return vr_vhash<HASH>::template hashRatio<RealType>(r, comdet.pack,
+                                                         OP::getComdetHash());
+  }
+};
+
+// vr_vrand_det and vr_vrand_comdet bound to one hash, see vr_rand_hash
+template <class HASH> struct vr_vrand_hash {
+  template <class OP> using det = vr_vrand_det<OP, HASH>;
+  template <class OP> using comdet = vr_vrand_comdet<OP, HASH>;
+};
+
+/*
+ * The scalar vr_rand_p compares the ratio to the double p: for float lanes
+ * the threshold is p rounded upward, so that x < threshold <=> x < p.
+ */
+template <class REALTYPE> inline REALTYPE vr_vrand_pThreshold(double p) {
+  return p;
+}
+
+template <> inline float vr_vrand_pThreshold<float>(double p) {
+  float t = (float)p;
+  if ((double)t < p) {
+    t = std::nextafter(t, std::numeric_limits<float>::infinity());
+  }
+  return t;
+}
+
+template <class OP, template <class> class RAND> class vr_vrand_p {
+public:
+  typedef typename OP::RealType RealType;
+  typedef vr_simd<RealType> SIMD;
+
+  static inline typename SIMD::MaskType
+  randBool(Vr_Rand *r, const typename OP::PackArgs &args) {
+    return SIMD::cmplt (RAND<OP>::randRatio(r, args),
+                        SIMD::set1 (vr_vrand_pThreshold<typename SIMD::ScalarType>(r->p)));
+  }
+};
@@ -31,231 +31,282 @@
 */
 
 #pragma once
+#include <type_traits>
+
 #include "../vr_roundingOp.hxx"
 #include "vr_areNan.hxx"
 #include "vr_nextUlps.hxx"
+#include "vr_simd.hxx"
 
 #include "vr_vop.hxx"
 #include "../vr_rand_implem.h"
+#include "vr_vrand.hxx"
 
-#if defined(__SSE4_2__)
-template<template<class REAL> class OP>
-class RoundingNearest<OP<__m128>>
-{
+/*
+ * Vector rounding modes: they are written once for all the SIMD types with
+ * the lane-wise primitives of vr_simd<RealType>, and follow lane by lane the
+ * scalar rounding modes of ../vr_roundingOp.hxx.
+ */
+template <class OP, class PROF = vr_noProf> class VRoundingNearest {
 public:
-  typedef __m128 RealType;
-  typedef typename OP<__m128>::PackArgs PackArgs;
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
 
   static inline RealType apply(const PackArgs &p) {
-    const RealType res = OP<__m128>::nearestOp(p);
-    OP<__m128>::check(p, res);
-    return res;    
+    const RealType res = OP::nearestOp(p);
+    OP::check(p, res);
+    INC_ERROR;
+    return res;
   };
 };
-#endif
 
-#if defined(__AVX2__)
-template<template<class REAL> class OP>
-class RoundingNearest<OP<__m256>>
-{
+template <class OP, class PROF = vr_noProf> class VRoundingUpward {
 public:
-  typedef __m256 RealType;
-  typedef typename OP<__m256>::PackArgs PackArgs;
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
+  typedef vr_simd<RealType> SIMD;
+  typedef typename SIMD::ScalarType ScalarType;
+  typedef typename SIMD::MaskType MaskType;
 
   static inline RealType apply(const PackArgs &p) {
-    const RealType res = OP<__m256>::nearestOp(p);
-    OP<__m256>::check(p, res);
-    return res;    
-  };
+    const RealType res = OP::nearestOp(p);
+    OP::check(p, res);
+    INC_OP; // counts each lane
+    INC_ERROR;
+    RealType v_res = res;
+
+    // NaN lanes have a NaN error and are left unchanged
+    const RealType v_signError = OP::sameSignOfError(p, res);
+    INC_VEXACTOP(SIMD::count (SIMD::cmpeq (v_signError, SIMD::zero ())));
+    const MaskType simd_is_signError_gt_fzero = SIMD::cmpgt (v_signError, SIMD::zero ());
+
+    if (SIMD::any (simd_is_signError_gt_fzero)) { // Check if at least one has error > 0.
+      RealType res_nextAfter = nextAfter<RealType> (res);
+      res_nextAfter = SIMD::blend (res_nextAfter, SIMD::set1 (std::numeric_limits<ScalarType>::denorm_min()),
+                                   SIMD::cmpeq (res, SIMD::zero ()));
+      res_nextAfter = SIMD::blend (res_nextAfter, SIMD::zero (),
+                                   SIMD::cmpeq (res, SIMD::set1 (-std::numeric_limits<ScalarType>::denorm_min())));
+      v_res = SIMD::blend (res, res_nextAfter, simd_is_signError_gt_fzero);
+    }
+    // -inf obtained from finite arguments is rounded to -max
+    const MaskType simd_is_res_eq_neg_inf = SIMD::cmpeq (res, SIMD::set1 (-std::numeric_limits<ScalarType>::infinity()));
+    if (SIMD::any (simd_is_res_eq_neg_inf)) {
+      v_res = SIMD::blend (v_res, SIMD::set1 (-std::numeric_limits<ScalarType>::max()),
+                           SIMD::maskAndNot (simd_is_res_eq_neg_inf, OP::areInfNotSpecificToNearest (p)));
+    }
+    return v_res;
+  }
 };
-#endif
 
-#if defined(__SSE4_2__)
-template<template<class REAL> class OP, class RAND>
-class RoundingUpward<OP<__m128>, RAND>
-{
+template <class OP, class PROF = vr_noProf> class VRoundingDownward {
 public:
-  typedef __m128 RealType;
-  typedef typename OP<__m128>::PackArgs PackArgs;
-  static inline RealType apply(const PackArgs &p) {
-    /*const*/ RealType res = OP<__m128>::nearestOp(p);
-    OP<__m128>::check(p, res);
-    INC_OP; // Sould exist for simd ops OR called 4 times
-#ifndef VERROU_IGNORE_NANINF_CHECK
-//  Check Nans and Infs
-    __m128 simd_is_isNanInf = _mm_castsi128_ps( hasNanInf<RealType>(res));    
-    __m128 simd_is_eq_neg_inf = _mm_cmpneq_ps (res, _mm_set1_ps(-std::numeric_limits<float>::infinity()));
-    __m128 simd_is_areInfNotSpecificToNearest = _mm_castsi128_ps (OP<__m128>::areInfNotSpecificToNearest(p));
-
-    __m128 simd_tmp1 = _mm_or_ps (_mm_or_ps (simd_is_eq_neg_inf, simd_is_areInfNotSpecificToNearest), simd_is_isNanInf);
-    __m128 simd_tmp2 = _mm_or_ps ( _mm_andnot_ps(simd_tmp1, simd_tmp1), simd_is_isNanInf);
-
-    res = _mm_blendv_ps (res, _mm_set1_ps(-std::numeric_limits<float>::max()), simd_tmp2);
-#endif
-    __m128 v_signError = OP<__m128>::sameSignOfError(p, res);
-    __m128 v_fzero = _mm_setzero_ps ();
-    __m128 v_fdenorm_min = _mm_set1_ps (std::numeric_limits<float>::denorm_min());
-#ifdef PROFILING_EXACT
-    __m128 simd_is_signError_eq_fzero = _mm_cmpeq_ps (v_signError, v_fzero);
-#endif
-    __m128 simd_is_signError_gt_fzero    = _mm_cmpgt_ps (v_signError, v_fzero);
-
-    if (_mm_movemask_ps (simd_is_signError_gt_fzero) == 0) return res; // Check if at least one has error > 0.
-
-    __m128 res_nextAfter  = nextAfter<RealType> (res);
-
-    __m128 simd_is_res_eq_fzero          = _mm_cmpeq_ps (res, v_fzero);
-    __m128 simd_is_res_eq_neg_denorm_min = _mm_cmpeq_ps (res, _mm_set1_ps(-std::numeric_limits<float>::denorm_min()));
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
+  typedef vr_simd<RealType> SIMD;
+  typedef typename SIMD::ScalarType ScalarType;
+  typedef typename SIMD::MaskType MaskType;
 
-    if (_mm_movemask_ps (_mm_or_ps (simd_is_res_eq_fzero, simd_is_res_eq_neg_denorm_min)))
-    {
-      res_nextAfter         = _mm_blendv_ps (res_nextAfter , v_fdenorm_min, simd_is_res_eq_fzero);
-      res_nextAfter         = _mm_blendv_ps (res_nextAfter , v_fzero, simd_is_res_eq_neg_denorm_min);
+  static inline RealType apply(const PackArgs &p) {
+    const RealType res = OP::nearestOp(p);
+    OP::check(p, res);
+    INC_OP; // counts each lane
+    INC_ERROR;
+    RealType v_res = res;
+
+    // NaN lanes have a NaN error and are left unchanged
+    const RealType v_signError = OP::sameSignOfError(p, res);
+    INC_VEXACTOP(SIMD::count (SIMD::cmpeq (v_signError, SIMD::zero ())));
+    const MaskType simd_is_signError_lt_fzero = SIMD::cmplt (v_signError, SIMD::zero ());
+
+    if (SIMD::any (simd_is_signError_lt_fzero)) { // Check if at least one has error < 0.
+      RealType res_nextPrev = nextPrev<RealType> (res);
+      res_nextPrev = SIMD::blend (res_nextPrev, SIMD::set1 (-std::numeric_limits<ScalarType>::denorm_min()),
+                                  SIMD::cmpeq (res, SIMD::zero ()));
+      res_nextPrev = SIMD::blend (res_nextPrev, SIMD::zero (),
+                                  SIMD::cmpeq (res, SIMD::set1 (std::numeric_limits<ScalarType>::denorm_min())));
+      v_res = SIMD::blend (res, res_nextPrev, simd_is_signError_lt_fzero);
     }
-
-    const __m128 v_res = _mm_blendv_ps(res, res_nextAfter, simd_is_signError_gt_fzero);
-
-    return v_res;    
-  }
+    // +inf obtained from finite arguments is rounded to max
+    const MaskType simd_is_res_eq_inf = SIMD::cmpeq (res, SIMD::set1 (std::numeric_limits<ScalarType>::infinity()));
+    if (SIMD::any (simd_is_res_eq_inf)) {
+      v_res = SIMD::blend (v_res, SIMD::set1 (std::numeric_limits<ScalarType>::max()),
+                           SIMD::maskAndNot (simd_is_res_eq_inf, OP::areInfNotSpecificToNearest (p)));
+    }
+    return v_res;
+  };
 };
-#endif
 
-#if defined(__AVX2__)
-template<template<class REAL> class OP, class RAND>
-class RoundingUpward<OP<__m256>, RAND>
-{
+template <class OP, class RAND, class PROF = vr_noProf>
+class VRoundingRandom {
 public:
-  typedef __m256 RealType;
-  typedef typename OP<__m256>::PackArgs PackArgs;
-  static inline RealType apply(const PackArgs &p) {
-    const RealType res = OP<__m256>::nearestOp(p);
-    OP<__m256>::check(p, res);
-    INC_OP; // Sould exist for simd ops OR called 4 times
-#ifndef VERROU_IGNORE_NANINF_CHECK
-
-#endif
-    __m256 v_signError = OP<__m256>::sameSignOfError(p, res);
-    __m256 v_fzero = _mm256_setzero_ps ();
-    __m256 v_fdenorm_min = _mm256_set1_ps (std::numeric_limits<float>::denorm_min());
-#ifdef PROFILING_EXACT
-    __m256 simd_is_signError_eq_fzero = _mm256_cmp_ps (v_signError, v_fzero);
-#endif
-    __m256 simd_is_signError_gt_fzero    = _mm256_cmp_ps (v_signError, v_fzero, _CMP_GT_OQ);
-
-    if (_mm256_movemask_ps (simd_is_signError_gt_fzero) == 0) return res; // Check if at least one has error > 0.
-
-    __m256 res_nextAfter  = nextAfter<RealType> (res);
-
-    __m256 simd_is_res_eq_fzero          = _mm256_cmp_ps (res, v_fzero, _CMP_EQ_OQ);
-    __m256 simd_is_res_eq_neg_denorm_min = _mm256_cmp_ps (res, _mm256_set1_ps(-std::numeric_limits<float>::denorm_min()), _CMP_EQ_OQ);
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
+  typedef vr_simd<RealType> SIMD;
+  typedef typename SIMD::MaskType MaskType;
 
-    if (_mm256_movemask_ps (_mm256_or_ps (simd_is_res_eq_fzero, simd_is_res_eq_neg_denorm_min)))
-    {
-      res_nextAfter         = _mm256_blendv_ps (res_nextAfter , v_fdenorm_min, simd_is_res_eq_fzero);
-      res_nextAfter         = _mm256_blendv_ps (res_nextAfter , v_fzero, simd_is_res_eq_neg_denorm_min);
+  static inline RealType apply(const PackArgs &p) {
+    const RealType res = OP::nearestOp(p);
+    INC_OP;
+    INC_ERROR;
+    OP::check(p, res);
+    RealType v_res = res;
+
+    // NaN lanes have a NaN error and are left unchanged
+    const RealType v_signError = OP::sameSignOfError(p, res);
+    INC_VEXACTOP(SIMD::count (SIMD::cmpeq (v_signError, SIMD::zero ())));
+    const MaskType doNoChange = RAND::randBool(&vr_rand, p);
+    MaskType simd_do_nextAfter = SIMD::maskAndNot (SIMD::cmpgt (v_signError, SIMD::zero ()), doNoChange);
+    MaskType simd_do_nextPrev = SIMD::maskAndNot (SIMD::cmplt (v_signError, SIMD::zero ()), doNoChange);
+    const MaskType simd_is_res_naninf = hasNanInf<RealType> (res);
+    simd_do_nextAfter = SIMD::maskAndNot (simd_do_nextAfter, simd_is_res_naninf);
+    simd_do_nextPrev = SIMD::maskAndNot (simd_do_nextPrev, simd_is_res_naninf);
+    if (SIMD::any (simd_do_nextAfter)) {
+      v_res = SIMD::blend (v_res, nextAfter<RealType> (res), simd_do_nextAfter);
     }
-
-    const __m256 v_res = _mm256_blendv_ps(res, res_nextAfter, simd_is_signError_gt_fzero);
-
-    return v_res;    
-  }
+    if (SIMD::any (simd_do_nextPrev)) {
+      v_res = SIMD::blend (v_res, nextPrev<RealType> (res), simd_do_nextPrev);
+    }
+    return v_res;
+  };
 };
-#endif
 
-#if defined(__SSE4_2__)
-template<template<class REAL> class OP, class RAND>
-class RoundingDownward<OP<__m128>, RAND>
-{
+/*
+ * Unlike the scalar RoundingPRandom, a zero result is moved with
+ * nextAfter/nextPrev: nextTowardZero(0) would give a NaN.
+ */
+template <class OP, class RAND, class PROF = vr_noProf>
+class VRoundingPRandom {
 public:
-  typedef __m128 RealType;
-  typedef typename OP<__m128>::PackArgs PackArgs;
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
+  typedef vr_simd<RealType> SIMD;
+  typedef typename SIMD::MaskType MaskType;
 
   static inline RealType apply(const PackArgs &p) {
-    /*const*/ RealType res = OP<__m128>::nearestOp(p);
-    OP<__m128>::check(p, res);
-    INC_OP; // Sould exist for simd ops OR called 4 times
-#ifndef VERROU_IGNORE_NANINF_CHECK
-//  Check Nans and Infs
-    __m128 simd_is_isNanInf = _mm_castsi128_ps( hasNanInf<RealType>(res));    
-    __m128 simd_is_eq_neg_inf = _mm_cmpneq_ps (res, _mm_set1_ps(std::numeric_limits<float>::infinity()));
-    __m128 simd_is_areInfNotSpecificToNearest = _mm_castsi128_ps (OP<__m128>::areInfNotSpecificToNearest(p));
-
-    __m128 simd_tmp1 = _mm_or_ps (_mm_or_ps (simd_is_eq_neg_inf, simd_is_areInfNotSpecificToNearest), simd_is_isNanInf);
-    __m128 simd_tmp2 = _mm_or_ps ( _mm_andnot_ps(simd_tmp1, simd_tmp1), simd_is_isNanInf);
-
-    res = _mm_blendv_ps (res, _mm_set1_ps(std::numeric_limits<float>::max()), simd_tmp2);
-  
-#endif
-    __m128 v_signError = OP<__m128>::sameSignOfError(p, res);
-    __m128 v_fzero = _mm_setzero_ps ();
-    __m128 v_fdenorm_min = _mm_set1_ps (-std::numeric_limits<float>::denorm_min());
-#ifdef PROFILING_EXACT
-    __m128 simd_is_signError_eq_fzero = _mm_cmpeq_ps (v_signError, v_fzero);
-#endif
-    __m128 simd_is_signError_lt_fzero    = _mm_cmplt_ps (v_signError, v_fzero);
-
-    if (_mm_movemask_ps (simd_is_signError_lt_fzero) == 0) return res; // Check if at least one has error > 0.
-
-    __m128 res_nextPrev  = nextPrev<RealType> (res);
-
-    __m128 simd_is_res_eq_fzero          = _mm_cmpeq_ps (res, v_fzero);
-    __m128 simd_is_res_eq_neg_denorm_min = _mm_cmpeq_ps (res, _mm_set1_ps(std::numeric_limits<float>::denorm_min()));
-
-    if (_mm_movemask_ps (_mm_or_ps (simd_is_res_eq_fzero, simd_is_res_eq_neg_denorm_min)))
-    {
-      res_nextPrev         = _mm_blendv_ps (res_nextPrev , v_fdenorm_min, simd_is_res_eq_fzero);
-      res_nextPrev         = _mm_blendv_ps (res_nextPrev , v_fzero, simd_is_res_eq_neg_denorm_min);
+    const RealType res = OP::nearestOp(p);
+    INC_OP;
+    INC_ERROR;
+    OP::check(p, res);
+    RealType v_res = res;
+
+    // a positive error moves the lanes where randBool is false, a negative
+    // one the lanes where it is true
+    const RealType v_signError = OP::sameSignOfError(p, res);
+    INC_VEXACTOP(SIMD::count (SIMD::cmpeq (v_signError, SIMD::zero ())));
+    const MaskType randBool = RAND::randBool(&vr_rand, p);
+    MaskType simd_do_nextAfter = SIMD::maskAndNot (SIMD::cmpgt (v_signError, SIMD::zero ()), randBool);
+    MaskType simd_do_nextPrev = SIMD::maskAnd (SIMD::cmplt (v_signError, SIMD::zero ()), randBool);
+    const MaskType simd_is_res_naninf = hasNanInf<RealType> (res);
+    simd_do_nextAfter = SIMD::maskAndNot (simd_do_nextAfter, simd_is_res_naninf);
+    simd_do_nextPrev = SIMD::maskAndNot (simd_do_nextPrev, simd_is_res_naninf);
+    if (SIMD::any (simd_do_nextAfter)) {
+      v_res = SIMD::blend (v_res, nextAfter<RealType> (res), simd_do_nextAfter);
+    }
+    if (SIMD::any (simd_do_nextPrev)) {
+      v_res = SIMD::blend (v_res, nextPrev<RealType> (res), simd_do_nextPrev);
     }
-
-    const __m128 v_res = _mm_blendv_ps(res, res_nextPrev, simd_is_signError_lt_fzero);
     return v_res;
   };
 };
-#endif
 
-#if defined(__AVX2__)
-template<template<class REAL> class OP, class RAND>
-class RoundingDownward<OP<__m256>, RAND>
-{
+template <class OP, class RAND, class PROF = vr_noProf>
+class VRoundingAverage {
 public:
-  typedef __m256 RealType;
-  typedef typename OP<__m256>::PackArgs PackArgs;
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
+  typedef vr_simd<RealType> SIMD;
+  typedef typename SIMD::MaskType MaskType;
 
   static inline RealType apply(const PackArgs &p) {
-    const RealType res = OP<__m256>::nearestOp(p);
-    OP<__m256>::check(p, res);
-    INC_OP; // Sould exist for simd ops OR called 4 times
-#ifndef VERROU_IGNORE_NANINF_CHECK
- 
-#endif
-    __m256 v_signError = OP<__m256>::sameSignOfError(p, res);
-    __m256 v_fzero = _mm256_setzero_ps ();
-    __m256 v_fdenorm_min = _mm256_set1_ps (-std::numeric_limits<float>::denorm_min());
-#ifdef PROFILING_EXACT
-    __m256 simd_is_signError_eq_fzero = _mm256_cmp_ps (v_signError, v_fzero);
-#endif
-    __m256 simd_is_signError_lt_fzero    = _mm256_cmp_ps (v_signError, v_fzero, _CMP_LT_OQ);
-
-    if (_mm256_movemask_ps (simd_is_signError_lt_fzero) == 0) return res; // Check if at least one has error > 0.
-
-    __m256 res_nextPrev  = nextPrev<RealType> (res);
-
-    __m256 simd_is_res_eq_fzero          = _mm256_cmp_ps (res, v_fzero, _CMP_EQ_OQ);
-    __m256 simd_is_res_eq_neg_denorm_min = _mm256_cmp_ps (res, _mm256_set1_ps(std::numeric_limits<float>::denorm_min()), _CMP_EQ_OQ);
-
-    if (_mm256_movemask_ps (_mm256_or_ps (simd_is_res_eq_fzero, simd_is_res_eq_neg_denorm_min)))
-    {
-      res_nextPrev         = _mm256_blendv_ps (res_nextPrev , v_fdenorm_min, simd_is_res_eq_fzero);
-      res_nextPrev         = _mm256_blendv_ps (res_nextPrev , v_fzero, simd_is_res_eq_neg_denorm_min);
+    const RealType res = OP::nearestOp(p);
+    INC_OP;
+    INC_ERROR;
+    OP::check(p, res);
+    RealType v_res = res;
+
+    // a lane moves to its neighbour with probability |error|/ulp
+    const RealType v_error = OP::error(p, res);
+    INC_VEXACTOP(SIMD::count (SIMD::cmpeq (v_error, SIMD::zero ())));
+    const RealType ratio = RAND::randRatio(&vr_rand, p);
+    MaskType simd_is_error_gt_fzero = SIMD::cmpgt (v_error, SIMD::zero ());
+    MaskType simd_is_error_lt_fzero = SIMD::cmplt (v_error, SIMD::zero ());
+    const MaskType simd_is_res_naninf = hasNanInf<RealType> (res);
+    simd_is_error_gt_fzero = SIMD::maskAndNot (simd_is_error_gt_fzero, simd_is_res_naninf);
+    simd_is_error_lt_fzero = SIMD::maskAndNot (simd_is_error_lt_fzero, simd_is_res_naninf);
+    if (SIMD::any (simd_is_error_gt_fzero)) {
+      const RealType nextRes = nextAfter<RealType> (res);
+      const RealType u = SIMD::sub (nextRes, res);
+      const MaskType doNotChange = SIMD::cmpgt (SIMD::mul (ratio, u), v_error);
+      v_res = SIMD::blend (v_res, nextRes, SIMD::maskAndNot (simd_is_error_gt_fzero, doNotChange));
+    }
+    if (SIMD::any (simd_is_error_lt_fzero)) {
+      const RealType prevRes = nextPrev<RealType> (res);
+      const RealType u = SIMD::sub (res, prevRes);
+      const MaskType doNotChange = SIMD::cmpgt (SIMD::mul (ratio, u), SIMD::sub (SIMD::zero (), v_error));
+      v_res = SIMD::blend (v_res, prevRes, SIMD::maskAndNot (simd_is_error_lt_fzero, doNotChange));
     }
-
-    const __m256 v_res = _mm256_blendv_ps(res, res_nextPrev, simd_is_signError_lt_fzero);
     return v_res;
   };
 };
-#endif
 
-#include "vr_vop.hxx"
+/*
+ * Selects the rounding classes of an operation: the scalar ones of
+ * ../vr_roundingOp.hxx for the scalar fallbacks, the vector ones otherwise.
+ * The det and comdet modes take the hash selected by vr_detHashDispatch, all
+ * of them the profiling policy PROF.
+ */
+template <class OP, class PROF = vr_noProf,
+          bool IS_SCALAR =
+              std::is_floating_point<typename OP::RealType>::value>
+struct vr_vroundingSelector {
+  typedef RoundingNearest<OP, void, PROF> Nearest;
+  typedef RoundingUpward<OP, void, PROF> Upward;
+  typedef RoundingDownward<OP, void, PROF> Downward;
+  typedef RoundingRandom<OP, vr_rand_prng<OP>, PROF> Random;
+  typedef RoundingAverage<OP, vr_rand_prng<OP>, PROF> Average;
+  typedef RoundingPRandom<OP, vr_rand_p<OP, vr_rand_prng>, PROF> PRandom;
+  template <class HASH>
+  using RandomDet = RoundingRandom<OP, vr_rand_det<OP, HASH>, PROF>;
+  template <class HASH>
+  using RandomComdet = RoundingRandom<OP, vr_rand_comdet<OP, HASH>, PROF>;
+  template <class HASH>
+  using AverageDet = RoundingAverage<OP, vr_rand_det<OP, HASH>, PROF>;
+  template <class HASH>
+  using AverageComdet = RoundingAverage<OP, vr_rand_comdet<OP, HASH>, PROF>;
+  template <class HASH>
+  using PRandomDet =
+      RoundingPRandom<OP, vr_rand_p<OP, vr_rand_hash<HASH>::template det>,
+                      PROF>;
+  template <class HASH>
+  using PRandomComdet =
+      RoundingPRandom<OP, vr_rand_p<OP, vr_rand_hash<HASH>::template comdet>,
+                      PROF>;
+};
+
+template <class OP, class PROF>
+struct vr_vroundingSelector<OP, PROF, false> {
+  typedef VRoundingNearest<OP, PROF> Nearest;
+  typedef VRoundingUpward<OP, PROF> Upward;
+  typedef VRoundingDownward<OP, PROF> Downward;
+  typedef VRoundingRandom<OP, vr_vrand_prng<OP>, PROF> Random;
+  typedef VRoundingAverage<OP, vr_vrand_prng<OP>, PROF> Average;
+  typedef VRoundingPRandom<OP, vr_vrand_p<OP, vr_vrand_prng>, PROF> PRandom;
+  template <class HASH>
+  using RandomDet = VRoundingRandom<OP, vr_vrand_det<OP, HASH>, PROF>;
+  template <class HASH>
+  using RandomComdet = VRoundingRandom<OP, vr_vrand_comdet<OP, HASH>, PROF>;
+  template <class HASH>
+  using AverageDet = VRoundingAverage<OP, vr_vrand_det<OP, HASH>, PROF>;
+  template <class HASH>
+  using AverageComdet = VRoundingAverage<OP, vr_vrand_comdet<OP, HASH>, PROF>;
+  template <class HASH>
+  using PRandomDet =
+      VRoundingPRandom<OP, vr_vrand_p<OP, vr_vrand_hash<HASH>::template det>,
+                       PROF>;
+  template <class HASH>
+  using PRandomComdet = VRoundingPRandom<
+      OP, vr_vrand_p<OP, vr_vrand_hash<HASH>::template comdet>, PROF>;
+};
 
 template<class REALTYPE>
 static inline REALTYPE ret_zero() {
@@ -267,6 +318,11 @@ template <>
 inline __m128 ret_zero<__m128>() {
   return _mm_setzero_ps();
 };
+
+template <>
+inline __m128d ret_zero<__m128d>() {
+  return _mm_setzero_pd();
+};
 #endif
 
 #if defined(__AVX2__)
@@ -274,27 +330,39 @@ template <>
 inline __m256 ret_zero<__m256>() {
   return _mm256_setzero_ps();
 };
+
+template <>
+inline __m256d ret_zero<__m256d>() {
+  return _mm256_setzero_pd();
+};
+#endif
+
+#if defined(__AVX512F__)
+template <>
+inline __m512 ret_zero<__m512>() {
+  return _mm512_setzero_ps();
+};
+
+template <>
+inline __m512d ret_zero<__m512d>() {
+  return _mm512_setzero_pd();
+};
 #endif
 
-template <class OP> class VOpWithSelectedRoundingMode {
+// The rounding mode of the context, or of the region of the thread, applied to
+// OP with the profiling policy PROF
+template <class OP, class PROF = vr_noProf> class VOpWithSelectedRoundingMode {
 public:
   typedef typename OP::RealType RealType;
   typedef typename OP::PackArgs PackArgs;
+  typedef vr_vroundingSelector<OP, PROF> Rounding;
 
+  // NaN and Inf lanes are not perturbed, and call no handler: the policy of
+  // vr_naninfNoHandler, whatever --naninf-check
   static inline void apply(const PackArgs &p, RealType *res, void *context) {
     *res = applySeq(p, context);
 #ifdef DEBUG_PRINT_OP
     print_debug(p, res);
-#endif
-#ifndef VERROU_IGNORE_NANINF_CHECK
-/*    if (isNanInf(*res)) {
-      if (isNan(*res)) {
-        interflop_nanHandler();
-      }
-      if (isinf(*res)) {
-        interflop_infHandler();
-      }
-    }*/
 #endif
   }
 
@@ -315,15 +383,49 @@ public:
 //    return RoundingNearest<OP>::apply(p);
 
     verrou_context_t *ctx = (verrou_context_t *)context;
-    switch (ctx->rounding_mode) {
+    switch (vr_regionMode(ctx)) {
     case VR_NEAREST:
-      return RoundingNearest<OP>::apply(p);
+    case VR_NATIVE: // as the scalar backend
+      return Rounding::Nearest::apply(p);
 
     case VR_UPWARD:
-      return RoundingUpward<OP>::apply(p);
+      return Rounding::Upward::apply(p);
 
     case VR_DOWNWARD:
-      return RoundingDownward<OP>::apply(p);
+      return Rounding::Downward::apply(p);
+
+    case VR_RANDOM:
+      return Rounding::Random::apply(p);
+
+    case VR_RANDOM_DET:
+      return vr_detHashDispatch<Rounding::template RandomDet>(
+          ctx->det_hash, p);
+
+    case VR_RANDOM_COMDET:
+      return vr_detHashDispatch<Rounding::template RandomComdet>(
+          ctx->det_hash, p);
+
+    case VR_AVERAGE:
+      return Rounding::Average::apply(p);
+
+    case VR_AVERAGE_DET:
+      return vr_detHashDispatch<Rounding::template AverageDet>(
+          ctx->det_hash, p);
+
+    case VR_AVERAGE_COMDET:
+      return vr_detHashDispatch<Rounding::template AverageComdet>(
+          ctx->det_hash, p);
+
+    case VR_PRANDOM:
+      return Rounding::PRandom::apply(p);
+
+    case VR_PRANDOM_DET:
+      return vr_detHashDispatch<Rounding::template PRandomDet>(
+          ctx->det_hash, p);
+
+    case VR_PRANDOM_COMDET:
+      return vr_detHashDispatch<Rounding::template PRandomComdet>(
+          ctx->det_hash, p);
    default:
      interflop_panic("Rounding mode not implemented !");
     }
@@ -331,4 +433,51 @@ public:
   }
 };
 
+// The rounding mode MODE applied to OP, selected at initialization by the
+// static backend: HASH is the hash of the det and comdet modes
+template <class OP, enum vr_RoundingMode MODE, class HASH = void,
+          class PROF = vr_noProf>
+class VOpWithStaticRoundingMode {
+public:
+  typedef typename OP::RealType RealType;
+  typedef typename OP::PackArgs PackArgs;
+  typedef vr_vroundingSelector<OP, PROF> Rounding;
+
+  // NaN and Inf lanes are not perturbed, and call no handler: the policy of
+  // vr_naninfNoHandler, whatever --naninf-check
+  static inline void apply(const PackArgs &p, RealType *res,
+                           [[maybe_unused]] void *context) {
+    *res = applySeq(p);
+  }
+
+  static inline RealType applySeq(const PackArgs &p) {
+    if constexpr (MODE == VR_NEAREST)
+      return Rounding::Nearest::apply(p);
+    else if constexpr (MODE == VR_UPWARD)
+      return Rounding::Upward::apply(p);
+    else if constexpr (MODE == VR_DOWNWARD)
+      return Rounding::Downward::apply(p);
+    else if constexpr (MODE == VR_RANDOM)
+      return Rounding::Random::apply(p);
+    else if constexpr (MODE == VR_RANDOM_DET)
+      return Rounding::template RandomDet<HASH>::apply(p);
+    else if constexpr (MODE == VR_RANDOM_COMDET)
+      return Rounding::template RandomComdet<HASH>::apply(p);
+    else if constexpr (MODE == VR_AVERAGE)
+      return Rounding::Average::apply(p);
+    else if constexpr (MODE == VR_AVERAGE_DET)
+      return Rounding::template AverageDet<HASH>::apply(p);
+    else if constexpr (MODE == VR_AVERAGE_COMDET)
+      return Rounding::template AverageComdet<HASH>::apply(p);
+    else if constexpr (MODE == VR_PRANDOM)
+      return Rounding::PRandom::apply(p);
+    else if constexpr (MODE == VR_PRANDOM_DET)
+      return Rounding::template PRandomDet<HASH>::apply(p);
+    else if constexpr (MODE == VR_PRANDOM_COMDET)
+      return Rounding::template PRandomComdet<HASH>::apply(p);
+    else
+      static_assert(MODE == VR_NEAREST, "no vector rounding class for MODE");
+  }
+};
+
 //#endif